@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "lancet/base/types.h"
+#include "lancet/caller/genotyper.h"
+#include "lancet/caller/msa_builder.h"
+#include "lancet/caller/variant_set.h"
+#include "lancet/cbdg/label.h"
+#include "lancet/cbdg/read.h"
+#include "lancet/core/window.h"
+#include "lancet/hts/reference.h"
+
+namespace {
+
+using lancet::caller::Genotyper;
+
+constexpr std::array<char, 4> BASES = {'A', 'C', 'G', 'T'};
+// Fixed seed, so that every run of a benchmark genotypes the same haplotypes and reads
+constexpr u64 RANDOM_SEED = 42;
+constexpr u64 WINDOW_START_POS1 = 1000000;
+
+// Synthetic window with a random reference haplotype, alt haplotypes that each carry one SNV or insertion,
+// and reads sampled evenly from all haplotypes with substitution errors
+struct SyntheticWindow {
+  std::vector<std::string> mHaplotypes;
+  std::vector<lancet::cbdg::Read> mReads;
+  std::shared_ptr<const lancet::core::Window> mWindow;
+};
+
+[[nodiscard]] auto MakeWindow(const std::string& ref_hap) -> std::shared_ptr<const lancet::core::Window> {
+  using lancet::hts::Reference;
+  const auto end_pos1 = WINDOW_START_POS1 + ref_hap.length() - 1;
+  auto region = std::make_shared<const Reference::Region>(0, std::make_pair(WINDOW_START_POS1, end_pos1), "chr1",
+                                                          std::string(ref_hap));
+  // NOLINTNEXTLINE(readability-magic-numbers)
+  const Reference::Chrom chrom(0, "chr1", 248956422);
+  const lancet::core::Window::RegSpec spec{.mChromName = "chr1", .mRegionSpan = {WINDOW_START_POS1, end_pos1}};
+  return std::make_shared<const lancet::core::Window>(spec, chrom, std::move(region));
+}
+
+[[nodiscard]] auto MakeSyntheticWindow(const usize num_haps, const usize hap_len, const usize depth,
+                                       const Genotyper::Preset preset) -> SyntheticWindow {
+  std::mt19937_64 generator(RANDOM_SEED);
+  std::uniform_int_distribution<usize> base_chooser(0, 3);
+
+  SyntheticWindow result;
+  auto& ref_hap = result.mHaplotypes.emplace_back(hap_len, 'N');
+  std::ranges::generate(ref_hap, [&] { return BASES.at(base_chooser(generator)); });
+
+  // Variants are spread around the middle of the window, so that every read length covers some of them
+  for (usize hap_idx = 1; hap_idx < num_haps; ++hap_idx) {
+    auto alt_hap = ref_hap;
+    const auto var_pos = (hap_len / 2) + (hap_idx * 7);
+    if (hap_idx % 2 == 1) {
+      alt_hap[var_pos] = alt_hap[var_pos] == 'A' ? 'C' : 'A';
+    } else {
+      alt_hap.insert(var_pos, "TTAGG");
+    }
+    result.mHaplotypes.emplace_back(std::move(alt_hap));
+  }
+
+  // Long reads are simulated with more errors, although only substitutions and not the indels typical of ONT
+  const auto is_short_read = preset == Genotyper::Preset::ShortRead;
+  const auto read_len = std::min(hap_len, is_short_read ? usize{150} : usize{1000});
+  const auto error_rate = is_short_read ? 0.01 : 0.05;
+  const auto num_reads = std::max(usize{1}, (depth * hap_len) / read_len);
+  std::bernoulli_distribution has_error(error_rate);
+
+  result.mReads.reserve(num_reads);
+  for (usize read_idx = 0; read_idx < num_reads; ++read_idx) {
+    const auto& source_hap = result.mHaplotypes[read_idx % num_haps];
+    std::uniform_int_distribution<usize> start_chooser(0, source_hap.length() - read_len);
+    const auto start_idx = start_chooser(generator);
+
+    auto sequence = source_hap.substr(start_idx, read_len);
+    for (auto& base : sequence) {
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (has_error(generator)) base = BASES.at(base_chooser(generator));
+    }
+
+    const auto is_tumor = read_idx % 2 == 0;
+    result.mReads.emplace_back(lancet::cbdg::Read::Fields{
+        .mStart0 = static_cast<i64>(WINDOW_START_POS1 - 1 + start_idx),
+        .mChromIdx = 0,
+        .mSamFlag = static_cast<u16>(read_idx % 4 < 2 ? 0 : 16),
+        .mMapQual = 60,
+        .mTag = is_tumor ? lancet::cbdg::Label::TUMOR : lancet::cbdg::Label::NORMAL,
+        .mQname = "read" + std::to_string(read_idx),
+        .mSequence = std::move(sequence),
+        .mSampleName = is_tumor ? "tumor" : "normal",
+        .mQuality = std::vector<u8>(read_len, 30),
+    });
+  }
+
+  result.mWindow = MakeWindow(ref_hap);
+  return result;
+}
+
+// Genotypes a synthetic window with `range(0)` haplotypes of length `range(1)` at read depth `range(2)`, with
+// the short read preset if `range(3)` is 0 and the ONT preset otherwise. Reports seconds per iteration spent
+// building minimap2 indices, mapping reads, generating CS tags and finding supported alleles with
+// `AddSupportingInfo`, along with reads genotyped per second.
+void GenotyperPhases(benchmark::State& state) {
+  const auto num_haps = static_cast<usize>(state.range(0));
+  const auto hap_len = static_cast<usize>(state.range(1));
+  const auto depth = static_cast<usize>(state.range(2));
+  const auto preset = state.range(3) == 0 ? Genotyper::Preset::ShortRead : Genotyper::Preset::LongReadONT;
+  const auto data = MakeSyntheticWindow(num_haps, hap_len, depth, preset);
+
+  const auto haplotypes = absl::MakeConstSpan(data.mHaplotypes);
+  const lancet::caller::MsaBuilder msa_builder(haplotypes);
+  const lancet::caller::VariantSet vset(msa_builder, *data.mWindow, WINDOW_START_POS1);
+
+  Genotyper genotyper(preset);
+  genotyper.SetNumSamples(2);
+  genotyper.EnablePhaseTimings();
+
+  Genotyper::PhaseTimings totals;
+  // NOLINTNEXTLINE(readability-identifier-length)
+  for ([[maybe_unused]] auto _ : state) {
+    auto genotyped = genotyper.Genotype(haplotypes, absl::MakeConstSpan(data.mReads), vset);
+    benchmark::DoNotOptimize(genotyped);
+
+    const auto& timings = genotyper.LastPhaseTimings();
+    totals.mIndexBuild += timings.mIndexBuild;
+    totals.mMapping += timings.mMapping;
+    totals.mCsGeneration += timings.mCsGeneration;
+    totals.mSupportingInfo += timings.mSupportingInfo;
+  }
+
+  const auto per_iteration = [](const absl::Duration total) {
+    return benchmark::Counter(absl::ToDoubleSeconds(total), benchmark::Counter::kAvgIterations);
+  };
+
+  const auto num_reads = static_cast<f64>(data.mReads.size());
+  state.counters["reads"] = num_reads;
+  state.counters["variants"] = static_cast<f64>(vset.Count());
+  state.counters["reads_per_second"] =
+      benchmark::Counter(num_reads * static_cast<f64>(state.iterations()), benchmark::Counter::kIsRate);
+  state.counters["index_build_seconds"] = per_iteration(totals.mIndexBuild);
+  state.counters["mapping_seconds"] = per_iteration(totals.mMapping);
+  state.counters["cs_generation_seconds"] = per_iteration(totals.mCsGeneration);
+  state.counters["supporting_info_seconds"] = per_iteration(totals.mSupportingInfo);
+}
+
+}  // namespace
+
+// NOLINTBEGIN
+BENCHMARK(GenotyperPhases)
+    ->Unit(benchmark::kMillisecond)
+    ->ArgNames({"haps", "hap_len", "depth", "ont"})
+    ->ArgsProduct({{2, 4, 8}, {500, 2000}, {50, 200, 1000}, {0, 1}});
+// NOLINTEND
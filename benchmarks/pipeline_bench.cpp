@@ -0,0 +1,54 @@
+#include <sys/resource.h>
+
+#include <string>
+
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "lancet/base/types.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window_timings.h"
+#include "test_data.h"
+
+namespace {
+
+// Peak resident set size of this process in bytes, which never decreases across benchmarks
+[[nodiscard]] auto PeakResidentBytes() -> f64 {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  // NOLINTNEXTLINE(readability-magic-numbers)
+  return static_cast<f64>(usage.ru_maxrss) * 1024.0;
+}
+
+// Runs every window of the bundled test data through `VariantBuilder::ProcessWindow`, as one worker thread of
+// a full run would. Reports windows per second, seconds per iteration spent in each stage and peak RSS.
+void PipelineProcessWindows(benchmark::State& state) {
+  using lancet::core::WindowTimings;
+  const auto windows = MakeTestDataWindows();
+  lancet::core::VariantBuilder builder(MakeTestDataParams());
+
+  WindowTimings total_timings;
+  // NOLINTNEXTLINE(readability-identifier-length)
+  for ([[maybe_unused]] auto _ : state) {
+    for (const auto& window : windows) {
+      auto variants = builder.ProcessWindow(window);
+      benchmark::DoNotOptimize(variants);
+      total_timings += builder.CurrentTimings();
+    }
+  }
+
+  const auto num_windows = static_cast<f64>(windows.size() * static_cast<usize>(state.iterations()));
+  state.counters["windows_per_second"] = benchmark::Counter(num_windows, benchmark::Counter::kIsRate);
+  for (usize idx = 0; idx < WindowTimings::NUM_STAGES; ++idx) {
+    const auto stage = static_cast<WindowTimings::Stage>(idx);
+    const auto stage_secs = absl::ToDoubleSeconds(total_timings.Get(stage));
+    state.counters[lancet::core::StageName(stage)] = benchmark::Counter(stage_secs, benchmark::Counter::kAvgIterations);
+  }
+  state.counters["peak_rss_bytes"] =
+      benchmark::Counter(PeakResidentBytes(), benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+
+}  // namespace
+
+// NOLINTBEGIN
+BENCHMARK(PipelineProcessWindows)->Unit(benchmark::kMillisecond)->UseRealTime();
+// NOLINTEND
@@ -0,0 +1,459 @@
+#include "read_simulator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/types/span.h"
+#include "htslib/hts.h"
+#include "htslib/sam.h"
+#include "lancet/base/types.h"
+#include "lancet/hts/extractor.h"
+#include "lancet/hts/reference.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+constexpr std::array<char, 4> BASES = {'A', 'C', 'G', 'T'};
+constexpr u8 MAPPING_QUALITY = 60;
+constexpr usize MAX_INDEL_LENGTH = 10;
+constexpr usize MAX_STR_UNIT_LENGTH = 6;
+constexpr usize MIN_STR_COPIES = 3;
+constexpr usize MIN_STR_LENGTH = 8;
+constexpr usize MAX_STR_EXTRA_COPIES = 10;
+// Min distance between planted variants, so that alleles never overlap and each is assembled on its own
+constexpr usize MIN_VARIANT_DISTANCE = 25;
+
+using HtsFile = std::unique_ptr<htsFile, lancet::hts::detail::HtsFileDeleter>;
+using SamHdr = std::unique_ptr<sam_hdr_t, lancet::hts::detail::SamHdrDeleter>;
+using Bam1 = std::unique_ptr<bam1_t, lancet::hts::detail::Bam1Deleter>;
+
+// Short tandem repeat in the reference, as the region offset of its first base and its repeat unit
+struct RepeatTract {
+  usize mStart = 0;
+  usize mUnitLength = 0;
+  usize mNumCopies = 0;
+};
+
+[[nodiscard]] auto FindRepeatTracts(const std::string& seq) -> std::vector<RepeatTract> {
+  std::vector<RepeatTract> results;
+  usize start = 0;
+  while (start < seq.length()) {
+    RepeatTract best{.mStart = start, .mUnitLength = 1, .mNumCopies = 1};
+    for (usize unit_len = 1; unit_len <= MAX_STR_UNIT_LENGTH; ++unit_len) {
+      usize num_copies = 1;
+      while (start + ((num_copies + 1) * unit_len) <= seq.length() &&
+             seq.compare(start + (num_copies * unit_len), unit_len, seq, start, unit_len) == 0) {
+        num_copies++;
+      }
+
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (num_copies * unit_len > best.mNumCopies * best.mUnitLength) best = {start, unit_len, num_copies};
+    }
+
+    const auto tract_len = best.mNumCopies * best.mUnitLength;
+    const auto is_tract = best.mNumCopies >= MIN_STR_COPIES && tract_len >= MIN_STR_LENGTH;
+    const auto has_no_n = seq.find('N', start) >= start + tract_len;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (is_tract && has_no_n) results.emplace_back(best);
+    start += is_tract ? tract_len : 1;
+  }
+  return results;
+}
+
+// Simulated alignment of one read, with its sequence on the forward strand of the reference
+struct SimRead {
+  std::string mQname;
+  u16 mFlag = 0;
+  i64 mPos0 = 0;
+  i64 mEndPos0 = 0;
+  i64 mMatePos0 = 0;
+  i64 mInsertSize = 0;
+  std::vector<u32> mCigar;
+  std::string mSequence;
+  std::string mMdTag;
+};
+
+// Builds the CIGAR and MD tag of `bases` aligned to `ref_offsets` as described by the haplotype offsets.
+// Inserted bases at either end of the read are soft clipped. False if no base is aligned to the reference.
+[[nodiscard]] auto AlignToReference(const std::string& bases, absl::Span<const i64> ref_offsets,
+                                    const std::string& ref_seq, const i64 region_start0, SimRead* read) -> bool {
+  static const auto is_aligned = [](const i64 offset) { return offset >= 0; };
+  const auto first_aligned = std::ranges::find_if(ref_offsets, is_aligned);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (first_aligned == ref_offsets.end()) return false;
+  const auto last_aligned = std::find_if(ref_offsets.rbegin(), ref_offsets.rend(), is_aligned);
+  const auto first_idx = static_cast<usize>(first_aligned - ref_offsets.begin());
+  const auto last_idx = ref_offsets.size() - 1 - static_cast<usize>(last_aligned - ref_offsets.rbegin());
+
+  read->mSequence = bases;
+  read->mCigar.clear();
+  read->mMdTag.clear();
+  read->mPos0 = region_start0 + *first_aligned;
+  read->mEndPos0 = region_start0 + *last_aligned + 1;
+
+  const auto add_cigar = [&cigar = read->mCigar](const u32 op, const usize len) {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (len == 0) return;
+    if (!cigar.empty() && bam_cigar_op(cigar.back()) == op) {
+      cigar.back() = bam_cigar_gen(bam_cigar_oplen(cigar.back()) + len, op);
+      return;
+    }
+    cigar.push_back(bam_cigar_gen(len, op));
+  };
+
+  usize num_md_matches = 0;
+  const auto add_md_event = [&md_tag = read->mMdTag, &num_md_matches](const std::string& event) {
+    md_tag += std::to_string(num_md_matches) + event;
+    num_md_matches = 0;
+  };
+
+  add_cigar(BAM_CSOFT_CLIP, first_idx);
+  auto prev_offset = *first_aligned - 1;
+  for (usize idx = first_idx; idx <= last_idx; ++idx) {
+    const auto offset = ref_offsets[idx];
+    if (offset < 0) {
+      add_cigar(BAM_CINS, 1);
+      continue;
+    }
+
+    if (offset > prev_offset + 1) {
+      const auto num_deleted = static_cast<usize>(offset - prev_offset - 1);
+      add_cigar(BAM_CDEL, num_deleted);
+      add_md_event("^" + ref_seq.substr(static_cast<usize>(prev_offset + 1), num_deleted));
+    }
+
+    add_cigar(BAM_CMATCH, 1);
+    const auto ref_base = ref_seq[static_cast<usize>(offset)];
+    if (bases[idx] == ref_base) {
+      num_md_matches++;
+    } else {
+      add_md_event(std::string(1, ref_base));
+    }
+    prev_offset = offset;
+  }
+
+  read->mMdTag += std::to_string(num_md_matches);
+  add_cigar(BAM_CSOFT_CLIP, bases.length() - 1 - last_idx);
+  return true;
+}
+
+}  // namespace
+
+ReadSimulator::ReadSimulator(Params params) : mParams(std::move(params)) {
+  const lancet::hts::Reference ref(mParams.mRefPath);
+  auto region = ref.MakeRegion(mParams.mRegion.c_str());
+  mChromName = region.ChromName();
+  mChromIdx = static_cast<i32>(region.ChromIndex());
+  mRegionStart1 = region.StartPos1();
+  mRefSeq = std::string(region.SeqView());
+  absl::AsciiStrToUpper(&mRefSeq);
+
+  if (mRefSeq.length() < 4 * (mParams.mFragmentMean + mParams.mFragmentStdDev)) {
+    throw std::invalid_argument(fmt::format("Region {} is too short to simulate reads from", mParams.mRegion));
+  }
+
+  for (const auto& chrom : ref.ListChroms()) {
+    mHeaderChroms += fmt::format("@SQ\tSN:{}\tLN:{}\n", chrom.Name(), chrom.Length());
+  }
+
+  std::mt19937_64 generator(mParams.mSeed);
+  PlantVariants(generator);
+  mRefHaplotype = MakeHaplotype(false, false);
+  mNormalHaplotype = MakeHaplotype(true, false);
+  mTumorHaplotype = MakeHaplotype(true, true);
+}
+
+auto ReadSimulator::Write(const std::filesystem::path& tumor_bam, const std::filesystem::path& normal_bam) const
+    -> absl::Status {
+  // Samples are simulated with different seeds, so that their reads are sampled independently
+  const auto& prms = mParams;
+  const auto tumor_status = WriteSample(tumor_bam, "tumor", prms.mTumorDepth, prms.mTumorPurity, prms.mSeed + 1);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!tumor_status.ok()) return tumor_status;
+  return WriteSample(normal_bam, "normal", prms.mNormalDepth, 0.0, prms.mSeed + 2);
+}
+
+void ReadSimulator::PlantVariants(std::mt19937_64& generator) {
+  // Variants are kept a fragment away from the region ends, so that they are covered by full depth
+  const auto margin = mParams.mFragmentMean + mParams.mFragmentStdDev;
+  std::uniform_int_distribution<usize> offset_chooser(margin, mRefSeq.length() - margin - 1);
+  std::uniform_int_distribution<usize> base_chooser(0, BASES.size() - 1);
+  std::uniform_int_distribution<usize> indel_len_chooser(1, MAX_INDEL_LENGTH);
+  std::uniform_int_distribution<usize> extra_copies_chooser(2, MAX_STR_EXTRA_COPIES);
+  std::bernoulli_distribution is_somatic(mParams.mSomaticFraction);
+  std::bernoulli_distribution is_insertion(0.5);
+
+  // Offsets of the first and last reference allele bases of planted variants
+  std::vector<std::pair<usize, usize>> used_spans;
+  const auto is_available = [&used_spans](const usize first, const usize last) {
+    return std::ranges::none_of(used_spans, [first, last](const auto& span) {
+      return first <= span.second + MIN_VARIANT_DISTANCE && span.first <= last + MIN_VARIANT_DISTANCE;
+    });
+  };
+
+  const auto add_variant = [this, &used_spans, &generator, &is_somatic](const usize offset, std::string ref_allele,
+                                                                          std::string alt_allele) {
+    used_spans.emplace_back(offset, offset + ref_allele.length() - 1);
+    mVariants.emplace_back(Variant{.mPos1 = mRegionStart1 + offset,
+                                   .mRefAllele = std::move(ref_allele),
+                                   .mAltAllele = std::move(alt_allele),
+                                   .mIsSomatic = is_somatic(generator)});
+  };
+
+  // Attempts are capped, so that crowded or N rich regions plant fewer variants instead of looping forever
+  const auto max_attempts = 100 * (mParams.mNumSnvs + mParams.mNumIndels + mParams.mNumStrExpansions);
+  usize num_attempts = 0;
+
+  const auto tracts = FindRepeatTracts(mRefSeq);
+  std::vector<RepeatTract> inner_tracts;
+  std::ranges::copy_if(tracts, std::back_inserter(inner_tracts), [this, margin](const RepeatTract& tract) {
+    return tract.mStart > margin && tract.mStart + (tract.mUnitLength * tract.mNumCopies) < mRefSeq.length() - margin;
+  });
+
+  usize num_strs = 0;
+  while (num_strs < mParams.mNumStrExpansions && !inner_tracts.empty() && num_attempts++ < max_attempts) {
+    std::uniform_int_distribution<usize> tract_chooser(0, inner_tracts.size() - 1);
+    const auto& tract = inner_tracts[tract_chooser(generator)];
+    const auto tract_end = tract.mStart + (tract.mUnitLength * tract.mNumCopies) - 1;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!is_available(tract.mStart - 1, tract_end)) continue;
+
+    // Extra copies are inserted after the anchor base before the tract, which left aligns the insertion
+    const auto anchor = mRefSeq.substr(tract.mStart - 1, 1);
+    const auto unit = mRefSeq.substr(tract.mStart, tract.mUnitLength);
+    auto alt_allele = anchor;
+    const auto num_extra_copies = extra_copies_chooser(generator);
+    for (usize idx = 0; idx < num_extra_copies; ++idx) {
+      alt_allele += unit;
+    }
+
+    // Whole tract is marked as used, so that no other variant is planted inside the repeat
+    used_spans.emplace_back(tract.mStart, tract_end);
+    add_variant(tract.mStart - 1, anchor, std::move(alt_allele));
+    num_strs++;
+  }
+
+  usize num_snvs = 0;
+  while (num_snvs < mParams.mNumSnvs && num_attempts++ < max_attempts) {
+    const auto offset = offset_chooser(generator);
+    const auto ref_base = mRefSeq[offset];
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (ref_base == 'N' || !is_available(offset, offset)) continue;
+
+    auto alt_base = ref_base;
+    while (alt_base == ref_base) {
+      alt_base = BASES.at(base_chooser(generator));
+    }
+
+    add_variant(offset, std::string(1, ref_base), std::string(1, alt_base));
+    num_snvs++;
+  }
+
+  usize num_indels = 0;
+  while (num_indels < mParams.mNumIndels && num_attempts++ < max_attempts) {
+    const auto offset = offset_chooser(generator);
+    const auto indel_len = indel_len_chooser(generator);
+    const auto last_offset = offset + indel_len;
+    const auto has_n = mRefSeq.find('N', offset) <= last_offset;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (has_n || !is_available(offset, last_offset)) continue;
+
+    if (is_insertion(generator)) {
+      auto alt_allele = mRefSeq.substr(offset, 1);
+      for (usize idx = 0; idx < indel_len; ++idx) {
+        alt_allele += BASES.at(base_chooser(generator));
+      }
+      add_variant(offset, mRefSeq.substr(offset, 1), std::move(alt_allele));
+    } else {
+      add_variant(offset, mRefSeq.substr(offset, indel_len + 1), mRefSeq.substr(offset, 1));
+    }
+    num_indels++;
+  }
+
+  std::ranges::sort(mVariants, [](const Variant& lhs, const Variant& rhs) { return lhs.mPos1 < rhs.mPos1; });
+}
+
+auto ReadSimulator::MakeHaplotype(const bool with_germline, const bool with_somatic) const -> Haplotype {
+  Haplotype result;
+  result.mSequence.reserve(mRefSeq.length());
+  result.mRefOffsets.reserve(mRefSeq.length());
+
+  usize next_offset = 0;
+  const auto copy_ref_until = [this, &result, &next_offset](const usize end_offset) {
+    result.mSequence.append(mRefSeq, next_offset, end_offset - next_offset);
+    for (; next_offset < end_offset; ++next_offset) {
+      result.mRefOffsets.push_back(static_cast<i64>(next_offset));
+    }
+  };
+
+  for (const auto& variant : mVariants) {
+    const auto is_included = variant.mIsSomatic ? with_somatic : with_germline;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!is_included) continue;
+
+    // Shared leading bases of both alleles are aligned to the reference, and remaining alt bases are inserted
+    const auto offset = static_cast<usize>(variant.mPos1 - mRegionStart1);
+    copy_ref_until(offset);
+    const auto num_aligned = std::min(variant.mRefAllele.length(), variant.mAltAllele.length());
+    for (usize idx = 0; idx < variant.mAltAllele.length(); ++idx) {
+      result.mSequence.push_back(variant.mAltAllele[idx]);
+      result.mRefOffsets.push_back(idx < num_aligned ? static_cast<i64>(offset + idx) : -1);
+    }
+    next_offset = offset + variant.mRefAllele.length();
+  }
+
+  copy_ref_until(mRefSeq.length());
+  return result;
+}
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto ReadSimulator::WriteSample(const std::filesystem::path& path, const std::string& sample_name, const f64 depth,
+                                const f64 purity, const u64 seed) const -> absl::Status {
+  std::mt19937_64 generator(seed);
+  std::bernoulli_distribution is_alt_haplotype(0.5);
+  std::bernoulli_distribution is_tumor_cell(purity);
+  std::bernoulli_distribution is_duplicate(mParams.mDuplicateRate);
+  std::bernoulli_distribution is_forward_fragment(0.5);
+  std::normal_distribution<f64> fragment_len_chooser(static_cast<f64>(mParams.mFragmentMean),
+                                                     static_cast<f64>(mParams.mFragmentStdDev));
+  std::uniform_real_distribution<f64> error_chooser(0.0, 1.0);
+  std::uniform_int_distribution<usize> base_chooser(0, BASES.size() - 1);
+
+  const auto& errors = mParams.mErrors;
+  const auto insertion_cutoff = errors.mSubstitutionRate + errors.mInsertionRate;
+  const auto deletion_cutoff = insertion_cutoff + errors.mDeletionRate;
+
+  // Sequencing errors are applied to a copy of the read bases, along with their reference offsets
+  std::string read_bases;
+  std::vector<i64> read_offsets;
+  const auto sequence_read = [&](const Haplotype& hap, const usize start, const usize length) {
+    read_bases.clear();
+    read_offsets.clear();
+    for (usize idx = start; idx < start + length; ++idx) {
+      const auto draw = error_chooser(generator);
+      const auto base = hap.mSequence[idx];
+      const auto offset = hap.mRefOffsets[idx];
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (draw >= insertion_cutoff && draw < deletion_cutoff) continue;
+
+      auto called_base = base;
+      while (draw < errors.mSubstitutionRate && called_base == base) {
+        called_base = BASES.at(base_chooser(generator));
+      }
+
+      read_bases.push_back(called_base);
+      read_offsets.push_back(offset);
+      if (draw >= errors.mSubstitutionRate && draw < insertion_cutoff) {
+        read_bases.push_back(BASES.at(base_chooser(generator)));
+        read_offsets.push_back(-1);
+      }
+    }
+  };
+
+  const auto read_len = mParams.mReadLength;
+  const auto region_start0 = static_cast<i64>(mRegionStart1 - 1);
+  const auto num_pairs = static_cast<usize>(std::llround(depth * static_cast<f64>(mRefSeq.length()) /
+                                                         (2.0 * static_cast<f64>(read_len))));
+
+  std::vector<SimRead> reads;
+  reads.reserve(2 * num_pairs);
+  for (usize pair_idx = 0; pair_idx < num_pairs; ++pair_idx) {
+    const auto& cell_hap = is_tumor_cell(generator) ? mTumorHaplotype : mNormalHaplotype;
+    const auto& hap = is_alt_haplotype(generator) ? cell_hap : mRefHaplotype;
+    const auto hap_len = hap.mSequence.length();
+    const auto drawn_len = std::llround(fragment_len_chooser(generator));
+    const auto frag_len = std::clamp(static_cast<usize>(std::max(drawn_len, 0LL)), read_len, hap_len);
+    std::uniform_int_distribution<usize> start_chooser(0, hap_len - frag_len);
+    const auto frag_start = start_chooser(generator);
+
+    SimRead left;
+    SimRead right;
+    sequence_read(hap, frag_start, read_len);
+    const auto has_left = AlignToReference(read_bases, read_offsets, mRefSeq, region_start0, &left);
+    sequence_read(hap, frag_start + frag_len - read_len, read_len);
+    const auto has_right = AlignToReference(read_bases, read_offsets, mRefSeq, region_start0, &right);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!has_left || !has_right) continue;
+
+    // Left read is on the forward strand, and is the first read of forward fragments
+    const auto left_is_read1 = is_forward_fragment(generator);
+    const auto qname = fmt::format("sim:{}:{}", sample_name, pair_idx);
+    constexpr auto pair_flag = BAM_FPAIRED | BAM_FPROPER_PAIR;
+    const auto frag_span = right.mEndPos0 - left.mPos0;
+    left.mQname = qname;
+    left.mFlag = static_cast<u16>(pair_flag | BAM_FMREVERSE | (left_is_read1 ? BAM_FREAD1 : BAM_FREAD2));
+    left.mMatePos0 = right.mPos0;
+    left.mInsertSize = frag_span;
+    right.mQname = qname;
+    right.mFlag = static_cast<u16>(pair_flag | BAM_FREVERSE | (left_is_read1 ? BAM_FREAD2 : BAM_FREAD1));
+    right.mMatePos0 = left.mPos0;
+    right.mInsertSize = -frag_span;
+
+    if (is_duplicate(generator)) {
+      for (auto dup : {left, right}) {
+        dup.mQname += ":dup";
+        dup.mFlag |= BAM_FDUP;
+        reads.emplace_back(std::move(dup));
+      }
+    }
+
+    reads.emplace_back(std::move(left));
+    reads.emplace_back(std::move(right));
+  }
+
+  std::ranges::stable_sort(reads, [](const SimRead& lhs, const SimRead& rhs) { return lhs.mPos0 < rhs.mPos0; });
+
+  const auto header_text = fmt::format("@HD\tVN:1.6\tSO:coordinate\n{}@RG\tID:{}\tSM:{}\n", mHeaderChroms,
+                                       sample_name, sample_name);
+  const SamHdr header(sam_hdr_parse(header_text.length(), header_text.c_str()));
+  HtsFile out_file(sam_open(path.c_str(), "wb"));
+  if (header == nullptr || out_file == nullptr || sam_hdr_write(out_file.get(), header.get()) < 0) {
+    return absl::Status(absl::StatusCode::kInternal, fmt::format("Could not open {}", path.string()));
+  }
+
+  const Bam1 record(bam_init1());
+  std::string quals;
+  for (const auto& read : reads) {
+    // Qualities are raw phred values, and reads with sequencing errors can differ from the read length
+    quals.assign(read.mSequence.length(), static_cast<char>(errors.mBaseQual));
+    const auto aux_len = sample_name.length() + read.mMdTag.length() + 8;
+    const auto set_status = bam_set1(record.get(), read.mQname.length(), read.mQname.c_str(), read.mFlag, mChromIdx,
+                                     read.mPos0, MAPPING_QUALITY, read.mCigar.size(), read.mCigar.data(), mChromIdx,
+                                     read.mMatePos0, read.mInsertSize, read.mSequence.length(), read.mSequence.c_str(),
+                                     quals.c_str(), aux_len);
+
+    // Aux values of type Z are written with their terminating null character
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* rg_data = reinterpret_cast<const u8*>(sample_name.c_str());
+    const auto* md_data = reinterpret_cast<const u8*>(read.mMdTag.c_str());
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto is_written = set_status >= 0 &&
+                            bam_aux_append(record.get(), "RG", 'Z', static_cast<int>(sample_name.length() + 1),
+                                           rg_data) == 0 &&
+                            bam_aux_append(record.get(), "MD", 'Z', static_cast<int>(read.mMdTag.length() + 1),
+                                           md_data) == 0 &&
+                            sam_write1(out_file.get(), header.get(), record.get()) >= 0;
+
+    if (!is_written) {
+      return absl::Status(absl::StatusCode::kInternal, fmt::format("Could not write {}", path.string()));
+    }
+  }
+
+  out_file.reset();
+  if (sam_index_build(path.c_str(), 0) != 0) {
+    return absl::Status(absl::StatusCode::kInternal, fmt::format("Could not index {}", path.string()));
+  }
+
+  return absl::OkStatus();
+}
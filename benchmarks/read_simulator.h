@@ -0,0 +1,110 @@
+#ifndef BENCHMARKS_READ_SIMULATOR_H_
+#define BENCHMARKS_READ_SIMULATOR_H_
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "lancet/base/types.h"
+
+// Simulates paired end reads of a tumor/normal pair from one region of a reference, and writes them as
+// coordinate sorted and indexed BAMs. Germline variants are heterozygous in both samples, and somatic variants
+// are heterozygous in the tumor cells only, so their allele frequency in tumor reads is half the tumor purity.
+// Simulated reads are aligned to the reference by construction, with CIGAR and MD tags that include planted
+// variants and sequencing errors. Same parameters and seed always simulate the same reads.
+class ReadSimulator {
+ public:
+  struct ErrorProfile {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    // Per base rates of sequencing errors
+    f64 mSubstitutionRate = 0.001;
+    f64 mInsertionRate = 0.0001;
+    f64 mDeletionRate = 0.0001;
+    u8 mBaseQual = 30;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  struct Params {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    std::filesystem::path mRefPath;
+    // Samtools style region to simulate reads from, e.g. `1:82940001-82960000`
+    std::string mRegion;
+
+    f64 mTumorDepth = 60.0;
+    f64 mNormalDepth = 40.0;
+    usize mReadLength = 150;
+    usize mFragmentMean = 400;
+    usize mFragmentStdDev = 50;
+    ErrorProfile mErrors;
+
+    // Fraction of tumor reads sampled from tumor cells, the rest are sampled from normal cells
+    f64 mTumorPurity = 1.0;
+    // Fraction of read pairs written a second time, flagged as duplicates
+    f64 mDuplicateRate = 0.0;
+
+    usize mNumSnvs = 10;
+    usize mNumIndels = 5;
+    // Extra copies of a unit inserted into short tandem repeats already present in the reference
+    usize mNumStrExpansions = 0;
+    // Fraction of planted variants that are somatic, the rest are germline
+    f64 mSomaticFraction = 0.5;
+
+    u64 mSeed = 42;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  struct Variant {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    // 1-based position of the first reference allele base, with VCF style anchor bases for indels
+    u64 mPos1 = 0;
+    std::string mRefAllele;
+    std::string mAltAllele;
+    bool mIsSomatic = false;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  // Throws if the region is not in the reference or is shorter than a few fragments
+  explicit ReadSimulator(Params params);
+
+  // Variants planted into the simulated genomes, sorted by position
+  [[nodiscard]] auto PlantedVariants() const noexcept -> absl::Span<const Variant> { return mVariants; }
+
+  // Writes one BAM with its BAI index for each sample. Sample names in the read groups are `tumor` and `normal`.
+  [[nodiscard]] auto Write(const std::filesystem::path& tumor_bam, const std::filesystem::path& normal_bam) const
+      -> absl::Status;
+
+ private:
+  // Haplotype sequence, with the 0-based region offset of the reference base aligned to each haplotype base,
+  // or -1 for inserted bases. Deleted reference bases are skipped in the offsets.
+  struct Haplotype {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    std::string mSequence;
+    std::vector<i64> mRefOffsets;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  Params mParams;
+  std::string mChromName;
+  i32 mChromIdx = -1;
+  u64 mRegionStart1 = 0;
+  std::string mRefSeq;
+  std::string mHeaderChroms;
+  std::vector<Variant> mVariants;
+
+  // Reference haplotype, and the other haplotype of normal cells and of tumor cells
+  Haplotype mRefHaplotype;
+  Haplotype mNormalHaplotype;
+  Haplotype mTumorHaplotype;
+
+  void PlantVariants(std::mt19937_64& generator);
+  [[nodiscard]] auto MakeHaplotype(bool with_germline, bool with_somatic) const -> Haplotype;
+
+  // Samples reads from tumor cells with probability `purity`, and from normal cells otherwise
+  [[nodiscard]] auto WriteSample(const std::filesystem::path& path, const std::string& sample_name, f64 depth,
+                                 f64 purity, u64 seed) const -> absl::Status;
+};
+
+#endif  // BENCHMARKS_READ_SIMULATOR_H_
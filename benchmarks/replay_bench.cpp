@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "lancet/base/timer.h"
+#include "lancet/base/types.h"
+#include "lancet/caller/genotyper.h"
+#include "lancet/caller/msa_builder.h"
+#include "lancet/caller/variant_set.h"
+#include "lancet/cbdg/graph.h"
+#include "lancet/core/window_capture.h"
+
+namespace {
+
+// Benchmark binaries have no options of their own, so the directory written with `--capture-windows` is read
+// from the environment. No replay benchmarks are registered when it is not set.
+constexpr auto CAPTURE_DIR_ENV_VAR = "LANCET_CAPTURED_WINDOWS";
+
+// Replays one captured window through graph assembly, MSA building and genotyping the same way as
+// `VariantBuilder::BuildVariants`, without any alignment or reference I/O in the timed loop. Reports seconds
+// per iteration spent in each of the three stages.
+void ReplayCapturedWindow(benchmark::State& state, const std::filesystem::path& capture_path) {
+  using lancet::core::WindowCapture;
+  const auto capture = WindowCapture::Read(capture_path);
+  if (!capture.ok()) {
+    state.SkipWithError(std::string(capture.status().message()).c_str());
+    return;
+  }
+
+  const auto window = capture->MakeWindow();
+  const auto region = window->AsRegionPtr();
+  const auto reads = capture->Reads();
+  lancet::cbdg::Graph graph(capture->GraphParams());
+  lancet::caller::Genotyper genotyper;
+  genotyper.SetNumSamples(capture->Samples().size());
+  genotyper.SetIsGermlineMode(capture->IsGermlineMode());
+
+  auto graph_runtime = absl::ZeroDuration();
+  auto msa_runtime = absl::ZeroDuration();
+  auto genotype_runtime = absl::ZeroDuration();
+  // NOLINTNEXTLINE(readability-identifier-length)
+  for ([[maybe_unused]] auto _ : state) {
+    Timer timer;
+    const auto dbg_rslt = graph.BuildComponentHaplotypes(region, reads);
+    graph_runtime += timer.Runtime();
+
+    for (usize idx = 0; idx < dbg_rslt.mGraphHaplotypes.size(); ++idx) {
+      const absl::Span<const std::string> haplotypes = absl::MakeConstSpan(dbg_rslt.mGraphHaplotypes[idx]);
+      timer.Reset();
+      const lancet::caller::MsaBuilder msa_builder(haplotypes);
+      const lancet::caller::VariantSet vset(msa_builder, *window, window->StartPos1() + dbg_rslt.mAnchorStartIdxs[idx]);
+      msa_runtime += timer.Runtime();
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (vset.IsEmpty()) continue;
+
+      timer.Reset();
+      auto genotyped = genotyper.Genotype(haplotypes, reads, vset);
+      genotype_runtime += timer.Runtime();
+      benchmark::DoNotOptimize(genotyped);
+    }
+  }
+
+  state.counters["reads"] = static_cast<f64>(reads.size());
+  state.counters["graph_seconds"] =
+      benchmark::Counter(absl::ToDoubleSeconds(graph_runtime), benchmark::Counter::kAvgIterations);
+  state.counters["msa_seconds"] =
+      benchmark::Counter(absl::ToDoubleSeconds(msa_runtime), benchmark::Counter::kAvgIterations);
+  state.counters["genotype_seconds"] =
+      benchmark::Counter(absl::ToDoubleSeconds(genotype_runtime), benchmark::Counter::kAvgIterations);
+}
+
+// Registers one benchmark for each captured window, named after the capture file
+[[nodiscard]] auto RegisterCapturedWindows() -> usize {
+  const auto* capture_dir = std::getenv(CAPTURE_DIR_ENV_VAR);  // NOLINT(concurrency-mt-unsafe)
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (capture_dir == nullptr) return 0;
+
+  std::error_code err_code;
+  std::vector<std::filesystem::path> capture_paths;
+  for (const auto& entry : std::filesystem::directory_iterator(capture_dir, err_code)) {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (entry.is_regular_file() && entry.path().extension() == ".gz") capture_paths.push_back(entry.path());
+  }
+
+  std::ranges::sort(capture_paths);
+  for (const auto& capture_path : capture_paths) {
+    const auto name = "ReplayCapturedWindows/" + capture_path.filename().string();
+    benchmark::RegisterBenchmark(name.c_str(), ReplayCapturedWindow, capture_path)->Unit(benchmark::kMillisecond);
+  }
+
+  return capture_paths.size();
+}
+
+}  // namespace
+
+// NOLINTBEGIN
+[[maybe_unused]] static const auto NUM_CAPTURED_WINDOWS = RegisterCapturedWindows();
+// NOLINTEND
@@ -0,0 +1,144 @@
+#include <unistd.h>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "lancet/base/types.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window.h"
+#include "lancet/core/window_builder.h"
+#include "lancet/core/window_timings.h"
+#include "lancet_benchmark_config.h"
+#include "read_simulator.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+// Slice of the bundled chr1 reference that reads are simulated from, next to the bundled CRAM region
+constexpr auto SIMULATED_REGION = "1:82940001-82960000";
+
+// Directory of the simulated BAMs, which is removed along with them when the data cache is destroyed at exit
+class SimulatedDir {
+ public:
+  SimulatedDir() = default;
+  ~SimulatedDir() {
+    std::error_code err_code;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!mPath.empty()) std::filesystem::remove_all(mPath, err_code);
+  }
+
+  SimulatedDir(const SimulatedDir&) = delete;
+  SimulatedDir(SimulatedDir&&) = delete;
+  auto operator=(const SimulatedDir&) -> SimulatedDir& = delete;
+  auto operator=(SimulatedDir&&) -> SimulatedDir& = delete;
+
+  void Create(std::filesystem::path path) {
+    mPath = std::move(path);
+    std::filesystem::create_directories(mPath);
+  }
+
+  [[nodiscard]] auto Path() const -> const std::filesystem::path& { return mPath; }
+
+ private:
+  std::filesystem::path mPath;
+};
+
+struct SimulatedData {
+  SimulatedDir mDir;
+  std::shared_ptr<const lancet::core::VariantBuilder::Params> mParams;
+  std::vector<lancet::core::WindowPtr> mWindows;
+  usize mNumPlantedVariants = 0;
+};
+
+// Simulates tumor and normal BAMs at `depth` with `num_strs` STR expansions into a directory of this process
+// under the temp directory, once for each combination of arguments. BAMs are removed when the process exits
+// normally, and are left behind if it is killed or crashes.
+[[nodiscard]] auto SimulateData(const usize depth, const usize num_strs) -> const SimulatedData& {
+  static std::map<std::pair<usize, usize>, SimulatedData> cache;
+  const auto [itr, newly_added] = cache.try_emplace({depth, num_strs});
+  auto& result = itr->second;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!newly_added) return result;
+
+  ReadSimulator::Params sim_params;
+  sim_params.mRefPath = TestReference;
+  sim_params.mRegion = SIMULATED_REGION;
+  sim_params.mTumorDepth = static_cast<f64>(depth);
+  sim_params.mNormalDepth = static_cast<f64>(depth);
+  // NOLINTNEXTLINE(readability-magic-numbers)
+  sim_params.mTumorPurity = 0.8;
+  // NOLINTNEXTLINE(readability-magic-numbers)
+  sim_params.mDuplicateRate = 0.05;
+  sim_params.mNumStrExpansions = num_strs;
+  const ReadSimulator simulator(sim_params);
+
+  const auto dir_name = fmt::format("lancet_sim_{}_{}x_{}str", getpid(), depth, num_strs);
+  result.mDir.Create(std::filesystem::temp_directory_path() / dir_name);
+  const auto tumor_bam = result.mDir.Path() / "tumor.bam";
+  const auto normal_bam = result.mDir.Path() / "normal.bam";
+  const auto status = simulator.Write(tumor_bam, normal_bam);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!status.ok()) throw std::runtime_error(std::string(status.message()));
+
+  lancet::core::VariantBuilder::Params params;
+  params.mRdCollParams.mRefPath = TestReference;
+  params.mRdCollParams.mNormalPaths = {normal_bam};
+  params.mRdCollParams.mTumorPaths = {tumor_bam};
+  result.mParams = std::make_shared<const lancet::core::VariantBuilder::Params>(std::move(params));
+  result.mNumPlantedVariants = simulator.PlantedVariants().size();
+
+  using lancet::core::WindowBuilder;
+  WindowBuilder builder(TestReference, WindowBuilder::Params{});
+  builder.AddRegion(SIMULATED_REGION);
+  auto generator = builder.MakeGenerator();
+  for (auto window = generator.Next(); window != nullptr; window = generator.Next()) {
+    result.mWindows.emplace_back(std::move(window));
+  }
+  return result;
+}
+
+// Runs every window of reads simulated at depth `range(0)` with `range(1)` STR expansions through
+// `VariantBuilder::ProcessWindow`. High depths stress downsampling in `ReadCollector` and genotyping, and
+// STR expansions stress graph assembly in repeats. Reads are simulated before the benchmark is timed.
+void SimulatedProcessWindows(benchmark::State& state) {
+  using lancet::core::WindowTimings;
+  const auto& data = SimulateData(static_cast<usize>(state.range(0)), static_cast<usize>(state.range(1)));
+  lancet::core::VariantBuilder builder(data.mParams);
+
+  WindowTimings total_timings;
+  // NOLINTNEXTLINE(readability-identifier-length)
+  for ([[maybe_unused]] auto _ : state) {
+    for (const auto& window : data.mWindows) {
+      auto variants = builder.ProcessWindow(window);
+      benchmark::DoNotOptimize(variants);
+      total_timings += builder.CurrentTimings();
+    }
+  }
+
+  const auto num_windows = static_cast<f64>(data.mWindows.size() * static_cast<usize>(state.iterations()));
+  state.counters["planted_variants"] = static_cast<f64>(data.mNumPlantedVariants);
+  state.counters["windows_per_second"] = benchmark::Counter(num_windows, benchmark::Counter::kIsRate);
+  for (usize idx = 0; idx < WindowTimings::NUM_STAGES; ++idx) {
+    const auto stage = static_cast<WindowTimings::Stage>(idx);
+    const auto stage_secs = absl::ToDoubleSeconds(total_timings.Get(stage));
+    state.counters[lancet::core::StageName(stage)] = benchmark::Counter(stage_secs, benchmark::Counter::kAvgIterations);
+  }
+}
+
+}  // namespace
+
+// NOLINTBEGIN
+BENCHMARK(SimulatedProcessWindows)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->ArgNames({"depth", "strs"})
+    ->ArgsProduct({{100, 1000}, {0, 25}});
+// NOLINTEND
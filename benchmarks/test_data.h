@@ -0,0 +1,37 @@
+#ifndef BENCHMARKS_TEST_DATA_H_
+#define BENCHMARKS_TEST_DATA_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window.h"
+#include "lancet/core/window_builder.h"
+#include "lancet_benchmark_config.h"
+
+// Bundled tumor and normal CRAMs only have reads in this region of the bundled chr1 reference
+constexpr auto TEST_DATA_REGION = "1:82960500-82969500";
+
+[[nodiscard]] inline auto MakeTestDataWindows() -> std::vector<lancet::core::WindowPtr> {
+  using lancet::core::WindowBuilder;
+  WindowBuilder builder(TestReference, WindowBuilder::Params{});
+  builder.AddRegion(TEST_DATA_REGION);
+
+  std::vector<lancet::core::WindowPtr> results;
+  auto generator = builder.MakeGenerator();
+  for (auto window = generator.Next(); window != nullptr; window = generator.Next()) {
+    results.emplace_back(std::move(window));
+  }
+  return results;
+}
+
+[[nodiscard]] inline auto MakeTestDataParams() -> std::shared_ptr<const lancet::core::VariantBuilder::Params> {
+  lancet::core::VariantBuilder::Params params;
+  params.mRdCollParams.mRefPath = TestReference;
+  params.mRdCollParams.mNormalPaths = {TestNormalCram};
+  params.mRdCollParams.mTumorPaths = {TestTumorCram};
+  return std::make_shared<const lancet::core::VariantBuilder::Params>(std::move(params));
+}
+
+#endif  // BENCHMARKS_TEST_DATA_H_
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/ascii.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "blockingconcurrentqueue.h"
+#include "lancet/base/timer.h"
+#include "lancet/base/types.h"
+#include "lancet/base/wait_stats.h"
+#include "lancet/core/async_worker.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/variant_store.h"
+#include "lancet/core/window.h"
+#include "test_data.h"
+
+namespace {
+
+using lancet::core::AsyncWorker;
+
+// Every thread count processes the same window set, which has at least this many windows per thread at the
+// largest thread count, so that the tail of the run where threads run out of windows stays short
+constexpr usize MIN_WINDOWS_PER_THREAD = 8;
+// Variants are flushed before the window this many windows behind the last done window, as in `PipelineRunner`
+constexpr usize FLUSH_LAG_WINDOWS = 100;
+
+[[nodiscard]] auto MaxThreads() -> usize { return std::max(1U, std::thread::hardware_concurrency()); }
+
+// Number of times the bundled test data windows are repeated to make up the fixed window set
+[[nodiscard]] auto NumRepeats(const usize num_windows) -> usize {
+  const auto min_windows = MIN_WINDOWS_PER_THREAD * MaxThreads();
+  return std::max(usize{1}, (min_windows + num_windows - 1) / num_windows);
+}
+
+// Processes `num_repeats` copies of `windows` with `num_threads` VariantBuilder threads and `num_io_threads`
+// reads collection threads, and returns the wall time of the run. Workers, queues, dispatching and flushing
+// mirror `PipelineRunner::ProcessShard`, without the scheduler and with flushed variants discarded.
+[[nodiscard]] auto RunWindows(const std::vector<lancet::core::WindowPtr>& windows,
+                              const AsyncWorker::BuilderParamsPtr& params, const usize num_repeats,
+                              const usize num_threads, const usize num_io_threads) -> absl::Duration {
+  Timer timer;
+  const auto num_total_windows = windows.size() * num_repeats;
+  const auto num_all_threads = num_threads + num_io_threads;
+  const auto max_windows_in_flight = (2 * num_threads) + num_io_threads;
+  const AsyncWorker::Queues queues{
+      .mInput = std::make_shared<AsyncWorker::InputQueue>(max_windows_in_flight + num_all_threads),
+      .mHandoff = std::make_shared<AsyncWorker::HandoffQueue>(max_windows_in_flight + num_threads),
+      .mOutput = std::make_shared<AsyncWorker::OutputQueue>(max_windows_in_flight + num_all_threads),
+  };
+
+  usize num_dispatched = 0;
+  const moodycamel::ProducerToken producer_token(*queues.mInput);
+  const auto dispatch_windows = [&](const usize max_windows) {
+    const auto last_dispatched = std::min(num_total_windows, num_dispatched + max_windows);
+    for (; num_dispatched < last_dispatched; ++num_dispatched) {
+      queues.mInput->enqueue(producer_token, windows[num_dispatched % windows.size()]);
+    }
+  };
+
+  dispatch_windows(max_windows_in_flight);
+
+  const auto varstore = std::make_shared<lancet::core::VariantStore>();
+  const auto compute_stage = num_io_threads > 0 ? AsyncWorker::Stage::ASSEMBLY : AsyncWorker::Stage::FULL;
+  std::vector<std::jthread> worker_threads;
+  worker_threads.reserve(num_all_threads);
+  for (usize idx = 0; idx < num_all_threads; ++idx) {
+    const auto stage = idx < num_io_threads ? AsyncWorker::Stage::READS : compute_stage;
+    worker_threads.emplace_back([stage, &queues, &varstore, &params](std::stop_token stop_token) {
+      AsyncWorker worker(stage, queues, varstore, params, nullptr);
+      worker.Process(std::move(stop_token));
+    });
+  }
+
+  // Flushed variants are still formatted, but written to a stream without a buffer, which discards them
+  std::ostream discarded_out(nullptr);
+  AsyncWorker::Result result;
+  moodycamel::ConsumerToken result_token(*queues.mOutput);
+  for (usize num_done = 1; num_done <= num_total_windows; ++num_done) {
+    WaitScope result_wait(WaitStats::Kind::RESULT_QUEUE);
+    queues.mOutput->wait_dequeue(result_token, result);
+    result_wait.End();
+    dispatch_windows(1);
+
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (num_done <= FLUSH_LAG_WINDOWS) continue;
+    varstore->FlushVariantsBeforeWindow(*windows[(num_done - FLUSH_LAG_WINDOWS) % windows.size()], discarded_out);
+  }
+
+  const auto num_handoff_workers = compute_stage == AsyncWorker::Stage::ASSEMBLY ? num_threads : 0;
+  for (usize idx = num_handoff_workers; idx < num_all_threads; ++idx) {
+    queues.mInput->enqueue(producer_token, nullptr);
+  }
+  for (usize idx = 0; idx < num_handoff_workers; ++idx) {
+    queues.mHandoff->enqueue(AsyncWorker::CollectedWindow{});
+  }
+  worker_threads.clear();
+
+  varstore->FlushAllVariantsInStore(discarded_out);
+  return timer.Runtime();
+}
+
+// Average wall time of `NUM_BASELINE_RUNS` runs with a single VariantBuilder thread and `num_io_threads` reads
+// collection threads, which is the baseline of speedups. It is measured on first use for each number of I/O
+// threads, so speedups do not depend on which benchmarks are selected to run, or in which order they run.
+[[nodiscard]] auto BaselineRuntime(const std::vector<lancet::core::WindowPtr>& windows,
+                                   const AsyncWorker::BuilderParamsPtr& params, const usize num_repeats,
+                                   const usize num_io_threads) -> absl::Duration {
+  static constexpr i64 NUM_BASELINE_RUNS = 2;
+  static std::map<usize, absl::Duration> baselines;
+  const auto itr = baselines.find(num_io_threads);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (itr != baselines.end()) return itr->second;
+
+  auto total_runtime = absl::ZeroDuration();
+  for (i64 run = 0; run < NUM_BASELINE_RUNS; ++run) {
+    total_runtime += RunWindows(windows, params, num_repeats, 1, num_io_threads);
+  }
+  return baselines.emplace(num_io_threads, total_runtime / NUM_BASELINE_RUNS).first->second;
+}
+
+// Processes a fixed window set of the bundled test data with `range(0)` VariantBuilder threads, and
+// `range(1)` threads collecting reads ahead of them. Reports windows per second, speedup and parallel
+// efficiency over one VariantBuilder thread, the serial fraction estimated from the speedup with the
+// Karp-Flatt metric, and seconds per iteration spent waiting, summed over all threads, for each wait kind.
+void ThreadScaling(benchmark::State& state) {
+  const auto num_threads = static_cast<usize>(state.range(0));
+  const auto num_io_threads = static_cast<usize>(state.range(1));
+  static const auto windows = MakeTestDataWindows();
+  static const auto params = MakeTestDataParams();
+  const auto num_repeats = NumRepeats(windows.size());
+  const auto baseline = BaselineRuntime(windows, params, num_repeats, num_io_threads);
+
+  WaitStats::Enable();
+  WaitStats::Reset();
+  auto total_runtime = absl::ZeroDuration();
+  // NOLINTNEXTLINE(readability-identifier-length)
+  for ([[maybe_unused]] auto _ : state) {
+    const auto runtime = RunWindows(windows, params, num_repeats, num_threads, num_io_threads);
+    state.SetIterationTime(absl::ToDoubleSeconds(runtime));
+    total_runtime += runtime;
+  }
+
+  const auto waits = WaitStats::Current();
+  const auto runtime = total_runtime / state.iterations();
+
+  const auto num_windows = static_cast<f64>(windows.size() * num_repeats * static_cast<usize>(state.iterations()));
+  state.counters["windows"] = static_cast<f64>(windows.size() * num_repeats);
+  state.counters["windows_per_second"] = benchmark::Counter(num_windows, benchmark::Counter::kIsRate);
+  for (usize idx = 0; idx < WaitStats::NUM_KINDS; ++idx) {
+    const auto kind = absl::AsciiStrToLower(WaitStats::ToString(static_cast<WaitStats::Kind>(idx)));
+    const auto wait_secs = absl::ToDoubleSeconds(absl::Nanoseconds(waits.at(idx).mWaitNs));
+    state.counters[kind + "_wait_seconds"] = benchmark::Counter(wait_secs, benchmark::Counter::kAvgIterations);
+  }
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (runtime <= absl::ZeroDuration()) return;
+
+  const auto speedup = absl::FDivDuration(baseline, runtime);
+  const auto procs = static_cast<f64>(num_threads);
+  state.counters["speedup"] = speedup;
+  state.counters["parallel_efficiency"] = speedup / procs;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (num_threads > 1) state.counters["serial_fraction"] = ((1.0 / speedup) - (1.0 / procs)) / (1.0 - (1.0 / procs));
+}
+
+// Doubles the number of VariantBuilder threads from 1 up to the number of cores, which is always included
+void ThreadCounts(benchmark::internal::Benchmark* bench) {
+  const auto max_threads = static_cast<i64>(MaxThreads());
+  for (const i64 num_io_threads : {0, 2}) {
+    for (i64 num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+      bench->Args({num_threads, num_io_threads});
+    }
+    bench->Args({max_threads, num_io_threads});
+  }
+}
+
+}  // namespace
+
+// NOLINTBEGIN
+BENCHMARK(ThreadScaling)
+    ->Unit(benchmark::kMillisecond)
+    ->ArgNames({"threads", "io_threads"})
+    ->Apply(ThreadCounts)
+    ->UseManualTime()
+    ->Iterations(2);
+// NOLINTEND
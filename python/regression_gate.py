@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+
+import argparse
+import collections
+import difflib
+import gzip
+import json
+import logging
+import os
+import re
+import statistics
+import subprocess
+import sys
+import tempfile
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TEST_DATA_DIR = os.path.join(PROJECT_DIR, "tests", "data")
+REGRESSION_DIR = os.path.join(TEST_DATA_DIR, "regression")
+
+# Fixed workload of the gate, i.e. the bundled tumor/normal CRAMs in the region they have reads in
+WORKLOAD = {
+    "reference": os.path.join(TEST_DATA_DIR, "human_g1k_v37.1_1_90000000.fa.gz"),
+    "tumor": os.path.join(TEST_DATA_DIR, "tumor.cram"),
+    "normal": os.path.join(TEST_DATA_DIR, "normal.cram"),
+    "region": "1:82960500-82969500",
+    "num_threads": 2,
+}
+
+# Header lines that change with every run, and are not compared with the golden VCF
+VOLATILE_HEADER_PREFIXES = ("##fileDate=", "##source=", "##commandLine=", "##reference=")
+VCF_COLUMNS = ("CHROM", "POS", "ID", "REF", "ALT", "QUAL", "FILTER", "INFO", "FORMAT")
+MAX_REPORTED_DIFFS = 20
+
+STAGE_SECONDS_REGEX = re.compile(r'^lancet_stage_seconds\{stage="([^"]+)"\} (\S+)$')
+ELAPSED_SECONDS_REGEX = re.compile(r"^lancet_elapsed_seconds (\S+)$")
+
+
+def run_workload(lancet_path, work_dir, run_idx):
+    out_vcf = os.path.join(work_dir, f"run{run_idx}.vcf.gz")
+    metrics_path = os.path.join(work_dir, f"run{run_idx}.prom")
+    cmd = [
+        lancet_path,
+        "pipeline",
+        "--reference", WORKLOAD["reference"],
+        "--tumor", WORKLOAD["tumor"],
+        "--normal", WORKLOAD["normal"],
+        "--region", WORKLOAD["region"],
+        "--num-threads", str(WORKLOAD["num_threads"]),
+        "--out-vcfgz", out_vcf,
+        "--metrics-file", metrics_path,
+    ]
+
+    # Resource usage of the waited for child process only, since RUSAGE_CHILDREN keeps the max over all runs
+    log_path = os.path.join(work_dir, f"run{run_idx}.log")
+    with open(log_path, "w") as log_handle:
+        proc = subprocess.Popen(cmd, stdout=log_handle, stderr=subprocess.STDOUT)
+        _, wait_status, usage = os.wait4(proc.pid, 0)
+
+    return_code = os.waitstatus_to_exitcode(wait_status)
+    if return_code != 0:
+        with open(log_path) as log_handle:
+            logging.error(f"Lancet2 failed with exit code {return_code}:\n{log_handle.read()}")
+        sys.exit(1)
+
+    timings = parse_metrics(metrics_path)
+    # ru_maxrss is in KiB on Linux
+    timings["peak_rss_bytes"] = usage.ru_maxrss * 1024
+    return out_vcf, timings
+
+
+def parse_metrics(metrics_path):
+    stage_seconds = {}
+    elapsed_seconds = None
+    with open(metrics_path) as handle:
+        for line in handle:
+            line = line.strip()
+            stage_match = STAGE_SECONDS_REGEX.match(line)
+            if stage_match:
+                stage_seconds[stage_match.group(1)] = float(stage_match.group(2))
+                continue
+            elapsed_match = ELAPSED_SECONDS_REGEX.match(line)
+            if elapsed_match:
+                elapsed_seconds = float(elapsed_match.group(1))
+
+    return {"elapsed_seconds": elapsed_seconds, "stage_seconds": stage_seconds}
+
+
+def median_timings(all_timings):
+    stages = all_timings[0]["stage_seconds"].keys()
+    return {
+        "elapsed_seconds": statistics.median(t["elapsed_seconds"] for t in all_timings),
+        "stage_seconds": {s: statistics.median(t["stage_seconds"][s] for t in all_timings) for s in stages},
+        "peak_rss_bytes": max(t["peak_rss_bytes"] for t in all_timings),
+    }
+
+
+def read_vcf_lines(vcf_path):
+    # Lancet2 writes BGZF, which is a valid multi member gzip file
+    opener = gzip.open if vcf_path.endswith(".gz") else open
+    with opener(vcf_path, "rt") as handle:
+        lines = [line.rstrip("\n") for line in handle]
+    return [line for line in lines if not line.startswith(VOLATILE_HEADER_PREFIXES)]
+
+
+def record_name(fields):
+    return ":".join(fields[:2] + fields[3:5])
+
+
+def diff_record_fields(golden_fields, output_fields, column_names):
+    diffs = []
+    for idx in range(max(len(golden_fields), len(output_fields))):
+        golden_value = golden_fields[idx] if idx < len(golden_fields) else ""
+        output_value = output_fields[idx] if idx < len(output_fields) else ""
+        if golden_value != output_value:
+            column = column_names[idx] if idx < len(column_names) else f"column {idx + 1}"
+            diffs.append(f"record {record_name(golden_fields)} {column} changed: {golden_value} -> {output_value}")
+    return diffs
+
+
+def diff_vcf_lines(golden_lines, output_lines):
+    """Returns a list of differences between the golden and output VCF lines, empty if they are identical"""
+    diffs = []
+    golden_header = [line for line in golden_lines if line.startswith("#")]
+    output_header = [line for line in output_lines if line.startswith("#")]
+    for line in sorted(set(golden_header) - set(output_header)):
+        diffs.append(f"header line missing from output: {line}")
+    for line in sorted(set(output_header) - set(golden_header)):
+        diffs.append(f"header line not in golden VCF: {line}")
+
+    # Records are compared as ordered lists, so that records sharing CHROM, POS, REF and ALT are all compared
+    golden_records = [line for line in golden_lines if not line.startswith("#")]
+    output_records = [line for line in output_lines if not line.startswith("#")]
+    if collections.Counter(golden_records) == collections.Counter(output_records):
+        if golden_records != output_records:
+            diffs.append("records are identical, but written in a different order")
+        return diffs
+
+    sample_names = golden_header[-1].split("\t")[len(VCF_COLUMNS):] if golden_header else []
+    column_names = list(VCF_COLUMNS) + sample_names
+    matcher = difflib.SequenceMatcher(a=golden_records, b=output_records, autojunk=False)
+    for tag, golden_start, golden_end, output_start, output_end in matcher.get_opcodes():
+        if tag == "equal":
+            continue
+
+        # Changed records at the same place in both lists are diffed by column if they are the same variant
+        golden_block = [line.split("\t") for line in golden_records[golden_start:golden_end]]
+        output_block = [line.split("\t") for line in output_records[output_start:output_end]]
+        for idx in range(max(len(golden_block), len(output_block))):
+            golden_fields = golden_block[idx] if idx < len(golden_block) else None
+            output_fields = output_block[idx] if idx < len(output_block) else None
+            if golden_fields and output_fields and record_name(golden_fields) == record_name(output_fields):
+                diffs.extend(diff_record_fields(golden_fields, output_fields, column_names))
+                continue
+            if golden_fields:
+                diffs.append(f"record missing from output: {record_name(golden_fields)}")
+            if output_fields:
+                diffs.append(f"record not in golden VCF: {record_name(output_fields)}")
+
+    return diffs
+
+
+def within_band(name, baseline, current, rel_tolerance, abs_tolerance):
+    """Checks that `current` is at most `rel_tolerance` and `abs_tolerance` above `baseline`"""
+    limit = baseline * (1.0 + rel_tolerance) + abs_tolerance
+    change = 0.0 if baseline == 0 else 100.0 * (current - baseline) / baseline
+    passed = current <= limit
+    status = "OK" if passed else "REGRESSED"
+    if passed and current < baseline - (baseline * rel_tolerance + abs_tolerance):
+        status = "IMPROVED"
+    logging.info(f"{status:>9} | {name:<32} baseline={baseline:.4f} current={current:.4f} ({change:+.1f}%)")
+    return passed
+
+
+def check_timings(baseline, current, args):
+    passed = within_band("elapsed_seconds", baseline["elapsed_seconds"], current["elapsed_seconds"],
+                         args.time_tolerance, args.min_seconds)
+    for stage, baseline_secs in baseline["stage_seconds"].items():
+        current_secs = current["stage_seconds"].get(stage, 0.0)
+        passed &= within_band(f"stage_seconds[{stage}]", baseline_secs, current_secs, args.time_tolerance,
+                              args.min_seconds)
+
+    mib = 1024.0 * 1024.0
+    passed &= within_band("peak_rss_mib", baseline["peak_rss_bytes"] / mib, current["peak_rss_bytes"] / mib,
+                          args.rss_tolerance, 0.0)
+    return passed
+
+
+def main(args):
+    msg_fmt = "%(asctime)s | %(levelname)s | %(message)s"
+    dt_fmt = "%Y-%m-%d %H:%M:%S"
+    logging.basicConfig(format=msg_fmt, level=logging.INFO, datefmt=dt_fmt)
+
+    if not args.update and not os.path.exists(args.golden_vcf):
+        logging.error(f"Missing {args.golden_vcf}. Create it with --update on the baseline build")
+        sys.exit(1)
+
+    all_timings = []
+    with tempfile.TemporaryDirectory(prefix="lancet_regression_gate_") as work_dir:
+        output_lines = None
+        for run_idx in range(args.runs):
+            logging.info(f"Running workload {run_idx + 1} of {args.runs} with {args.lancet}")
+            out_vcf, timings = run_workload(args.lancet, work_dir, run_idx)
+            all_timings.append(timings)
+            run_lines = read_vcf_lines(out_vcf)
+            # Calls of every run must be the same, otherwise the golden VCF can never be matched reliably
+            if output_lines is not None and run_lines != output_lines:
+                logging.error(f"Output VCF of run {run_idx + 1} differs from run 1, calls are not deterministic")
+                for diff in diff_vcf_lines(output_lines, run_lines)[:MAX_REPORTED_DIFFS]:
+                    logging.error(diff)
+                sys.exit(1)
+            output_lines = run_lines
+
+    current = median_timings(all_timings)
+    if args.update:
+        os.makedirs(os.path.dirname(os.path.abspath(args.golden_vcf)), exist_ok=True)
+        os.makedirs(os.path.dirname(os.path.abspath(args.baseline)), exist_ok=True)
+        with open(args.golden_vcf, "w") as handle:
+            handle.write("\n".join(output_lines) + "\n")
+        with open(args.baseline, "w") as handle:
+            json.dump({"workload": WORKLOAD["region"], "runs": args.runs, **current}, handle, indent=2, sort_keys=True)
+            handle.write("\n")
+        logging.info(f"Updated golden VCF {args.golden_vcf} and timing baseline {args.baseline}")
+        return
+
+    diffs = diff_vcf_lines(read_vcf_lines(args.golden_vcf), output_lines)
+    if diffs:
+        logging.error(f"Output VCF differs from golden VCF {args.golden_vcf} in {len(diffs)} place(s)")
+        for diff in diffs[:MAX_REPORTED_DIFFS]:
+            logging.error(diff)
+        if len(diffs) > MAX_REPORTED_DIFFS:
+            logging.error(f"... and {len(diffs) - MAX_REPORTED_DIFFS} more difference(s)")
+    else:
+        logging.info(f"Output VCF is identical to golden VCF {args.golden_vcf}")
+
+    # Timing baselines are only comparable on the machine they were made on, so they are optional
+    timings_passed = True
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as handle:
+            baseline = json.load(handle)
+        timings_passed = check_timings(baseline, current, args)
+    else:
+        logging.warning(f"Skipping timing checks, no baseline {args.baseline}. Create it with --update on this machine")
+
+    if diffs or not timings_passed:
+        logging.error("Regression gate FAILED")
+        sys.exit(1)
+    logging.info("Regression gate PASSED")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(prog="regression_gate.py",
+                                     description="Check Lancet2 calls and performance against a stored baseline")
+    parser.add_argument("--lancet", required=True, help="Path to the Lancet2 executable to check")
+    parser.add_argument("--golden-vcf", default=os.path.join(REGRESSION_DIR, "golden.vcf"),
+                        help="Expected output VCF, without header lines that change with every run")
+    parser.add_argument("--baseline", default=os.path.join(REGRESSION_DIR, "baseline.json"),
+                        help="Baseline of median stage seconds and peak RSS, only comparable on the same machine")
+    parser.add_argument("--runs", type=int, default=3, help="Number of workload runs to take the median timings of")
+    parser.add_argument("--time-tolerance", type=float, default=0.15,
+                        help="Allowed relative increase of elapsed and stage seconds over the baseline")
+    parser.add_argument("--min-seconds", type=float, default=0.05,
+                        help="Allowed absolute increase of elapsed and stage seconds, so that short stages do not flap")
+    parser.add_argument("--rss-tolerance", type=float, default=0.10,
+                        help="Allowed relative increase of peak RSS over the baseline")
+    parser.add_argument("--update", action="store_true",
+                        help="Write the golden VCF and timing baseline from this build instead of checking them")
+    main(parser.parse_args())
@@ -0,0 +1,150 @@
+#include <malloc.h>
+
+#include <cstddef>
+#include <new>
+
+#include "lancet/base/alloc_tracker.h"
+
+// Global operators are wrapped with `ld --wrap` instead of being replaced, since the statically linked
+// mimalloc already replaces them. Only executables linking `lancet_alloc_hooks` are wrapped. Every
+// replaceable global operator is wrapped, including nothrow and aligned ones, so that each counted free
+// pairs with a counted allocation. Block sizes are used for all operators, since unsized delete has no size.
+
+namespace {
+
+[[nodiscard]] auto TrackAlloc(void* ptr) noexcept -> void* {
+  // Nothrow operators return nullptr instead of throwing when they fail
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (AllocTracker::IsEnabled() && ptr != nullptr) AllocTracker::RecordAlloc(malloc_usable_size(ptr));
+  return ptr;
+}
+
+void TrackFree(void* ptr) noexcept {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (AllocTracker::IsEnabled() && ptr != nullptr) AllocTracker::RecordFree(malloc_usable_size(ptr));
+}
+
+}  // namespace
+
+// NOLINTBEGIN(bugprone-reserved-identifier,cert-dcl37-c,cert-dcl51-cpp,readability-identifier-naming)
+extern "C" {
+
+using std::align_val_t;
+using std::nothrow_t;
+using std::size_t;
+
+auto __real__Znwm(size_t num_bytes) -> void*;
+auto __real__Znam(size_t num_bytes) -> void*;
+auto __real__ZnwmRKSt9nothrow_t(size_t num_bytes, const nothrow_t& tag) noexcept -> void*;
+auto __real__ZnamRKSt9nothrow_t(size_t num_bytes, const nothrow_t& tag) noexcept -> void*;
+auto __real__ZnwmSt11align_val_t(size_t num_bytes, align_val_t align) -> void*;
+auto __real__ZnamSt11align_val_t(size_t num_bytes, align_val_t align) -> void*;
+auto __real__ZnwmSt11align_val_tRKSt9nothrow_t(size_t num_bytes, align_val_t align, const nothrow_t& tag) noexcept
+    -> void*;
+auto __real__ZnamSt11align_val_tRKSt9nothrow_t(size_t num_bytes, align_val_t align, const nothrow_t& tag) noexcept
+    -> void*;
+
+void __real__ZdlPv(void* ptr) noexcept;
+void __real__ZdaPv(void* ptr) noexcept;
+void __real__ZdlPvm(void* ptr, size_t num_bytes) noexcept;
+void __real__ZdaPvm(void* ptr, size_t num_bytes) noexcept;
+void __real__ZdlPvRKSt9nothrow_t(void* ptr, const nothrow_t& tag) noexcept;
+void __real__ZdaPvRKSt9nothrow_t(void* ptr, const nothrow_t& tag) noexcept;
+void __real__ZdlPvSt11align_val_t(void* ptr, align_val_t align) noexcept;
+void __real__ZdaPvSt11align_val_t(void* ptr, align_val_t align) noexcept;
+void __real__ZdlPvmSt11align_val_t(void* ptr, size_t num_bytes, align_val_t align) noexcept;
+void __real__ZdaPvmSt11align_val_t(void* ptr, size_t num_bytes, align_val_t align) noexcept;
+void __real__ZdlPvSt11align_val_tRKSt9nothrow_t(void* ptr, align_val_t align, const nothrow_t& tag) noexcept;
+void __real__ZdaPvSt11align_val_tRKSt9nothrow_t(void* ptr, align_val_t align, const nothrow_t& tag) noexcept;
+
+auto __wrap__Znwm(const size_t num_bytes) -> void* { return TrackAlloc(__real__Znwm(num_bytes)); }
+auto __wrap__Znam(const size_t num_bytes) -> void* { return TrackAlloc(__real__Znam(num_bytes)); }
+
+auto __wrap__ZnwmRKSt9nothrow_t(const size_t num_bytes, const nothrow_t& tag) noexcept -> void* {
+  return TrackAlloc(__real__ZnwmRKSt9nothrow_t(num_bytes, tag));
+}
+
+auto __wrap__ZnamRKSt9nothrow_t(const size_t num_bytes, const nothrow_t& tag) noexcept -> void* {
+  return TrackAlloc(__real__ZnamRKSt9nothrow_t(num_bytes, tag));
+}
+
+auto __wrap__ZnwmSt11align_val_t(const size_t num_bytes, const align_val_t align) -> void* {
+  return TrackAlloc(__real__ZnwmSt11align_val_t(num_bytes, align));
+}
+
+auto __wrap__ZnamSt11align_val_t(const size_t num_bytes, const align_val_t align) -> void* {
+  return TrackAlloc(__real__ZnamSt11align_val_t(num_bytes, align));
+}
+
+auto __wrap__ZnwmSt11align_val_tRKSt9nothrow_t(const size_t num_bytes, const align_val_t align,
+                                               const nothrow_t& tag) noexcept -> void* {
+  return TrackAlloc(__real__ZnwmSt11align_val_tRKSt9nothrow_t(num_bytes, align, tag));
+}
+
+auto __wrap__ZnamSt11align_val_tRKSt9nothrow_t(const size_t num_bytes, const align_val_t align,
+                                               const nothrow_t& tag) noexcept -> void* {
+  return TrackAlloc(__real__ZnamSt11align_val_tRKSt9nothrow_t(num_bytes, align, tag));
+}
+
+void __wrap__ZdlPv(void* ptr) noexcept {
+  TrackFree(ptr);
+  __real__ZdlPv(ptr);
+}
+
+void __wrap__ZdaPv(void* ptr) noexcept {
+  TrackFree(ptr);
+  __real__ZdaPv(ptr);
+}
+
+void __wrap__ZdlPvm(void* ptr, const size_t num_bytes) noexcept {
+  TrackFree(ptr);
+  __real__ZdlPvm(ptr, num_bytes);
+}
+
+void __wrap__ZdaPvm(void* ptr, const size_t num_bytes) noexcept {
+  TrackFree(ptr);
+  __real__ZdaPvm(ptr, num_bytes);
+}
+
+void __wrap__ZdlPvRKSt9nothrow_t(void* ptr, const nothrow_t& tag) noexcept {
+  TrackFree(ptr);
+  __real__ZdlPvRKSt9nothrow_t(ptr, tag);
+}
+
+void __wrap__ZdaPvRKSt9nothrow_t(void* ptr, const nothrow_t& tag) noexcept {
+  TrackFree(ptr);
+  __real__ZdaPvRKSt9nothrow_t(ptr, tag);
+}
+
+void __wrap__ZdlPvSt11align_val_t(void* ptr, const align_val_t align) noexcept {
+  TrackFree(ptr);
+  __real__ZdlPvSt11align_val_t(ptr, align);
+}
+
+void __wrap__ZdaPvSt11align_val_t(void* ptr, const align_val_t align) noexcept {
+  TrackFree(ptr);
+  __real__ZdaPvSt11align_val_t(ptr, align);
+}
+
+void __wrap__ZdlPvmSt11align_val_t(void* ptr, const size_t num_bytes, const align_val_t align) noexcept {
+  TrackFree(ptr);
+  __real__ZdlPvmSt11align_val_t(ptr, num_bytes, align);
+}
+
+void __wrap__ZdaPvmSt11align_val_t(void* ptr, const size_t num_bytes, const align_val_t align) noexcept {
+  TrackFree(ptr);
+  __real__ZdaPvmSt11align_val_t(ptr, num_bytes, align);
+}
+
+void __wrap__ZdlPvSt11align_val_tRKSt9nothrow_t(void* ptr, const align_val_t align, const nothrow_t& tag) noexcept {
+  TrackFree(ptr);
+  __real__ZdlPvSt11align_val_tRKSt9nothrow_t(ptr, align, tag);
+}
+
+void __wrap__ZdaPvSt11align_val_tRKSt9nothrow_t(void* ptr, const align_val_t align, const nothrow_t& tag) noexcept {
+  TrackFree(ptr);
+  __real__ZdaPvSt11align_val_tRKSt9nothrow_t(ptr, align, tag);
+}
+
+}  // extern "C"
+// NOLINTEND(bugprone-reserved-identifier,cert-dcl37-c,cert-dcl51-cpp,readability-identifier-naming)
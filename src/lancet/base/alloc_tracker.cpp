@@ -0,0 +1,133 @@
+#include "lancet/base/alloc_tracker.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+#include "lancet/base/thread_registry.h"
+#include "lancet/base/types.h"
+
+namespace {
+
+using Subsystem = AllocTracker::Subsystem;
+
+struct ThreadState {
+  AllocTracker::Usage mUsage{};
+  std::array<u64, AllocTracker::NUM_SUBSYSTEMS> mRunPeaks{};
+};
+
+// States outlive their threads, so they can be summed after worker threads are joined
+using StateRegistry = ThreadRegistry<ThreadState>;
+
+// Scope state is kept even when tracking is disabled, so that scopes stay balanced if it is enabled later
+thread_local Subsystem tCurrentSubsystem = Subsystem::OTHER;
+thread_local i64 tLiveBytes = 0;
+
+// Null while the registry allocates the state of the calling thread, so registering does not recurse into the
+// tracker, and after the state is retired on thread exit
+[[nodiscard]] auto CurrentThreadState() -> ThreadState* { return StateRegistry::Current(); }
+
+[[nodiscard]] constexpr auto SubsystemIndex(const Subsystem subsystem) -> usize {
+  return static_cast<usize>(subsystem);
+}
+
+}  // namespace
+
+void AllocTracker::Enable() { mIsEnabled.store(true, std::memory_order_relaxed); }
+
+auto AllocTracker::ThreadUsage() -> Usage {
+  const auto* state = CurrentThreadState();
+  return state != nullptr ? state->mUsage : Usage{};
+}
+
+void AllocTracker::ResetThreadPeaks() {
+  auto* state = CurrentThreadState();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (state == nullptr) return;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  for (auto& counts : state->mUsage) counts.mPeakBytes = 0;
+}
+
+auto AllocTracker::TotalUsage() -> Usage {
+  Usage result{};
+  StateRegistry::ForEach([&result](const ThreadState& state) {
+    for (usize idx = 0; idx < NUM_SUBSYSTEMS; ++idx) {
+      result.at(idx).mNumAllocs += state.mUsage.at(idx).mNumAllocs;
+      result.at(idx).mNumBytes += state.mUsage.at(idx).mNumBytes;
+      result.at(idx).mPeakBytes = std::max(result.at(idx).mPeakBytes, state.mRunPeaks.at(idx));
+    }
+  });
+  return result;
+}
+
+auto AllocTracker::Delta(const Usage& before, const Usage& after) -> Usage {
+  Usage result = after;
+  for (usize idx = 0; idx < NUM_SUBSYSTEMS; ++idx) {
+    result.at(idx).mNumAllocs -= before.at(idx).mNumAllocs;
+    result.at(idx).mNumBytes -= before.at(idx).mNumBytes;
+  }
+  return result;
+}
+
+auto AllocTracker::Combine(const Usage& first, const Usage& second) -> Usage {
+  Usage result = first;
+  for (usize idx = 0; idx < NUM_SUBSYSTEMS; ++idx) {
+    result.at(idx).mNumAllocs += second.at(idx).mNumAllocs;
+    result.at(idx).mNumBytes += second.at(idx).mNumBytes;
+    result.at(idx).mPeakBytes = std::max(result.at(idx).mPeakBytes, second.at(idx).mPeakBytes);
+  }
+  return result;
+}
+
+auto AllocTracker::ToString(const Subsystem subsystem) -> std::string {
+  switch (subsystem) {
+    case Subsystem::READ_COLLECTION:
+      return "READ_COLLECTION";
+    case Subsystem::GRAPH:
+      return "GRAPH";
+    case Subsystem::MAX_FLOW:
+      return "MAX_FLOW";
+    case Subsystem::GENOTYPER:
+      return "GENOTYPER";
+    case Subsystem::VARIANT_CALL:
+      return "VARIANT_CALL";
+    case Subsystem::VARIANT_STORE:
+      return "VARIANT_STORE";
+    default:
+      break;
+  }
+
+  return "OTHER";
+}
+
+void AllocTracker::RecordAlloc(const usize num_bytes) noexcept {
+  auto* state = CurrentThreadState();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (state == nullptr) return;
+
+  const auto idx = SubsystemIndex(tCurrentSubsystem);
+  auto& counts = state->mUsage[idx];
+  counts.mNumAllocs++;
+  counts.mNumBytes += num_bytes;
+
+  tLiveBytes += static_cast<i64>(num_bytes);
+  const auto live_bytes = static_cast<u64>(std::max(tLiveBytes, i64{0}));
+  counts.mPeakBytes = std::max(counts.mPeakBytes, live_bytes);
+  state->mRunPeaks[idx] = std::max(state->mRunPeaks[idx], live_bytes);
+}
+
+void AllocTracker::RecordFree(const usize num_bytes) noexcept {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (CurrentThreadState() != nullptr) tLiveBytes -= static_cast<i64>(num_bytes);
+}
+
+AllocScope::AllocScope(const AllocTracker::Subsystem subsystem)
+    : mPrevious(tCurrentSubsystem), mPreviousLiveBytes(tLiveBytes) {
+  tCurrentSubsystem = subsystem;
+  tLiveBytes = 0;
+}
+
+AllocScope::~AllocScope() {
+  tCurrentSubsystem = mPrevious;
+  tLiveBytes = mPreviousLiveBytes;
+}
@@ -0,0 +1,92 @@
+#ifndef SRC_LANCET_BASE_ALLOC_TRACKER_H_
+#define SRC_LANCET_BASE_ALLOC_TRACKER_H_
+
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "lancet/base/thread_usage_span.h"
+#include "lancet/base/types.h"
+
+// Process wide accounting of `operator new` and `operator delete`, enabled with `--alloc-stats`. The linker
+// wraps the global operators (see lancet_alloc_hooks in CMakeLists.txt), and every allocation is attributed to
+// the innermost `AllocScope` active on the allocating thread. Each thread keeps its own counts without locking.
+class AllocTracker {
+ public:
+  enum class Subsystem : u8 {
+    OTHER = 0,
+    READ_COLLECTION = 1,
+    GRAPH = 2,
+    MAX_FLOW = 3,
+    GENOTYPER = 4,
+    VARIANT_CALL = 5,
+    VARIANT_STORE = 6
+  };
+
+  static constexpr usize NUM_SUBSYSTEMS = 7;
+
+  struct Counts {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    u64 mNumAllocs = 0;
+    u64 mNumBytes = 0;
+    // Most bytes held at once by a single activation of the subsystem scope, i.e. bytes it allocated
+    // minus bytes it freed. Memory handed over to and freed by other subsystems is never subtracted.
+    u64 mPeakBytes = 0;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  using Usage = std::array<Counts, NUM_SUBSYSTEMS>;
+
+  // Must be called before any other thread allocates memory that should be counted
+  static void Enable();
+  [[nodiscard]] static auto IsEnabled() noexcept -> bool { return mIsEnabled.load(std::memory_order_relaxed); }
+
+  // Counts of the calling thread since it started, with peaks since the last `ResetThreadPeaks`
+  [[nodiscard]] static auto ThreadUsage() -> Usage;
+  static void ResetThreadPeaks();
+  // Counts summed over all threads, with peaks over all threads. No thread may allocate meanwhile.
+  [[nodiscard]] static auto TotalUsage() -> Usage;
+
+  // Counts of `after` minus `before`, with peaks of `after`
+  [[nodiscard]] static auto Delta(const Usage& before, const Usage& after) -> Usage;
+  // Counts of both summed, with the larger peak of both
+  [[nodiscard]] static auto Combine(const Usage& first, const Usage& second) -> Usage;
+
+  // Counts of the calling thread for `ThreadUsageSpan`, with peaks since the span started
+  [[nodiscard]] static auto SpanStart() -> Usage {
+    ResetThreadPeaks();
+    return ThreadUsage();
+  }
+  [[nodiscard]] static auto SpanElapsed(const Usage& start) -> Usage { return Delta(start, ThreadUsage()); }
+
+  [[nodiscard]] static auto ToString(Subsystem subsystem) -> std::string;
+
+  // Called by the wrapped global operators only
+  static void RecordAlloc(usize num_bytes) noexcept;
+  static void RecordFree(usize num_bytes) noexcept;
+
+ private:
+  static inline std::atomic<bool> mIsEnabled{false};
+};
+
+// Attributes allocations of the calling thread to `subsystem` until the scope ends. Scopes nest, and the
+// previous subsystem is restored when the inner scope ends.
+class AllocScope {
+ public:
+  explicit AllocScope(AllocTracker::Subsystem subsystem);
+  ~AllocScope();
+
+  AllocScope(const AllocScope&) = delete;
+  AllocScope(AllocScope&&) = delete;
+  auto operator=(const AllocScope&) -> AllocScope& = delete;
+  auto operator=(AllocScope&&) -> AllocScope& = delete;
+
+ private:
+  AllocTracker::Subsystem mPrevious;
+  i64 mPreviousLiveBytes;
+};
+
+// Allocations of the calling thread from construction to `Elapsed`, if allocation tracking is enabled
+using AllocSpan = ThreadUsageSpan<AllocTracker>;
+
+#endif  // SRC_LANCET_BASE_ALLOC_TRACKER_H_
@@ -0,0 +1,59 @@
+#ifndef SRC_LANCET_BASE_COMPLETION_TRACKER_H_
+#define SRC_LANCET_BASE_COMPLETION_TRACKER_H_
+
+#include <utility>
+#include <vector>
+
+#include "lancet/base/assert.h"
+#include "lancet/base/types.h"
+
+// Tracks out of order completion of items indexed `[0, NumTotal())`. `Frontier()` is the first index
+// that is not done yet, so every item before it is done. The frontier only ever moves forward, so
+// advancing it costs O(NumTotal()) in total over the lifetime of the tracker.
+class CompletionTracker {
+ public:
+  explicit CompletionTracker(const usize num_items) : mIsDone(num_items, false) {}
+
+  // Marks item at `idx` as done. Returns true only if the done frontier moved forward.
+  auto MarkDone(const usize idx) -> bool {
+    LANCET_ASSERT(idx < mIsDone.size())
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mIsDone[idx]) return false;
+
+    mIsDone[idx] = true;
+    mNumDone++;
+
+    // NOLINTBEGIN(readability-braces-around-statements)
+    if (idx != mFrontier) return false;
+    while (mFrontier < mIsDone.size() && mIsDone[mFrontier]) mFrontier++;
+    // NOLINTEND(readability-braces-around-statements)
+    return true;
+  }
+
+  // Half-open `[first, last)` runs of done items in increasing order
+  [[nodiscard]] auto DoneRanges() const -> std::vector<std::pair<usize, usize>> {
+    std::vector<std::pair<usize, usize>> results;
+    for (usize idx = 0; idx < mIsDone.size(); ++idx) {
+      // NOLINTBEGIN(readability-braces-around-statements)
+      if (!mIsDone[idx]) continue;
+      const auto first = idx;
+      while (idx + 1 < mIsDone.size() && mIsDone[idx + 1]) idx++;
+      // NOLINTEND(readability-braces-around-statements)
+      results.emplace_back(first, idx + 1);
+    }
+    return results;
+  }
+
+  [[nodiscard]] auto IsDone(const usize idx) const -> bool { return mIsDone[idx]; }
+  [[nodiscard]] auto Frontier() const noexcept -> usize { return mFrontier; }
+  [[nodiscard]] auto NumDone() const noexcept -> usize { return mNumDone; }
+  [[nodiscard]] auto NumTotal() const noexcept -> usize { return mIsDone.size(); }
+  [[nodiscard]] auto IsAllDone() const noexcept -> bool { return mNumDone == mIsDone.size(); }
+
+ private:
+  std::vector<bool> mIsDone;
+  usize mFrontier = 0;
+  usize mNumDone = 0;
+};
+
+#endif  // SRC_LANCET_BASE_COMPLETION_TRACKER_H_
@@ -0,0 +1,178 @@
+#include "lancet/base/perf_counters.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lancet/base/thread_registry.h"
+#include "lancet/base/types.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+using Event = PerfCounters::Event;
+
+struct EventSpec {
+  Event mEvent;
+  u32 mType;
+  u64 mConfig;
+};
+
+[[nodiscard]] constexpr auto CacheConfig(const u64 cache, const u64 operation, const u64 result) -> u64 {
+  // NOLINTNEXTLINE(readability-magic-numbers)
+  return cache | (operation << 8) | (result << 16);
+}
+
+// Cycles lead the group. LLC misses use the generic cache miss event, which is the last level cache on x86.
+constexpr std::array<EventSpec, PerfCounters::NUM_EVENTS> EVENT_SPECS = {{
+    {Event::CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {Event::INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {Event::L1D_READ_MISSES, PERF_TYPE_HW_CACHE,
+     CacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {Event::LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {Event::BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+}};
+
+[[nodiscard]] auto OpenEvent(const EventSpec& spec, const int group_fd) -> int {
+  perf_event_attr attr{};
+  attr.size = sizeof(perf_event_attr);
+  attr.type = spec.mType;
+  attr.config = spec.mConfig;
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // Counts only the calling thread, on whichever core it runs
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0UL));
+}
+
+// Counter group of one thread. Events the CPU does not support, e.g. in some VMs, are left out and read as 0.
+class ThreadGroup {
+ public:
+  ThreadGroup() {
+    mLeaderFd = OpenEvent(EVENT_SPECS[0], -1);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mLeaderFd < 0) return;
+
+    mMemberEvents.push_back(EVENT_SPECS[0].mEvent);
+    for (usize idx = 1; idx < EVENT_SPECS.size(); ++idx) {
+      const auto member_fd = OpenEvent(EVENT_SPECS.at(idx), mLeaderFd);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (member_fd < 0) continue;
+      mMemberFds.push_back(member_fd);
+      mMemberEvents.push_back(EVENT_SPECS.at(idx).mEvent);
+    }
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-vararg)
+    ioctl(mLeaderFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(mLeaderFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    // NOLINTEND(cppcoreguidelines-pro-type-vararg)
+  }
+
+  ~ThreadGroup() {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    for (const auto member_fd : mMemberFds) close(member_fd);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mLeaderFd >= 0) close(mLeaderFd);
+  }
+
+  ThreadGroup(const ThreadGroup&) = delete;
+  ThreadGroup(ThreadGroup&&) = delete;
+  auto operator=(const ThreadGroup&) -> ThreadGroup& = delete;
+  auto operator=(ThreadGroup&&) -> ThreadGroup& = delete;
+
+  [[nodiscard]] auto IsOpen() const noexcept -> bool { return mLeaderFd >= 0; }
+
+  [[nodiscard]] auto Read() const -> PerfCounters::Values {
+    PerfCounters::Values result;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!IsOpen()) return result;
+
+    // Group read layout is the number of events, time enabled, time running and then one value per event
+    std::array<u64, 3 + PerfCounters::NUM_EVENTS> buffer{};
+    const auto num_bytes = read(mLeaderFd, buffer.data(), sizeof(buffer));
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (num_bytes <= 0 || buffer[2] == 0) return result;
+
+    // Counters are multiplexed when more groups are active than the PMU has counters for
+    const auto scale = static_cast<f64>(buffer[1]) / static_cast<f64>(buffer[2]);
+    const auto num_values = std::min(static_cast<usize>(buffer[0]), mMemberEvents.size());
+    for (usize idx = 0; idx < num_values; ++idx) {
+      result.Set(mMemberEvents[idx], static_cast<u64>(static_cast<f64>(buffer.at(3 + idx)) * scale));
+    }
+    return result;
+  }
+
+ private:
+  int mLeaderFd = -1;
+  std::vector<int> mMemberFds;
+  std::vector<Event> mMemberEvents;
+};
+
+using SlotTotals = std::array<PerfCounters::Values, PerfCounters::MAX_SLOTS>;
+// Totals outlive their threads, so they can be summed after worker threads are joined
+using TotalsRegistry = ThreadRegistry<SlotTotals>;
+
+// Groups are closed when their thread exits, so that repeated worker pools do not leak file descriptors
+thread_local std::unique_ptr<ThreadGroup> tCurrentGroup = nullptr;
+
+[[nodiscard]] auto CurrentThreadGroup() -> const ThreadGroup& {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (tCurrentGroup == nullptr) tCurrentGroup = std::make_unique<ThreadGroup>();
+  return *tCurrentGroup;
+}
+
+}  // namespace
+
+auto PerfCounters::Values::operator+=(const Values& other) -> Values& {
+  for (usize idx = 0; idx < NUM_EVENTS; ++idx) {
+    mCounts.at(idx) += other.mCounts.at(idx);
+  }
+  return *this;
+}
+
+auto PerfCounters::Values::operator-=(const Values& other) -> Values& {
+  for (usize idx = 0; idx < NUM_EVENTS; ++idx) {
+    auto& count = mCounts.at(idx);
+    count = count > other.mCounts.at(idx) ? count - other.mCounts.at(idx) : 0;
+  }
+  return *this;
+}
+
+auto PerfCounters::Enable() -> std::string {
+  const ThreadGroup probe;
+  if (!probe.IsOpen()) {
+    return fmt::format("perf_event_open failed with {}, check /proc/sys/kernel/perf_event_paranoid",
+                       std::strerror(errno));  // NOLINT(concurrency-mt-unsafe)
+  }
+
+  mIsEnabled.store(true, std::memory_order_relaxed);
+  return {};
+}
+
+auto PerfCounters::Read() -> Values {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!IsEnabled()) return {};
+  return CurrentThreadGroup().Read();
+}
+
+void PerfCounters::Accumulate(const usize slot, const Values& delta) {
+  auto* totals = TotalsRegistry::Current();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (totals != nullptr) totals->at(slot) += delta;
+}
+
+auto PerfCounters::Total(const usize slot) -> Values {
+  Values result;
+  TotalsRegistry::ForEach([&result, &slot](const SlotTotals& totals) { result += totals.at(slot); });
+  return result;
+}
@@ -0,0 +1,63 @@
+#ifndef SRC_LANCET_BASE_PERF_COUNTERS_H_
+#define SRC_LANCET_BASE_PERF_COUNTERS_H_
+
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "lancet/base/thread_usage_span.h"
+#include "lancet/base/types.h"
+
+// Process wide hardware performance counters, enabled with `--perf-counters`. Every thread lazily opens its
+// own perf_event_open group, which counts user space events of only that thread on any core. Counter deltas
+// are accumulated into per thread slots without locking, and summed over all threads once they are done.
+class PerfCounters {
+ public:
+  enum class Event : u8 { CYCLES = 0, INSTRUCTIONS = 1, L1D_READ_MISSES = 2, LLC_MISSES = 3, BRANCH_MISSES = 4 };
+
+  static constexpr usize NUM_EVENTS = 5;
+  static constexpr usize MAX_SLOTS = 16;
+
+  class Values {
+   public:
+    Values() = default;
+
+    [[nodiscard]] auto Get(Event event) const -> u64 { return mCounts.at(static_cast<usize>(event)); }
+    void Set(Event event, u64 count) { mCounts.at(static_cast<usize>(event)) = count; }
+
+    auto operator+=(const Values& other) -> Values&;
+    // Saturates at zero, since multiplexed counters are scaled estimates that are not strictly monotonic
+    auto operator-=(const Values& other) -> Values&;
+
+   private:
+    std::array<u64, NUM_EVENTS> mCounts{};
+  };
+
+  // Opens a counter group on the calling thread to check that counters are available. Returns the reason
+  // they are not available, e.g. perf_event_paranoid settings, or an empty string if enabled.
+  [[nodiscard]] static auto Enable() -> std::string;
+  [[nodiscard]] static auto IsEnabled() noexcept -> bool { return mIsEnabled.load(std::memory_order_relaxed); }
+
+  // Counts of the calling thread since its group was opened. All zeros when disabled or unavailable.
+  [[nodiscard]] static auto Read() -> Values;
+  // Adds `delta` to `slot` of the calling thread
+  static void Accumulate(usize slot, const Values& delta);
+  // Sum of `slot` over all threads. No thread may accumulate meanwhile.
+  [[nodiscard]] static auto Total(usize slot) -> Values;
+
+  // Counts of the calling thread for `ThreadUsageSpan`
+  [[nodiscard]] static auto SpanStart() -> Values { return Read(); }
+  [[nodiscard]] static auto SpanElapsed(const Values& start) -> Values {
+    auto result = Read();
+    result -= start;
+    return result;
+  }
+
+ private:
+  static inline std::atomic<bool> mIsEnabled{false};
+};
+
+// Measures counters of the calling thread from construction to `Elapsed`, if counters are enabled
+using PerfSpan = ThreadUsageSpan<PerfCounters>;
+
+#endif  // SRC_LANCET_BASE_PERF_COUNTERS_H_
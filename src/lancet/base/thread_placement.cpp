@@ -0,0 +1,152 @@
+#include "lancet/base/thread_placement.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "lancet/base/logging.h"
+#include "lancet/base/types.h"
+
+auto ThreadPlacement::ParsePolicy(std::string_view name) -> std::optional<Policy> {
+  // NOLINTBEGIN(readability-braces-around-statements)
+  if (name == "none") return Policy::NONE;
+  if (name == "cores") return Policy::CORES;
+  if (name == "numa") return Policy::NUMA_NODES;
+  // NOLINTEND(readability-braces-around-statements)
+  return std::nullopt;
+}
+
+ThreadPlacement::ThreadPlacement(const Policy policy) : mPolicy(policy) {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mPolicy == Policy::NONE) return;
+
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+    LOG_WARN("Could not get the CPUs allowed for this process. Worker threads will not be pinned")
+    mPolicy = Policy::NONE;
+    return;
+  }
+
+  const auto is_allowed = [&allowed](const int cpu) -> bool { return CPU_ISSET(cpu, &allowed) != 0; };
+  const std::filesystem::path nodes_root = "/sys/devices/system/node";
+
+  // Node directories are enumerated instead of counted up from node0, since node ids can have gaps
+  std::error_code dir_err;
+  for (const auto& entry : std::filesystem::directory_iterator(nodes_root, dir_err)) {
+    const auto file_name = entry.path().filename().string();
+    std::string_view dir_name = file_name;
+    usize node_id = 0;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!absl::ConsumePrefix(&dir_name, "node") || !absl::SimpleAtoi(dir_name, &node_id)) continue;
+
+    std::string cpu_list;
+    std::ifstream cpulist_file(entry.path() / "cpulist");
+    std::getline(cpulist_file, cpu_list);
+
+    auto node_cpus = ParseCpuList(cpu_list);
+    std::erase_if(node_cpus, [&is_allowed](const int cpu) { return !is_allowed(cpu); });
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!node_cpus.empty()) mNodes.emplace_back(Node{.mNodeId = node_id, .mCpus = std::move(node_cpus)});
+  }
+
+  std::ranges::sort(mNodes, {}, &Node::mNodeId);
+
+  // Systems without NUMA support in sysfs are treated as a single node with all allowed CPUs
+  if (mNodes.empty()) {
+    std::vector<int> all_cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (is_allowed(cpu)) all_cpus.push_back(cpu);
+    }
+    mNodes.emplace_back(Node{.mNodeId = 0, .mCpus = std::move(all_cpus)});
+  }
+
+  // Interleave CPUs across nodes, so that consecutive workers spread evenly over all sockets
+  static const auto num_cpus = [](const Node &node) -> usize { return node.mCpus.size(); };
+  const auto max_node_cpus = num_cpus(std::ranges::max(mNodes, {}, num_cpus));
+  for (usize cpu_rank = 0; cpu_rank < max_node_cpus; ++cpu_rank) {
+    for (usize node_idx = 0; node_idx < mNodes.size(); ++node_idx) {
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (cpu_rank >= mNodes[node_idx].mCpus.size()) continue;
+      mCpuOrder.push_back(mNodes[node_idx].mCpus[cpu_rank]);
+      mCpuNode.push_back(node_idx);
+    }
+  }
+
+  for (const auto& node : mNodes) {
+    LOG_INFO("NUMA node {} has {} allowed CPU(s): {}", node.mNodeId, node.mCpus.size(), FormatCpuList(node.mCpus))
+  }
+}
+
+auto ThreadPlacement::PinCurrentThread(const usize worker_idx) const -> bool {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mPolicy == Policy::NONE || mCpuOrder.empty()) return false;
+
+  const auto node_idx = mPolicy == Policy::CORES ? mCpuNode[worker_idx % mCpuOrder.size()] : worker_idx % NumNodes();
+  const auto cpus = mPolicy == Policy::CORES ? std::vector<int>{mCpuOrder[worker_idx % mCpuOrder.size()]}
+                                             : mNodes[node_idx].mCpus;
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  std::ranges::for_each(cpus, [&cpu_set](const int cpu) { CPU_SET(cpu, &cpu_set); });
+
+  const auto tid = absl::Hash<std::thread::id>()(std::this_thread::get_id());
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0) {
+    LOG_WARN("Could not pin worker {} in thread {:#x} to CPU(s) {}", worker_idx, tid, FormatCpuList(cpus))
+    return false;
+  }
+
+  LOG_INFO("Pinned worker {} in thread {:#x} to NUMA node {} on CPU(s) {}", worker_idx, tid, mNodes[node_idx].mNodeId,
+           FormatCpuList(cpus))
+  return true;
+}
+
+auto ThreadPlacement::ParseCpuList(std::string_view cpu_list) -> std::vector<int> {
+  // sysfs cpulist format is a comma separated list of CPUs and inclusive CPU ranges, such as `0-31,64-95`
+  std::vector<int> results;
+  for (const auto item : absl::StrSplit(absl::StripAsciiWhitespace(cpu_list), ',', absl::SkipEmpty())) {
+    const std::vector<std::string_view> bounds = absl::StrSplit(item, '-');
+    int first = 0;
+    int last = 0;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!absl::SimpleAtoi(bounds.front(), &first) || !absl::SimpleAtoi(bounds.back(), &last)) continue;
+    for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+      results.push_back(cpu);
+    }
+  }
+
+  return results;
+}
+
+auto ThreadPlacement::FormatCpuList(const std::vector<int>& cpus) -> std::string {
+  // Collapse consecutive CPUs back into ranges, so that logs of whole nodes stay readable
+  std::vector<std::string> ranges;
+  for (usize idx = 0; idx < cpus.size();) {
+    auto last = idx;
+    while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) {
+      last++;
+    }
+
+    ranges.emplace_back(idx == last ? std::to_string(cpus[idx])
+                                    : std::to_string(cpus[idx]) + "-" + std::to_string(cpus[last]));
+    idx = last + 1;
+  }
+
+  return absl::StrJoin(ranges, ",");
+}
@@ -0,0 +1,51 @@
+#ifndef SRC_LANCET_BASE_THREAD_PLACEMENT_H_
+#define SRC_LANCET_BASE_THREAD_PLACEMENT_H_
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lancet/base/types.h"
+
+// Optional pinning of worker threads to CPUs using the NUMA topology from sysfs. State that a pinned
+// worker allocates itself after pinning is placed on the memory of its own NUMA node by the default
+// first-touch policy, so it is never accessed across sockets while the worker runs.
+class ThreadPlacement {
+ public:
+  enum class Policy : u8 {
+    NONE = 0,        // Threads float freely across all CPUs
+    CORES = 1,       // Each worker is pinned to one CPU, spreading workers round-robin across NUMA nodes
+    NUMA_NODES = 2,  // Each worker is pinned to all CPUs of one NUMA node, round-robin across nodes
+  };
+
+  [[nodiscard]] static auto ParsePolicy(std::string_view name) -> std::optional<Policy>;
+
+  // Only CPUs the process is allowed to run on are used, so that `taskset` and cgroup limits are respected
+  explicit ThreadPlacement(Policy policy);
+
+  [[nodiscard]] auto NumNodes() const noexcept -> usize { return mNodes.size(); }
+  [[nodiscard]] auto NumCpus() const noexcept -> usize { return mCpuOrder.size(); }
+
+  // Pins the calling thread to the CPUs of worker `worker_idx` and logs the chosen NUMA node.
+  // Returns false if the policy is NONE or pinning failed, in which case the thread keeps floating.
+  auto PinCurrentThread(usize worker_idx) const -> bool;
+
+ private:
+  // Allowed CPUs of one NUMA node, with the node id from sysfs, since node ids can be sparse
+  struct Node {
+    usize mNodeId = 0;
+    std::vector<int> mCpus;
+  };
+
+  Policy mPolicy;
+  // NUMA nodes with at least one allowed CPU in node id order, and all allowed CPUs interleaved across them
+  std::vector<Node> mNodes;
+  std::vector<int> mCpuOrder;
+  std::vector<usize> mCpuNode;
+
+  [[nodiscard]] static auto ParseCpuList(std::string_view cpu_list) -> std::vector<int>;
+  [[nodiscard]] static auto FormatCpuList(const std::vector<int>& cpus) -> std::string;
+};
+
+#endif  // SRC_LANCET_BASE_THREAD_PLACEMENT_H_
@@ -0,0 +1,89 @@
+#ifndef SRC_LANCET_BASE_THREAD_REGISTRY_H_
+#define SRC_LANCET_BASE_THREAD_REGISTRY_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+// Process wide registry of one `State` per thread, for recorders that update their state without locking.
+// States outlive their threads, so they can be summed or written out after worker threads are joined. A
+// thread retires its state when it exits, and the next new thread takes over a retired state along with
+// everything recorded in it, so repeated worker pools reuse states instead of adding new ones.
+template <typename State>
+class ThreadRegistry {
+ public:
+  // State of the calling thread, registered on first use. Returns nullptr while the state of the calling
+  // thread is being registered, e.g. to a wrapped `operator new`, and after the thread retired its state.
+  [[nodiscard]] static auto Current() -> State* {
+    auto& holder = tHolder;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (holder.mState != nullptr || holder.mIsRegistering || holder.mIsRetired) return holder.mState;
+
+    holder.mIsRegistering = true;
+    holder.mState = Global().Acquire();
+    holder.mIsRegistering = false;
+    return holder.mState;
+  }
+
+  // Calls `visit` with every state ever registered, in registration order. No thread may update its state
+  // meanwhile, i.e. threads recording into the states must have been joined or be otherwise quiescent.
+  template <typename Visit>
+  static void ForEach(Visit&& visit) {
+    auto& registry = Global();
+    const absl::MutexLock lock(&registry.mMutex);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    for (const auto& state : registry.mStates) visit(std::as_const(*state));
+  }
+
+ private:
+  absl::Mutex mMutex;
+  std::vector<std::unique_ptr<State>> mStates ABSL_GUARDED_BY(mMutex);
+  std::vector<State*> mRetired ABSL_GUARDED_BY(mMutex);
+
+  [[nodiscard]] static auto Global() -> ThreadRegistry& {
+    static ThreadRegistry registry;
+    return registry;
+  }
+
+  [[nodiscard]] auto Acquire() -> State* {
+    const absl::MutexLock lock(&mMutex);
+    if (!mRetired.empty()) {
+      auto* state = mRetired.back();
+      mRetired.pop_back();
+      return state;
+    }
+    return mStates.emplace_back(std::make_unique<State>()).get();
+  }
+
+  void Retire(State* state) {
+    const absl::MutexLock lock(&mMutex);
+    mRetired.push_back(state);
+  }
+
+  struct Holder {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    State* mState = nullptr;
+    bool mIsRegistering = false;
+    bool mIsRetired = false;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+
+    Holder() = default;
+    ~Holder() {
+      mIsRetired = true;
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (mState != nullptr) Global().Retire(std::exchange(mState, nullptr));
+    }
+
+    Holder(const Holder&) = delete;
+    Holder(Holder&&) = delete;
+    auto operator=(const Holder&) -> Holder& = delete;
+    auto operator=(Holder&&) -> Holder& = delete;
+  };
+
+  static inline thread_local Holder tHolder;
+};
+
+#endif  // SRC_LANCET_BASE_THREAD_REGISTRY_H_
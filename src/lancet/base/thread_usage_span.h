@@ -0,0 +1,28 @@
+#ifndef SRC_LANCET_BASE_THREAD_USAGE_SPAN_H_
+#define SRC_LANCET_BASE_THREAD_USAGE_SPAN_H_
+
+// Usage of the calling thread from construction or `Restart` to `Elapsed`, read from `Source` only while it is
+// enabled. `Source` provides `IsEnabled()`, `SpanStart()` and `SpanElapsed(start)` for its type of usage.
+template <typename Source>
+class ThreadUsageSpan {
+ public:
+  using Usage = decltype(Source::SpanStart());
+
+  ThreadUsageSpan() { Restart(); }
+
+  void Restart() {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (Source::IsEnabled()) mStart = Source::SpanStart();
+  }
+
+  [[nodiscard]] auto Elapsed() const -> Usage {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!Source::IsEnabled()) return {};
+    return Source::SpanElapsed(mStart);
+  }
+
+ private:
+  Usage mStart{};
+};
+
+#endif  // SRC_LANCET_BASE_THREAD_USAGE_SPAN_H_
@@ -1,10 +1,13 @@
 #ifndef SRC_LANCET_BASE_TIMER_H_
 #define SRC_LANCET_BASE_TIMER_H_
 
+#include <chrono>
 #include <string>
+#include <utility>
 
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "lancet/base/types.h"
 
 class Timer {
  public:
@@ -19,4 +22,37 @@ class Timer {
   absl::Time mStartTime;
 };
 
+// Nanoseconds on the steady clock. Shared by all recorders, so that their timestamps can be compared.
+[[nodiscard]] inline auto MonotonicNowNs() noexcept -> i64 {
+  const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
+}
+
+// Span from construction to `End` or destruction, passed to `record` as start and end nanoseconds. Spans
+// constructed while their recorder is disabled never read the clock, and never call `record`.
+template <typename Record>
+class MonotonicSpan {
+ public:
+  MonotonicSpan(const bool is_enabled, Record record)
+      : mRecord(std::move(record)), mStartNs(is_enabled ? MonotonicNowNs() : -1) {}
+
+  ~MonotonicSpan() { End(); }
+
+  MonotonicSpan(const MonotonicSpan&) = delete;
+  MonotonicSpan(MonotonicSpan&&) = delete;
+  auto operator=(const MonotonicSpan&) -> MonotonicSpan& = delete;
+  auto operator=(MonotonicSpan&&) -> MonotonicSpan& = delete;
+
+  void End() {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mStartNs < 0) return;
+    mRecord(mStartNs, MonotonicNowNs());
+    mStartNs = -1;
+  }
+
+ private:
+  Record mRecord;
+  i64 mStartNs;
+};
+
 #endif  // SRC_LANCET_BASE_TIMER_H_
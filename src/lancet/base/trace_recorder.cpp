@@ -0,0 +1,116 @@
+#include "lancet/base/trace_recorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lancet/base/thread_registry.h"
+#include "lancet/base/timer.h"
+#include "lancet/base/types.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+struct ThreadBuffer {
+  std::string mThreadName;
+  usize mNumRecorded = 0;
+  std::vector<TraceRecorder::Event> mEvents = std::vector<TraceRecorder::Event>(TraceRecorder::EVENTS_PER_THREAD);
+};
+
+// Buffers of exited threads are taken over by new threads, so repeated worker pools, e.g. one per work ledger
+// block, keep as many buffers as threads ever ran at once. Events of the exited thread are kept in the buffer.
+using BufferRegistry = ThreadRegistry<ThreadBuffer>;
+
+[[nodiscard]] auto GlobalOriginNs() -> std::atomic<i64>& {
+  static std::atomic<i64> origin_ns = 0;
+  return origin_ns;
+}
+
+// Event names are literals and details are window regions, so only quotes and backslashes need escaping
+[[nodiscard]] auto EscapeJson(std::string_view text) -> std::string {
+  std::string result;
+  result.reserve(text.length());
+  for (const auto base : text) {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (base == '"' || base == '\\') result.push_back('\\');
+    result.push_back(base);
+  }
+  return result;
+}
+
+}  // namespace
+
+void TraceRecorder::Enable() {
+  GlobalOriginNs().store(MonotonicNowNs(), std::memory_order_relaxed);
+  mIsEnabled.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::SetThreadName(std::string_view name) {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!IsEnabled()) return;
+  auto* buffer = BufferRegistry::Current();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (buffer != nullptr) buffer->mThreadName = name;
+}
+
+void TraceRecorder::Record(const char* name, const i64 start_ns, const i64 end_ns, std::string_view detail) {
+  auto* buffer = BufferRegistry::Current();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (buffer == nullptr) return;
+  auto& event = buffer->mEvents[buffer->mNumRecorded % EVENTS_PER_THREAD];
+  buffer->mNumRecorded++;
+
+  event.mName = name;
+  event.mStartNs = start_ns;
+  event.mDurationNs = end_ns - start_ns;
+  const auto detail_len = std::min(detail.length(), MAX_DETAIL_LENGTH);
+  std::copy_n(detail.begin(), detail_len, event.mDetail.begin());
+  event.mDetail.at(detail_len) = '\0';
+}
+
+auto TraceRecorder::WriteJson(const std::filesystem::path& path) -> bool {
+  std::ofstream out_handle(path, std::ios::trunc);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!out_handle.is_open()) return false;
+
+  const auto origin_ns = GlobalOriginNs().load(std::memory_order_relaxed);
+  static constexpr f64 NANOS_PER_MICRO = 1000.0;
+  const auto to_micros = [&origin_ns](const i64 nanos) -> f64 {
+    return static_cast<f64>(nanos - origin_ns) / NANOS_PER_MICRO;
+  };
+
+  out_handle << R"({"displayTimeUnit":"ms","traceEvents":[)";
+  bool is_first_event = true;
+  const auto write_event = [&out_handle, &is_first_event](const std::string& json) {
+    out_handle << (is_first_event ? "\n" : ",\n") << json;
+    is_first_event = false;
+  };
+
+  usize tid = 0;
+  BufferRegistry::ForEach([&](const ThreadBuffer& buffer) {
+    // Threads that never set a name are shown with their index
+    const auto thread_name = buffer.mThreadName.empty() ? fmt::format("thread {}", tid) : buffer.mThreadName;
+    write_event(fmt::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", tid,
+                            EscapeJson(thread_name)));
+
+    // Ring buffers keep only the most recent events of each thread
+    const auto num_kept = std::min(buffer.mNumRecorded, EVENTS_PER_THREAD);
+    for (auto idx = buffer.mNumRecorded - num_kept; idx < buffer.mNumRecorded; ++idx) {
+      const auto& event = buffer.mEvents[idx % EVENTS_PER_THREAD];
+      const std::string_view detail(event.mDetail.data());
+      const auto args =
+          detail.empty() ? std::string() : fmt::format(R"(,"args":{{"detail":"{}"}})", EscapeJson(detail));
+      write_event(fmt::format(R"({{"name":"{}","cat":"lancet","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}{}}})",
+                              event.mName, tid, to_micros(event.mStartNs),
+                              static_cast<f64>(event.mDurationNs) / NANOS_PER_MICRO, args));
+    }
+    tid++;
+  });
+
+  out_handle << "\n]}\n";
+  return out_handle.good();
+}
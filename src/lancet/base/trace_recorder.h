@@ -0,0 +1,64 @@
+#ifndef SRC_LANCET_BASE_TRACE_RECORDER_H_
+#define SRC_LANCET_BASE_TRACE_RECORDER_H_
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <string_view>
+
+#include "lancet/base/timer.h"
+#include "lancet/base/types.h"
+
+// Process wide recorder of Chrome trace events, enabled with `--trace-file`. Every thread records its
+// events into its own fixed size ring buffer without locking and keeps only its most recent events, so
+// recording never allocates after the first event of a thread. Buffers of exited threads are reused by
+// new threads, so they are shown as one thread in the trace. Disabled recording is one relaxed load.
+class TraceRecorder {
+ public:
+  static constexpr usize EVENTS_PER_THREAD = 32768;
+  static constexpr usize MAX_DETAIL_LENGTH = 39;
+
+  struct Event {
+    // Names are string literals, so events only store the pointer
+    const char* mName = nullptr;
+    i64 mStartNs = 0;
+    i64 mDurationNs = 0;
+    std::array<char, MAX_DETAIL_LENGTH + 1> mDetail{};
+  };
+
+  // Must be called before any other thread records events
+  static void Enable();
+  [[nodiscard]] static auto IsEnabled() noexcept -> bool { return mIsEnabled.load(std::memory_order_relaxed); }
+
+  // Names the calling thread in the trace. Threads without a name are shown with their index.
+  static void SetThreadName(std::string_view name);
+  // Timestamps are `MonotonicNowNs` values. Details longer than `MAX_DETAIL_LENGTH` are truncated.
+  static void Record(const char* name, i64 start_ns, i64 end_ns, std::string_view detail = {});
+
+  // Records the span of a `TraceScope`
+  struct ScopeEvent {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    const char* mName;
+    std::string_view mDetail;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+
+    void operator()(const i64 start_ns, const i64 end_ns) const { Record(mName, start_ns, end_ns, mDetail); }
+  };
+
+  // Writes the recorded events of all threads as trace-event JSON, which opens in Perfetto and
+  // chrome://tracing. No thread other than the calling thread may record events meanwhile.
+  static auto WriteJson(const std::filesystem::path& path) -> bool;
+
+ private:
+  static inline std::atomic<bool> mIsEnabled{false};
+};
+
+// Records one trace event spanning from construction to `End` or destruction, if tracing is enabled.
+// `detail` must outlive the scope, and is shown as the event argument in the trace viewer.
+class TraceScope : public MonotonicSpan<TraceRecorder::ScopeEvent> {
+ public:
+  explicit TraceScope(const char* name, std::string_view detail = {})
+      : MonotonicSpan(TraceRecorder::IsEnabled(), {.mName = name, .mDetail = detail}) {}
+};
+
+#endif  // SRC_LANCET_BASE_TRACE_RECORDER_H_
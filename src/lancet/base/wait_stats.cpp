@@ -0,0 +1,65 @@
+#include "lancet/base/wait_stats.h"
+
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "lancet/base/types.h"
+
+namespace {
+
+struct AtomicTotals {
+  std::atomic<u64> mNumWaits{0};
+  std::atomic<u64> mWaitNs{0};
+};
+
+[[nodiscard]] auto GlobalTotals() -> std::array<AtomicTotals, WaitStats::NUM_KINDS>& {
+  static std::array<AtomicTotals, WaitStats::NUM_KINDS> totals;
+  return totals;
+}
+
+}  // namespace
+
+void WaitStats::Enable() { mIsEnabled.store(true, std::memory_order_relaxed); }
+
+auto WaitStats::Current() -> Snapshot {
+  Snapshot result{};
+  const auto& totals = GlobalTotals();
+  for (usize idx = 0; idx < NUM_KINDS; ++idx) {
+    result.at(idx).mNumWaits = totals.at(idx).mNumWaits.load(std::memory_order_relaxed);
+    result.at(idx).mWaitNs = totals.at(idx).mWaitNs.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+void WaitStats::Reset() {
+  for (auto& totals : GlobalTotals()) {
+    totals.mNumWaits.store(0, std::memory_order_relaxed);
+    totals.mWaitNs.store(0, std::memory_order_relaxed);
+  }
+}
+
+auto WaitStats::ToString(const Kind kind) -> std::string {
+  switch (kind) {
+    case Kind::STORE_LOCK:
+      return "STORE_LOCK";
+    case Kind::INPUT_QUEUE:
+      return "INPUT_QUEUE";
+    case Kind::HANDOFF_QUEUE:
+      return "HANDOFF_QUEUE";
+    case Kind::RESULT_QUEUE:
+      return "RESULT_QUEUE";
+    case Kind::FLUSH:
+      return "FLUSH";
+    default:
+      break;
+  }
+
+  return "UNKNOWN";
+}
+
+void WaitStats::Record(const Kind kind, const i64 start_ns, const i64 end_ns) noexcept {
+  auto& totals = GlobalTotals()[static_cast<usize>(kind)];
+  totals.mNumWaits.fetch_add(1, std::memory_order_relaxed);
+  totals.mWaitNs.fetch_add(static_cast<u64>(end_ns - start_ns), std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+#ifndef SRC_LANCET_BASE_WAIT_STATS_H_
+#define SRC_LANCET_BASE_WAIT_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "lancet/base/timer.h"
+#include "lancet/base/types.h"
+
+// Process wide totals of time threads spend waiting on each other instead of working, i.e. the serial
+// fraction of a run. Totals are relaxed atomic counters, so recording a wait never blocks. Disabled
+// recording is one relaxed load, without reading the clock.
+class WaitStats {
+ public:
+  enum class Kind : u8 {
+    // Acquiring the `VariantStore` mutex, held by other workers adding variants or by the flushing thread
+    STORE_LOCK = 0,
+    // Workers parked on the input queue, i.e. starved of windows by the dispatching thread
+    INPUT_QUEUE = 1,
+    // Assembly workers parked on the hand-off queue, i.e. starved of windows by the reads workers
+    HANDOFF_QUEUE = 2,
+    // Dispatching thread parked on the output queue, waiting for the next done window
+    RESULT_QUEUE = 3,
+    // Dispatching thread writing out flushed variants while holding the `VariantStore` mutex
+    FLUSH = 4
+  };
+
+  static constexpr usize NUM_KINDS = 5;
+
+  struct Totals {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    u64 mNumWaits = 0;
+    u64 mWaitNs = 0;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  using Snapshot = std::array<Totals, NUM_KINDS>;
+
+  static void Enable();
+  [[nodiscard]] static auto IsEnabled() noexcept -> bool { return mIsEnabled.load(std::memory_order_relaxed); }
+
+  // Totals since the last `Reset`. Waits still in progress are not included.
+  [[nodiscard]] static auto Current() -> Snapshot;
+  static void Reset();
+
+  [[nodiscard]] static auto ToString(Kind kind) -> std::string;
+
+  // Timestamps are `MonotonicNowNs` values
+  static void Record(Kind kind, i64 start_ns, i64 end_ns) noexcept;
+
+  // Records the span of a `WaitScope`
+  struct ScopeWait {
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    Kind mKind;
+
+    void operator()(const i64 start_ns, const i64 end_ns) const noexcept { Record(mKind, start_ns, end_ns); }
+  };
+
+ private:
+  static inline std::atomic<bool> mIsEnabled{false};
+};
+
+// Records one wait of `kind` spanning from construction to `End` or destruction, if wait stats are enabled
+class WaitScope : public MonotonicSpan<WaitStats::ScopeWait> {
+ public:
+  explicit WaitScope(const WaitStats::Kind kind) : MonotonicSpan(WaitStats::IsEnabled(), {.mKind = kind}) {}
+};
+
+#endif  // SRC_LANCET_BASE_WAIT_STATS_H_
@@ -16,9 +16,11 @@ extern "C" {
 }
 
 #include "absl/strings/numbers.h"
+#include "lancet/base/alloc_tracker.h"
 #include "lancet/base/assert.h"
 #include "lancet/base/compute_stats.h"
 #include "lancet/base/hash.h"
+#include "lancet/base/timer.h"
 #include "lancet/base/types.h"
 #include "lancet/caller/variant_set.h"
 #include "lancet/caller/variant_support.h"
@@ -53,7 +55,11 @@ Genotyper::Genotyper(const Preset preset) {
 }
 
 auto Genotyper::Genotype(Haplotypes haplotypes, Reads reads, const VariantSet& vset) -> Result {
+  const AllocScope alloc_scope(AllocTracker::Subsystem::GENOTYPER);
+  mPhaseTimings = PhaseTimings{};
+  Timer index_timer;
   ResetData(haplotypes);
+  AddPhaseRuntime(&PhaseTimings::mIndexBuild, index_timer);
 
   Result genotyped_variants;
   static constexpr usize DEFAULT_EXPECTED_SAMPLES_COUNT = 2;
@@ -81,10 +87,12 @@ auto Genotyper::Genotype(Haplotypes haplotypes, Reads reads, const VariantSet& v
 
     read_supports.clear();
     auto alns_to_all_haps = AlignRead(read);
+    Timer support_timer;
     std::ranges::sort(alns_to_all_haps, by_descending_identity_and_score);
     std::ranges::for_each(alns_to_all_haps, [&read_supports, &vset](const AlnInfo& item) {
       item.AddSupportingInfo(read_supports, vset);
     });
+    AddPhaseRuntime(&PhaseTimings::mSupportingInfo, support_timer);
 
     AddToTable(genotyped_variants, read, read_supports);
   }
@@ -409,7 +417,9 @@ auto Genotyper::AlignRead(const cbdg::Read& read) -> std::vector<AlnInfo> {
     AlnInfo aln_info;
 
     const auto* hap_mm_idx = mIndices[idx].get();
+    Timer map_timer;
     auto* regs = mm_map(hap_mm_idx, read_len, read.SeqPtr(), &nregs, tbuffer, map_opts, read.QnamePtr());
+    AddPhaseRuntime(&PhaseTimings::mMapping, map_timer);
     if (regs == nullptr || nregs <= 0) {
       FreeMinimap2Alignment(regs, nregs);
       continue;
@@ -428,11 +438,13 @@ auto Genotyper::AlignRead(const cbdg::Read& read) -> std::vector<AlnInfo> {
 
     int max_len = 0;
     char* cs_result_ptr = nullptr;
+    Timer cs_timer;
     const auto len_cs = mm_gen_cs(tbuffer->km, &cs_result_ptr, &max_len, hap_mm_idx, top_hit, read.SeqPtr(), 1);
     if (len_cs > 0 && cs_result_ptr != nullptr) {
       aln_info.mCsTag = std::string_view(cs_result_ptr, static_cast<usize>(len_cs));
       std::free(cs_result_ptr);  // NOLINT(cppcoreguidelines-owning-memory,cppcoreguidelines-no-malloc)
     }
+    AddPhaseRuntime(&PhaseTimings::mCsGeneration, cs_timer);
 
     results.emplace_back(std::move(aln_info));
     FreeMinimap2Alignment(regs, nregs);
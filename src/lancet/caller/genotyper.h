@@ -14,7 +14,9 @@ extern "C" {
 }
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "lancet/base/timer.h"
 #include "lancet/base/types.h"
 #include "lancet/caller/raw_variant.h"
 #include "lancet/caller/variant_set.h"
@@ -38,6 +40,20 @@ class Genotyper {
   using Result = absl::flat_hash_map<const RawVariant*, PerSampleVariantEvidence>;
   [[nodiscard]] auto Genotype(Haplotypes haplotypes, Reads reads, const VariantSet& vset) -> Result;
 
+  // Time spent in each phase of the last `Genotype` call. Only measured after `EnablePhaseTimings`, since
+  // timing every read alignment is only useful for benchmarks.
+  struct PhaseTimings {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    absl::Duration mIndexBuild = absl::ZeroDuration();
+    absl::Duration mMapping = absl::ZeroDuration();
+    absl::Duration mCsGeneration = absl::ZeroDuration();
+    absl::Duration mSupportingInfo = absl::ZeroDuration();
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  void EnablePhaseTimings() { mMeasurePhases = true; }
+  [[nodiscard]] auto LastPhaseTimings() const noexcept -> const PhaseTimings& { return mPhaseTimings; }
+
   class AlnInfo {
    public:
     // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
@@ -97,6 +113,8 @@ class Genotyper {
 
   usize mNumSamples = 0;
   bool mIsGermlineMode = false;
+  bool mMeasurePhases = false;
+  PhaseTimings mPhaseTimings;
   std::vector<Minimap2Index> mIndices;
   MappingOpts mMappingOpts = std::make_unique<mm_mapopt_t>();
   IndexingOpts mIndexingOpts = std::make_unique<mm_idxopt_t>();
@@ -104,6 +122,12 @@ class Genotyper {
 
   void ResetData(Haplotypes seq);
 
+  // Adds the runtime of `timer` to the total of `phase`, if phases are measured
+  void AddPhaseRuntime(absl::Duration PhaseTimings::* phase, Timer& timer) {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mMeasurePhases) mPhaseTimings.*phase += timer.Runtime();
+  }
+
   [[nodiscard]] auto AlignRead(const cbdg::Read& read) -> std::vector<AlnInfo>;
 
   using SupportsInfo = AlnInfo::SupportsInfo;
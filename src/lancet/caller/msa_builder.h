@@ -20,6 +20,7 @@ class MsaBuilder {
   explicit MsaBuilder(RefAndAltHaplotypes sequences, const FsPath& out_gfa_path = FsPath());
 
   [[nodiscard]] auto MultipleSequenceAlignment() const -> std::vector<std::string_view>;
+  [[nodiscard]] auto MsaWidth() const noexcept -> usize { return mResultMsa.empty() ? 0 : mResultMsa[0].length(); }
   [[nodiscard]] auto FetchHaplotypeSeqView(const usize idx) const -> std::string_view { return mHaplotypeSeqs.at(idx); }
 
  private:
@@ -7,8 +7,13 @@
 #include <memory>
 #include <string_view>
 #include <utility>
+#include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "lancet/base/compute_stats.h"
 #include "lancet/base/hash.h"
 #include "lancet/base/types.h"
@@ -160,6 +165,47 @@ auto VariantCall::AsVcfRecord() const -> std::string {
                      fmt::arg("FORMAT", absl::StrJoin(mFormatFields, "\t")));
 }
 
+auto VariantCall::Serialize() const -> std::string {
+  const auto state = static_cast<i8>(mState);
+  const auto category = static_cast<i8>(mCategory);
+  return fmt::format("{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}", mVariantId, mChromIndex, mStartPos1,
+                     mTotalSampleCov, mChromName, mRefAllele, mAltAllele, mVariantLength, mSiteQuality, state, category,
+                     mInfoField, absl::StrJoin(mFormatFields, "\t"));
+}
+
+auto VariantCall::Deserialize(std::string_view line) -> absl::StatusOr<std::unique_ptr<VariantCall>> {
+  static constexpr usize NUM_FIXED_FIELDS = 12;
+  const std::vector<std::string_view> tokens = absl::StrSplit(line, '\t');
+  if (tokens.size() < NUM_FIXED_FIELDS) {
+    const auto msg = fmt::format("Expected at least {} fields in serialized variant, found {}", NUM_FIXED_FIELDS,
+                                 tokens.size());
+    return absl::Status(absl::StatusCode::kInvalidArgument, msg);
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+  auto result = std::unique_ptr<VariantCall>(new VariantCall());
+  i32 state = 0;
+  i32 category = 0;
+  const auto parsed_numbers =
+      absl::SimpleAtoi(tokens[0], &result->mVariantId) && absl::SimpleAtoi(tokens[1], &result->mChromIndex) &&
+      absl::SimpleAtoi(tokens[2], &result->mStartPos1) && absl::SimpleAtoi(tokens[3], &result->mTotalSampleCov) &&
+      absl::SimpleAtoi(tokens[7], &result->mVariantLength) && absl::SimpleAtod(tokens[8], &result->mSiteQuality) &&
+      absl::SimpleAtoi(tokens[9], &state) && absl::SimpleAtoi(tokens[10], &category);
+
+  if (!parsed_numbers) {
+    return absl::Status(absl::StatusCode::kInvalidArgument, fmt::format("Invalid serialized variant: {}", line));
+  }
+
+  result->mChromName = tokens[4];
+  result->mRefAllele = tokens[5];
+  result->mAltAllele = tokens[6];
+  result->mState = static_cast<RawVariant::State>(state);
+  result->mCategory = static_cast<RawVariant::Type>(category);
+  result->mInfoField = tokens[11];
+  result->mFormatFields.assign(tokens.cbegin() + NUM_FIXED_FIELDS, tokens.cend());
+  return result;
+}
+
 auto VariantCall::SomaticFisherScore(const core::SampleInfo &curr, const PerSampleEvidence &supports) -> f64 {
   // NOLINTNEXTLINE(readability-braces-around-statements)
   if (curr.TagKind() != cbdg::Label::TUMOR) return 0;
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "lancet/base/types.h"
 #include "lancet/caller/raw_variant.h"
@@ -40,6 +41,10 @@ class VariantCall {
 
   [[nodiscard]] auto AsVcfRecord() const -> std::string;
 
+  // Lossless single line encoding of the call, used to persist calls not yet written to the output VCF
+  [[nodiscard]] auto Serialize() const -> std::string;
+  [[nodiscard]] static auto Deserialize(std::string_view line) -> absl::StatusOr<std::unique_ptr<VariantCall>>;
+
   friend auto operator==(const VariantCall& lhs, const VariantCall& rhs) -> bool {
     return lhs.mVariantId == rhs.mVariantId;
   }
@@ -55,6 +60,8 @@ class VariantCall {
   }
 
  private:
+  VariantCall() = default;
+
   u64 mVariantId;
   usize mChromIndex;
   usize mStartPos1;
@@ -16,12 +16,15 @@
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "lancet/base/alloc_tracker.h"
 #include "lancet/base/assert.h"
 #include "lancet/base/logging.h"
 #include "lancet/base/repeat.h"
 #include "lancet/base/sliding.h"
 #include "lancet/base/timer.h"
+#include "lancet/base/trace_recorder.h"
 #include "lancet/base/types.h"
 #include "lancet/cbdg/edge.h"
 #include "lancet/cbdg/kmer.h"
@@ -36,13 +39,19 @@ namespace lancet::cbdg {
 /// https://github.com/GATB/bcalm/blob/v2.2.3/bidirected-graphs-in-bcalm2/bidirected-graphs-in-bcalm2.md
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
 auto Graph::BuildComponentHaplotypes(RegionPtr region, ReadList reads) -> Result {
+  const AllocScope alloc_scope(AllocTracker::Subsystem::GRAPH);
   mReads = reads;
   mRegion = std::move(region);
 
   Timer timer;
+  Timer traversal_timer;
+  auto traversal_runtime = absl::ZeroDuration();
+  PerfSpan traversal_span;
+  PerfCounters::Values traversal_counters;
   GraphHaps per_comp_haplotypes;
   std::string_view ref_anchor_seq;
   std::vector<usize> anchor_start_idxs;
+  std::vector<KmerAttempt> kmer_attempts;
   absl::flat_hash_set<MateMer> mate_mers;
 
   static constexpr usize DEFAULT_EST_NUM_NODES = 32768;
@@ -53,18 +62,28 @@ auto Graph::BuildComponentHaplotypes(RegionPtr region, ReadList reads) -> Result
   const auto reg_str = mRegion->ToSamtoolsRegion();
   mCurrK = mParams.mMinKmerLen - mParams.mKmerStepLen;
 
+  usize num_prior_visits = 0;
+  const auto is_over_budget = [this, &num_prior_visits](const usize num_current_visits) -> bool {
+    return mParams.mWindowVisitBudget > 0 && num_prior_visits + num_current_visits > mParams.mWindowVisitBudget;
+  };
+
 IncrementKmerAndRetry:
   while (per_comp_haplotypes.empty() && (mCurrK + mParams.mKmerStepLen) <= mParams.mMaxKmerLen) {
     mCurrK += mParams.mKmerStepLen;
     timer.Reset();
     mSourceAndSinkIds = {0, 0};
     mNodes.reserve(DEFAULT_EST_NUM_NODES);
+    kmer_attempts.push_back(KmerAttempt{.mKmerLen = mCurrK});
 
-    // NOLINTNEXTLINE(readability-braces-around-statements,cppcoreguidelines-avoid-goto)
-    if (HasExactOrApproxRepeat(mRegion->SeqView(), mCurrK)) goto IncrementKmerAndRetry;
+    if (HasExactOrApproxRepeat(mRegion->SeqView(), mCurrK)) {
+      kmer_attempts.back().mOutcome = KmerOutcome::REF_REPEAT;
+      goto IncrementKmerAndRetry;  // NOLINT(cppcoreguidelines-avoid-goto)
+    }
 
     mNodes.clear();
     BuildGraph(mate_mers);
+    kmer_attempts.back().mNumNodesBuilt = mNodes.size();
+    kmer_attempts.back().mNumEdgesBuilt = NumEdges();
     LOG_TRACE("Done building graph for {} with k={}, nodes={}, reads={}", reg_str, mCurrK, mNodes.size(), mReads.size())
 
     RemoveLowCovNodes(0);
@@ -72,6 +91,7 @@ IncrementKmerAndRetry:
     WriteDotDevelop(FIRST_LOW_COV_REMOVAL, 0);
 
     const auto components = MarkConnectedComponents();
+    kmer_attempts.back().mNumComponents = components.size();
     per_comp_haplotypes.reserve(components.size());
     anchor_start_idxs.reserve(components.size());
     LOG_TRACE("Found {} connected components in graph for {} with k={}", components.size(), reg_str, mCurrK)
@@ -102,6 +122,7 @@ IncrementKmerAndRetry:
 
       if (HasCycle()) {
         LOG_TRACE("Cycle found in graph for {} comp={} with k={}", reg_str, comp_id, mCurrK)
+        kmer_attempts.back().mOutcome = KmerOutcome::CYCLE;
         goto IncrementKmerAndRetry;  // NOLINT(cppcoreguidelines-avoid-goto)
       }
 
@@ -116,20 +137,46 @@ IncrementKmerAndRetry:
 
       if (HasCycle()) {
         LOG_TRACE("Cycle found in graph for {} comp={} with k={}", reg_str, comp_id, mCurrK)
+        kmer_attempts.back().mOutcome = KmerOutcome::CYCLE;
         goto IncrementKmerAndRetry;  // NOLINT(cppcoreguidelines-avoid-goto)
       }
 
       WriteDot(State::FULLY_PRUNED_GRAPH, comp_id);
+      kmer_attempts.back().mNumNodesPruned = mNodes.size();
+      kmer_attempts.back().mNumEdgesPruned = NumEdges();
+      kmer_attempts.back().mOutcome = KmerOutcome::NO_PATHS;
       LOG_TRACE("Starting Edmond Karp traversal for {} with k={}, num_nodes={}", reg_str, mCurrK, mNodes.size())
+      traversal_timer.Reset();
+      traversal_span.Restart();
+      TraceScope traversal_trace("PATH_TRAVERSAL");
       MaxFlow max_flow(&mNodes, mSourceAndSinkIds, mCurrK);
       auto path_seq = max_flow.NextPath();
 
-      while (path_seq) {
+      while (path_seq && !is_over_budget(max_flow.NumVisits())) {
         LOG_TRACE("Assembled {}bp path sequence for {} with k={}", path_seq->length(), reg_str, mCurrK)
         haplotypes.emplace_back(std::move(*path_seq));
         path_seq = max_flow.NextPath();
       }
 
+      traversal_runtime += traversal_timer.Runtime();
+      traversal_counters += traversal_span.Elapsed();
+      traversal_trace.End();
+      num_prior_visits += max_flow.NumVisits();
+
+      // Checked after every component and not only after found paths, since a traversal that visits walks up
+      // to the traversal limit without reaching the sink finds no path at all, and is retried with every k
+      if (is_over_budget(0)) {
+        LOG_TRACE("Exceeded budget of {} traversal visits for {} with k={}", mParams.mWindowVisitBudget, reg_str,
+                  mCurrK)
+        kmer_attempts.back().mOutcome = KmerOutcome::OVER_BUDGET;
+        return {.mGraphHaplotypes = {},
+                .mAnchorStartIdxs = {},
+                .mKmerAttempts = std::move(kmer_attempts),
+                .mTraversalRuntime = traversal_runtime,
+                .mTraversalCounters = traversal_counters,
+                .mIsOverBudget = true};
+      }
+
       if (!haplotypes.empty()) {
         std::ranges::sort(haplotypes);
         const auto dup_range = std::ranges::unique(haplotypes);
@@ -139,6 +186,9 @@ IncrementKmerAndRetry:
         anchor_start_idxs.emplace_back(source.mRefOffset);
       }
     }
+
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!per_comp_haplotypes.empty()) kmer_attempts.back().mOutcome = KmerOutcome::ASSEMBLED;
   }
 
   static const auto summer = [](const u64 sum, const auto& comp_haps) -> u64 { return sum + comp_haps.size() - 1; };
@@ -148,7 +198,11 @@ IncrementKmerAndRetry:
   const auto human_rt = timer.HumanRuntime();
 
   LOG_TRACE("Assembled {} haplotypes for {} with k={} in {}", num_asm_haps, reg_str, mCurrK, human_rt)
-  return {.mGraphHaplotypes = per_comp_haplotypes, .mAnchorStartIdxs = anchor_start_idxs};
+  return {.mGraphHaplotypes = per_comp_haplotypes,
+          .mAnchorStartIdxs = anchor_start_idxs,
+          .mKmerAttempts = std::move(kmer_attempts),
+          .mTraversalRuntime = traversal_runtime,
+          .mTraversalCounters = traversal_counters};
 }
 
 void Graph::CompressGraph(const usize component_id) {
@@ -633,6 +687,36 @@ auto Graph::RefAnchorLength(const RefAnchor& source, const RefAnchor& sink, usiz
   return sink.mRefOffset - source.mRefOffset + currk;
 }
 
+auto Graph::NumEdges() const -> usize {
+  static const auto summer = [](const usize sum, NodeTable::const_reference item) -> usize {
+    return sum + item.second->NumOutEdges();
+  };
+
+  // Every edge is stored in both of the nodes it connects
+  return std::accumulate(mNodes.cbegin(), mNodes.cend(), usize{0}, summer) / 2;
+}
+
+auto Graph::ToString(const KmerOutcome outcome) -> std::string {
+  switch (outcome) {
+    case KmerOutcome::ASSEMBLED:
+      return "ASSEMBLED";
+    case KmerOutcome::REF_REPEAT:
+      return "REF_REPEAT";
+    case KmerOutcome::CYCLE:
+      return "CYCLE";
+    case KmerOutcome::NO_ANCHOR:
+      return "NO_ANCHOR";
+    case KmerOutcome::NO_PATHS:
+      return "NO_PATHS";
+    case KmerOutcome::OVER_BUDGET:
+      return "OVER_BUDGET";
+    default:
+      break;
+  }
+
+  return "UNKNOWN";
+}
+
 #ifdef LANCET_DEVELOP_MODE
 auto Graph::ToString(const State state) -> std::string {
   switch (state) {
@@ -11,7 +11,9 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "lancet/base/perf_counters.h"
 #include "lancet/base/types.h"
 #include "lancet/cbdg/edge.h"
 #include "lancet/cbdg/kmer.h"
@@ -49,6 +51,9 @@ class Graph {
     u32 mMinAnchorCov = DEFAULT_MIN_ANCHOR_COV;
 
     u16 mKmerStepLen = DEFAULT_KMER_STEP_LEN;
+
+    // Max. number of walks visited by max flow traversals across all k values of one window. 0 is unlimited
+    u64 mWindowVisitBudget = 0;
   };
 
   Graph(Params params) : mParams(std::move(params)) {}
@@ -59,13 +64,36 @@ class Graph {
   using CompHaps = std::vector<std::string>;
   using GraphHaps = std::vector<CompHaps>;
 
+  // Why assembly with one k value ended. Only the last k value tried can be ASSEMBLED or OVER_BUDGET.
+  enum class KmerOutcome : u8 { ASSEMBLED, REF_REPEAT, CYCLE, NO_ANCHOR, NO_PATHS, OVER_BUDGET };
+
+  struct KmerAttempt {
+    usize mKmerLen = 0;
+    KmerOutcome mOutcome = KmerOutcome::NO_ANCHOR;
+    // Graph size right after building, and right before path enumeration of the last component tried
+    usize mNumNodesBuilt = 0;
+    usize mNumEdgesBuilt = 0;
+    usize mNumNodesPruned = 0;
+    usize mNumEdgesPruned = 0;
+    usize mNumComponents = 0;
+  };
+
   struct Result {
     GraphHaps mGraphHaplotypes;
     std::vector<usize> mAnchorStartIdxs;
+    std::vector<KmerAttempt> mKmerAttempts;
+    // Time spent enumerating paths with `MaxFlow`, summed over all components and k values tried
+    absl::Duration mTraversalRuntime = absl::ZeroDuration();
+    // Hardware counters of the same path enumeration, only counted with `--perf-counters`
+    PerfCounters::Values mTraversalCounters;
+    // Set when traversals exceeded `Params::mWindowVisitBudget`, in which case no haplotypes are returned
+    bool mIsOverBudget = false;
   };
 
   [[nodiscard]] auto BuildComponentHaplotypes(RegionPtr region, ReadList reads) -> Result;
 
+  [[nodiscard]] static auto ToString(KmerOutcome outcome) -> std::string;
+
  private:
   usize mCurrK = 0;
   RegionPtr mRegion;
@@ -100,6 +128,7 @@ class Graph {
 
   [[nodiscard]] auto HasCycle() const -> bool;
   void HasCycle(const Node& node, NodeIdSet& traversed, bool& found_cycle, usize& recursion_depth) const;
+  [[nodiscard]] auto NumEdges() const -> usize;
 
   struct ComponentInfo {
     f64 mPctNodes = 0.0;
@@ -7,6 +7,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
 #include "absl/strings/str_cat.h"
+#include "lancet/base/alloc_tracker.h"
 #include "lancet/base/assert.h"
 #include "lancet/cbdg/graph.h"
 #include "lancet/cbdg/kmer.h"
@@ -16,6 +17,7 @@ namespace lancet::cbdg {
 
 MaxFlow::MaxFlow(const Graph::NodeTable *graph, const NodeIDPair &src_and_snk, const usize currk)
     : mGraph(graph), mCurrentK(currk) {
+  const AllocScope alloc_scope(AllocTracker::Subsystem::MAX_FLOW);
   const auto [source_id, sink_id] = src_and_snk;
   const auto src_itr = mGraph->find(source_id);
   LANCET_ASSERT(src_itr != mGraph->end())
@@ -29,6 +31,7 @@ MaxFlow::MaxFlow(const Graph::NodeTable *graph, const NodeIDPair &src_and_snk, c
 }
 
 auto MaxFlow::NextPath() -> Result {
+  const AllocScope alloc_scope(AllocTracker::Subsystem::MAX_FLOW);
   auto walk = BuildNextWalk();
   // NOLINTNEXTLINE(readability-braces-around-statements)
   if (!walk.has_value() || walk->empty()) return std::nullopt;
@@ -62,6 +65,7 @@ auto MaxFlow::BuildNextWalk() -> std::optional<Walk> {
 
   while (!candidates.empty()) {
     nvisits++;
+    mNumVisits++;
 
     // NOLINTNEXTLINE(readability-braces-around-statements)
     if (nvisits > Graph::DEFAULT_GRAPH_TRAVERSAL_LIMIT) break;
@@ -24,6 +24,9 @@ class MaxFlow {
   using Result = std::optional<std::string>;
   [[nodiscard]] auto NextPath() -> Result;
 
+  // Total number of walks visited by all `NextPath` calls so far
+  [[nodiscard]] auto NumVisits() const noexcept -> usize { return mNumVisits; }
+
  private:
   static constexpr usize INLINE_EDGES = 8;
   absl::flat_hash_set<Edge> mTraversed;
@@ -33,6 +36,7 @@ class MaxFlow {
   const Node* mSource = nullptr;
   const Node* mSink = nullptr;
   usize mCurrentK = 0;
+  usize mNumVisits = 0;
 
   using Walk = std::vector<Edge>;
   using WalkView = absl::Span<const Edge>;
@@ -16,6 +16,29 @@ namespace lancet::cbdg {
 
 class Read {
  public:
+  // All fields of a read, for reads that are rebuilt without their alignment, e.g. from a captured window
+  struct Fields {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    i64 mStart0 = -1;
+    i32 mChromIdx = -1;
+    u16 mSamFlag = 0;
+    u8 mMapQual = 0;
+    u8 mPctAlnScoresDiff = 100;
+    bool mPassesAlnFilters = true;
+    Label::Tag mTag = Label::REFERENCE;
+    std::string mQname;
+    std::string mSequence;
+    std::string mSampleName;
+    std::vector<u8> mQuality;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  explicit Read(Fields fields)
+      : mStart0(fields.mStart0), mChromIdx(fields.mChromIdx), mSamFlag(fields.mSamFlag), mMapQual(fields.mMapQual),
+        mPctAlnScoresDiff(fields.mPctAlnScoresDiff), mPassesAlnFilters(fields.mPassesAlnFilters), mTag(fields.mTag),
+        mQname(std::move(fields.mQname)), mSequence(std::move(fields.mSequence)),
+        mSampleName(std::move(fields.mSampleName)), mQuality(std::move(fields.mQuality)) {}
+
   explicit Read(const hts::Alignment& aln, std::string sample_name, const Label::Tag tag)
       : mStart0(aln.StartPos0()), mChromIdx(aln.ChromIndex()), mSamFlag(aln.FlagRaw()), mMapQual(aln.MapQual()),
         mTag(tag), mQname(aln.QnameView()), mSequence(aln.SeqView()), mSampleName(std::move(sample_name)),
@@ -0,0 +1,145 @@
+#include "lancet/cli/checkpoint.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "lancet/base/types.h"
+#include "spdlog/fmt/bundled/core.h"
+#include "spdlog/fmt/bundled/ostream.h"
+
+namespace {
+
+constexpr std::string_view HEADER_LINE = "##lancet_checkpoint=1";
+constexpr std::string_view NUM_WINDOWS_KEY = "NUM_WINDOWS\t";
+constexpr std::string_view VCF_OFFSET_KEY = "VCF_OFFSET\t";
+constexpr std::string_view DONE_RANGE_KEY = "DONE\t";
+constexpr std::string_view VARIANT_KEY = "VARIANT\t";
+
+// Flushes the data of a file, or the entries of a directory, from the kernel to disk
+[[nodiscard]] auto SyncToDisk(const std::filesystem::path& path) -> bool {
+  const auto sync_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (sync_fd < 0) return false;
+  const auto sync_status = ::fsync(sync_fd);
+  ::close(sync_fd);
+  return sync_status == 0;
+}
+
+}  // namespace
+
+namespace lancet::cli {
+
+auto Checkpoint::PathForOutput(const std::filesystem::path& out_vcfgz) -> std::filesystem::path {
+  auto result = out_vcfgz;
+  result += ".checkpoint";
+  return result;
+}
+
+auto Checkpoint::Read(const std::filesystem::path& path) -> absl::StatusOr<Checkpoint> {
+  std::ifstream fhandle(path, std::ios_base::in);
+  if (!fhandle) {
+    return absl::Status(absl::StatusCode::kNotFound, fmt::format("Could not open checkpoint {}", path.string()));
+  }
+
+  std::string line;
+  if (!std::getline(fhandle, line) || line != HEADER_LINE) {
+    return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Invalid checkpoint header in {}", path.string()));
+  }
+
+  Checkpoint result;
+  usize line_num = 1;
+  const auto parse_error = [&path, &line_num]() -> absl::Status {
+    const auto msg = fmt::format("Could not parse line {} in checkpoint {}", line_num, path.string());
+    return absl::Status(absl::StatusCode::kDataLoss, msg);
+  };
+
+  while (std::getline(fhandle, line)) {
+    line_num++;
+    std::string_view contents = line;
+
+    if (absl::ConsumePrefix(&contents, VARIANT_KEY)) {
+      result.mVariants.emplace_back(contents);
+      continue;
+    }
+
+    if (absl::ConsumePrefix(&contents, DONE_RANGE_KEY)) {
+      const std::vector<std::string_view> tokens = absl::StrSplit(contents, '\t');
+      IndexRange range;
+      const auto is_valid_range = tokens.size() == 2 && absl::SimpleAtoi(tokens[0], &range.first) &&
+                                  absl::SimpleAtoi(tokens[1], &range.second) && range.first < range.second;
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!is_valid_range) return parse_error();
+      result.mDoneRanges.push_back(range);
+      continue;
+    }
+
+    if (absl::ConsumePrefix(&contents, NUM_WINDOWS_KEY)) {
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!absl::SimpleAtoi(contents, &result.mNumWindows)) return parse_error();
+      continue;
+    }
+
+    if (!absl::ConsumePrefix(&contents, VCF_OFFSET_KEY) || !absl::SimpleAtoi(contents, &result.mVcfOffset)) {
+      return parse_error();
+    }
+  }
+
+  if (result.mVcfOffset < 0 || result.mNumWindows == 0) {
+    return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Incomplete checkpoint {}", path.string()));
+  }
+
+  return result;
+}
+
+auto Checkpoint::Write(const std::filesystem::path& path) const -> absl::Status {
+  auto tmp_path = path;
+  tmp_path += ".tmp";
+
+  {
+    std::ofstream fhandle(tmp_path, std::ios_base::out | std::ios_base::trunc);
+    fmt::print(fhandle, "{}\n{}{}\n{}{}\n", HEADER_LINE, NUM_WINDOWS_KEY, mNumWindows, VCF_OFFSET_KEY, mVcfOffset);
+    for (const auto& [first, last] : mDoneRanges) {
+      fmt::print(fhandle, "{}{}\t{}\n", DONE_RANGE_KEY, first, last);
+    }
+    for (const auto& variant : mVariants) {
+      fmt::print(fhandle, "{}{}\n", VARIANT_KEY, variant);
+    }
+
+    fhandle.close();
+    // Synced before the rename, so that a host crash never leaves a renamed but empty or truncated checkpoint
+    if (!fhandle || !SyncToDisk(tmp_path)) {
+      return absl::Status(absl::StatusCode::kInternal, fmt::format("Could not write checkpoint {}", tmp_path.string()));
+    }
+  }
+
+  std::error_code err_code;
+  std::filesystem::rename(tmp_path, path, err_code);
+  if (err_code) {
+    const auto msg = fmt::format("Could not move checkpoint to {}: {}", path.string(), err_code.message());
+    return absl::Status(absl::StatusCode::kInternal, msg);
+  }
+
+  // Directory is synced as well, since the rename itself is only durable once its directory entry is on disk
+  const auto parent_dir = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+  if (!SyncToDisk(parent_dir)) {
+    return absl::Status(absl::StatusCode::kInternal, fmt::format("Could not sync checkpoint {}", path.string()));
+  }
+
+  return absl::OkStatus();
+}
+
+}  // namespace lancet::cli
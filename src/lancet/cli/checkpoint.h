@@ -0,0 +1,47 @@
+#ifndef SRC_LANCET_CLI_CHECKPOINT_H_
+#define SRC_LANCET_CLI_CHECKPOINT_H_
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "lancet/base/types.h"
+
+namespace lancet::cli {
+
+// Snapshot of a running pipeline that a later run can resume from without redoing finished windows.
+// Holds the BGZF virtual offset up to which the output VCF is complete, the genome indices of all
+// finished windows and the serialized variants that were still held in the VariantStore.
+class Checkpoint {
+ public:
+  using IndexRange = std::pair<usize, usize>;
+
+  Checkpoint() = default;
+  Checkpoint(usize num_windows, i64 vcf_offset, std::vector<IndexRange> done_ranges, std::vector<std::string> variants)
+      : mNumWindows(num_windows), mVcfOffset(vcf_offset), mDoneRanges(std::move(done_ranges)),
+        mVariants(std::move(variants)) {}
+
+  [[nodiscard]] static auto PathForOutput(const std::filesystem::path& out_vcfgz) -> std::filesystem::path;
+  [[nodiscard]] static auto Read(const std::filesystem::path& path) -> absl::StatusOr<Checkpoint>;
+
+  // Writes to a temporary file first, syncs it and renames it over `path`, so a crash never leaves a partial checkpoint
+  [[nodiscard]] auto Write(const std::filesystem::path& path) const -> absl::Status;
+
+  [[nodiscard]] auto NumWindows() const noexcept -> usize { return mNumWindows; }
+  [[nodiscard]] auto VcfOffset() const noexcept -> i64 { return mVcfOffset; }
+  [[nodiscard]] auto DoneRanges() const noexcept -> const std::vector<IndexRange>& { return mDoneRanges; }
+  [[nodiscard]] auto Variants() const noexcept -> const std::vector<std::string>& { return mVariants; }
+
+ private:
+  usize mNumWindows = 0;
+  i64 mVcfOffset = -1;
+  std::vector<IndexRange> mDoneRanges;
+  std::vector<std::string> mVariants;
+};
+
+}  // namespace lancet::cli
+
+#endif  // SRC_LANCET_CLI_CHECKPOINT_H_
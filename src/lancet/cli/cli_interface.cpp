@@ -18,6 +18,7 @@
 #include "lancet/cbdg/graph.h"
 #include "lancet/cli/cli_params.h"
 #include "lancet/cli/pipeline_runner.h"
+#include "lancet/cli/vcf_merger.h"
 #include "lancet/core/window_builder.h"
 #include "spdlog/common.h"
 #include "spdlog/fmt/bundled/core.h"
@@ -60,9 +61,11 @@ static constexpr auto APP_NAME_FMT_STR = "Lancet, {}\nMicrosssembly based somati
 namespace lancet::cli {
 
 CliInterface::CliInterface()
-    : mCliApp(fmt::format(APP_NAME_FMT_STR, LancetFullVersion())), mParamsPtr(std::make_shared<CliParams>()) {
+    : mCliApp(fmt::format(APP_NAME_FMT_STR, LancetFullVersion())), mParamsPtr(std::make_shared<CliParams>()),
+      mMergeParamsPtr(std::make_shared<VcfMerger::Params>()) {
   mCliApp.require_subcommand(1);
   PipelineSubcmd(&mCliApp, mParamsPtr);
+  MergeSubcmd(&mCliApp, mMergeParamsPtr);
 
   static const auto version_printer = [](const usize count) -> void {
     if (count > 0) {
@@ -144,11 +147,27 @@ void CliInterface::PipelineSubcmd(CLI::App* app, std::shared_ptr<CliParams>& par
   subcmd->add_option("-w,--window-size", params->mWindowBuilder.mWindowLength, "Window size for variant calling tasks")
       ->group("Regions")
       ->check(CLI::Range(core::WindowBuilder::MIN_ALLOWED_WINDOW_LEN, core::WindowBuilder::MAX_ALLOWED_WINDOW_LEN));
+  auto* shard_index_opt =
+      subcmd->add_option("--shard-index", params->mShardIndex, "0-based index of the window shard to process")
+          ->group("Regions")
+          ->check(CLI::NonNegativeNumber);
+  subcmd->add_option("--num-shards", params->mNumShards, "Split windows into cost balanced contiguous shards")
+      ->group("Regions")
+      ->check(CLI::PositiveNumber);
+  subcmd->add_option("--work-ledger", params->mWorkLedger, "Ledger file shared by processes claiming shards to process")
+      ->group("Regions")
+      ->excludes(shard_index_opt);
 
   // Parameters
   subcmd->add_option("-T,--num-threads", params->mNumWorkerThreads, "Number of additional async worker threads")
       ->group("Parameters")
       ->check(CLI::Range(0, MAX_NUM_THREADS));
+  subcmd->add_option("--num-io-threads", params->mNumIoThreads, "Number of threads collecting reads ahead of assembly")
+      ->group("Parameters")
+      ->check(CLI::Range(0, MAX_NUM_THREADS));
+  subcmd->add_option("--pin-threads", params->mPinThreads, "Pin worker threads to single cores or to NUMA nodes")
+      ->group("Parameters")
+      ->check(CLI::IsMember({"none", "cores", "numa"}));
   subcmd->add_option("-k,--min-kmer", vb_prms.mGraphParams.mMinKmerLen, "Min. kmer length to try for graph nodes")
       ->group("Parameters")
       ->check(CLI::Range(cbdg::Graph::DEFAULT_MIN_KMER_LEN, cbdg::Graph::MAX_ALLOWED_KMER_LEN - 2));
@@ -168,19 +187,66 @@ void CliInterface::PipelineSubcmd(CLI::App* app, std::shared_ptr<CliParams>& par
   subcmd->add_option("--max-sample-cov", rc_prms.mMaxSampleCov, "Max. per sample coverage before downsampling")
       ->group("Parameters")
       ->check(CLI::Range(u32(0), std::numeric_limits<u32>::max()));
+  subcmd->add_option("--window-visit-budget", grph_prms.mWindowVisitBudget,
+                     "Max. graph traversal visits per window before it is deferred (0 disables)")
+      ->group("Parameters")
+      ->check(CLI::NonNegativeNumber);
 
   // Feature flags
   subcmd->add_flag("--verbose", params->mEnableVerboseLogging, "Turn on verbose logging")->group("Flags");
   subcmd->add_flag("--extract-pairs", rc_prms.mExtractPairs, "Extract all useful read pairs")->group("Flags");
   subcmd->add_flag("--no-active-region", vb_prms.mSkipActiveRegion, "Force assemble all windows")->group("Flags");
   subcmd->add_flag("--no-contig-check", rc_prms.mNoCtgCheck, "Skip contig check with reference")->group("Flags");
+  subcmd->add_flag("--resume", params->mResume, "Resume from checkpoint next to the output VCF")
+      ->group("Flags")
+      ->excludes("--work-ledger");
+  subcmd->add_flag("--perf-counters", params->mPerfCounters, "Count hardware events of each stage with perf_event_open")
+      ->group("Flags");
+  subcmd->add_flag("--alloc-stats", params->mAllocStats, "Count heap allocations of each subsystem")->group("Flags");
 
   // Optional
   subcmd->add_option("--graphs-dir", vb_prms.mOutGraphsDir, "Output directory to write per window graphs")
       ->check(CLI::NonexistentPath | CLI::ExistingDirectory)
       ->group("Optional");
+  subcmd->add_option("--cache-dir", params->mCacheDir, "Directory to cache per window results across runs")
+      ->check(CLI::NonexistentPath | CLI::ExistingDirectory)
+      ->group("Optional");
+  subcmd->add_option("--window-stats", params->mWindowStats, "Output path to per window stats TSV.gz file")
+      ->group("Optional");
+  subcmd->add_option("--trace-file", params->mTraceFile, "Output path to Chrome trace JSON file of worker timeline")
+      ->group("Optional");
+  subcmd->add_option("--metrics-file", params->mMetricsFile, "Output path to OpenMetrics progress file (*.prom)")
+      ->group("Optional");
+  subcmd->add_option("--metrics-interval", params->mMetricsSecs, "Seconds between rewrites of the metrics file")
+      ->group("Optional")
+      ->check(CLI::PositiveNumber);
+  subcmd->add_option("--cpu-profile", params->mCpuProfile, "Output path to gperftools CPU profile (release builds)")
+      ->group("Optional");
+  subcmd->add_option("--cpu-profile-frequency", params->mCpuProfileHz, "CPU profile samples per second per thread")
+      ->group("Optional")
+      ->check(CLI::Range(1, 10000));
+  subcmd->add_option("--capture-windows", vb_prms.mCaptureDir, "Output directory to capture assembly inputs of windows")
+      ->check(CLI::NonexistentPath | CLI::ExistingDirectory)
+      ->group("Optional");
+  subcmd
+      ->add_option("--capture-min-runtime", params->mCaptureMinSecs,
+                   "Min. assembly seconds of captured windows (0 captures all)")
+      ->group("Optional")
+      ->check(CLI::NonNegativeNumber);
+  subcmd->add_option("--checkpoint-interval", params->mCheckpointSecs, "Seconds between checkpoints (0 disables)")
+      ->group("Optional")
+      ->check(CLI::NonNegativeNumber);
 
   subcmd->callback([params]() {
+    if (params->mShardIndex >= params->mNumShards) {
+      throw CLI::ValidationError("--shard-index", "Shard index must be less than the number of shards");
+    }
+
+    // Ledger blocks are the shards, so a single shard would leave every process but one without work
+    if (!params->mWorkLedger.empty() && params->mNumShards < 2) {
+      throw CLI::ValidationError("--work-ledger", "Work ledger needs --num-shards of at least 2");
+    }
+
     // NOLINTBEGIN(readability-braces-around-statements)
     if (static_cast<bool>(isatty(fileno(stderr)))) fmt::print(std::cerr, FIGLET_LANCET_LOGO);
     if (params->mEnableVerboseLogging) SetLancetLoggerLevel(spdlog::level::trace);
@@ -192,4 +258,31 @@ void CliInterface::PipelineSubcmd(CLI::App* app, std::shared_ptr<CliParams>& par
   });
 }
 
+void CliInterface::MergeSubcmd(CLI::App* app, std::shared_ptr<VcfMerger::Params>& params) {
+  auto* subcmd = app->add_subcommand("merge", "Merge sorted Lancet VCFs into one indexed VCF");
+  subcmd->option_defaults()->always_capture_default();
+
+  subcmd->add_option("-i,--in-vcf", params->mInVcfs, "Path to two (or) more sorted Lancet VCF files")
+      ->required(true)
+      ->expected(2, -1)
+      ->group("Required")
+      ->check(CLI::ExistingFile);
+  subcmd->add_option("-o,--out-vcfgz", params->mOutVcfGz, "Output path to the merged & sorted VCF file")
+      ->required(true)
+      ->group("Required");
+
+  subcmd->callback([params]() {
+    LOG_INFO("Merging {} VCF files into {}", params->mInVcfs.size(), params->mOutVcfGz.string())
+    VcfMerger merger(*params);
+    const auto num_records = merger.Merge();
+    if (!num_records.ok()) {
+      LOG_CRITICAL("Could not merge VCF files: {}", num_records.status().message())
+      std::exit(EXIT_FAILURE);
+    }
+
+    LOG_INFO("Successfully wrote {} merged variants to {}", *num_records, params->mOutVcfGz.string())
+    std::exit(EXIT_SUCCESS);
+  });
+}
+
 }  // namespace lancet::cli
@@ -5,6 +5,7 @@
 
 #include "CLI/CLI.hpp"
 #include "lancet/cli/cli_params.h"
+#include "lancet/cli/vcf_merger.h"
 
 namespace lancet::cli {
 
@@ -17,8 +18,10 @@ class CliInterface {
  private:
   CLI::App mCliApp;
   std::shared_ptr<CliParams> mParamsPtr;
+  std::shared_ptr<VcfMerger::Params> mMergeParamsPtr;
 
   static void PipelineSubcmd(CLI::App* app, std::shared_ptr<CliParams>& params);
+  static void MergeSubcmd(CLI::App* app, std::shared_ptr<VcfMerger::Params>& params);
 };
 
 }  // namespace lancet::cli
@@ -19,10 +19,27 @@ class CliParams {
   std::string mFullCmdLine;
   std::filesystem::path mOutVcfGz;
   std::filesystem::path mBedFile;
+  std::filesystem::path mCacheDir;
+  std::filesystem::path mWorkLedger;
+  std::filesystem::path mWindowStats;
+  std::filesystem::path mTraceFile;
+  std::filesystem::path mMetricsFile;
+  std::filesystem::path mCpuProfile;
   std::vector<std::string> mInRegions;
 
   usize mNumWorkerThreads = 2;
+  usize mNumIoThreads = 0;
+  usize mShardIndex = 0;
+  usize mNumShards = 1;
+  u32 mCheckpointSecs = 0;
+  u32 mMetricsSecs = 15;
+  u32 mCpuProfileHz = 100;
+  f64 mCaptureMinSecs = 1.0;
+  std::string mPinThreads = "none";
   bool mEnableVerboseLogging = false;
+  bool mResume = false;
+  bool mPerfCounters = false;
+  bool mAllocStats = false;
 
   core::WindowBuilder::Params mWindowBuilder;
   core::VariantBuilder::Params mVariantBuilder;
@@ -0,0 +1,76 @@
+#include "lancet/cli/cpu_profiler.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef LANCET_CPU_PROFILER
+#include "gperftools/profiler.h"
+#endif
+#include "absl/strings/str_split.h"
+#include "lancet/base/logging.h"
+#include "lancet/base/types.h"
+
+namespace {
+
+constexpr auto FREQUENCY_ENV = "CPUPROFILE_FREQUENCY";
+constexpr auto PER_THREAD_TIMERS_ENV = "CPUPROFILE_PER_THREAD_TIMERS";
+
+// Arguments of this process as it was started, since argv is not kept around after parsing it
+[[nodiscard]] auto ReadCommandLine() -> std::vector<std::string> {
+  std::ifstream cmdline_file("/proc/self/cmdline", std::ios_base::binary);
+  const std::string contents{std::istreambuf_iterator<char>(cmdline_file), std::istreambuf_iterator<char>()};
+  return absl::StrSplit(contents, '\0', absl::SkipEmpty());
+}
+
+}  // namespace
+
+namespace lancet::cli {
+
+void CpuProfiler::PrepareEnvironment(const u32 frequency) {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!IS_SUPPORTED) return;
+
+  const auto expected_frequency = std::to_string(frequency);
+  const char* current_frequency = std::getenv(FREQUENCY_ENV);  // NOLINT(concurrency-mt-unsafe)
+  const char* per_thread_timers = std::getenv(PER_THREAD_TIMERS_ENV);  // NOLINT(concurrency-mt-unsafe)
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (per_thread_timers != nullptr && current_frequency != nullptr && expected_frequency == current_frequency) return;
+
+  // Per thread timers sample each registered worker at the full frequency, instead of one process wide
+  // timer whose samples are spread over all running threads
+  setenv(FREQUENCY_ENV, expected_frequency.c_str(), 1);  // NOLINT(concurrency-mt-unsafe)
+  setenv(PER_THREAD_TIMERS_ENV, "1", 1);                 // NOLINT(concurrency-mt-unsafe)
+
+  auto args = ReadCommandLine();
+  std::vector<char*> arg_ptrs;
+  arg_ptrs.reserve(args.size() + 1);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  for (auto& arg : args) arg_ptrs.push_back(arg.data());
+  arg_ptrs.push_back(nullptr);
+
+  LOG_INFO("Restarting with CPU profiler sampling at {} Hz", frequency)
+  execv("/proc/self/exe", arg_ptrs.data());
+  LOG_WARN("Could not restart with CPU profiler settings, using default sampling: {}", std::strerror(errno))
+}
+
+#ifdef LANCET_CPU_PROFILER
+auto CpuProfiler::Start(const std::filesystem::path& path) -> bool { return ProfilerStart(path.c_str()) != 0; }
+
+void CpuProfiler::RegisterCurrentThread() { ProfilerRegisterThread(); }
+void CpuProfiler::Stop() { ProfilerStop(); }
+#else
+auto CpuProfiler::Start([[maybe_unused]] const std::filesystem::path& path) -> bool { return false; }
+void CpuProfiler::RegisterCurrentThread() {}
+void CpuProfiler::Stop() {}
+#endif
+
+}  // namespace lancet::cli
@@ -0,0 +1,32 @@
+#ifndef SRC_LANCET_CLI_CPU_PROFILER_H_
+#define SRC_LANCET_CLI_CPU_PROFILER_H_
+
+#include <filesystem>
+
+#include "lancet/base/types.h"
+
+namespace lancet::cli {
+
+// `--cpu-profile` support using the gperftools CPU profiler, which is only linked into release builds.
+// Profiles are written in the pprof format, e.g. `pprof --http=:8080 Lancet2 <profile>` to browse them.
+class CpuProfiler {
+ public:
+#ifdef LANCET_CPU_PROFILER
+  static constexpr bool IS_SUPPORTED = true;
+#else
+  static constexpr bool IS_SUPPORTED = false;
+#endif
+
+  // gperftools reads its timer settings from the environment once, while the process starts up. If they
+  // are not set to `frequency` yet, sets them and re-executes the process in place. Call before threads start.
+  static void PrepareEnvironment(u32 frequency);
+
+  [[nodiscard]] static auto Start(const std::filesystem::path& path) -> bool;
+  // Threads other than the one that started the profiler are only sampled after they register themselves
+  static void RegisterCurrentThread();
+  static void Stop();
+};
+
+}  // namespace lancet::cli
+
+#endif  // SRC_LANCET_CLI_CPU_PROFILER_H_
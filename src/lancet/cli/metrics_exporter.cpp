@@ -0,0 +1,123 @@
+#include "lancet/cli/metrics_exporter.h"
+
+#include <unistd.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "lancet/base/types.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window_timings.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+// OpenMetrics spells non-finite values differently from fmt, e.g. the rate before any window is done
+[[nodiscard]] auto FormatValue(const f64 value) -> std::string {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (std::isnan(value)) return "NaN";
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+  return fmt::format("{}", value);
+}
+
+void AppendGauge(std::string& out, const std::string_view name, const std::string_view help) {
+  fmt::format_to(std::back_inserter(out), "# TYPE {0} gauge\n# HELP {0} {1}\n", name, help);
+}
+
+void AppendSample(std::string& out, const std::string_view name, const std::string_view labels, const f64 value) {
+  if (labels.empty()) {
+    fmt::format_to(std::back_inserter(out), "{} {}\n", name, FormatValue(value));
+    return;
+  }
+  fmt::format_to(std::back_inserter(out), "{}{{{}}} {}\n", name, labels, FormatValue(value));
+}
+
+}  // namespace
+
+namespace lancet::cli {
+
+auto MetricsExporter::Write(const Progress& progress, const StatusCounts& counts,
+                            const core::WindowTimingStats& timings) const -> absl::Status {
+  // node_exporter only reads `*.prom` files, so it never sees the partially written temporary file.
+  // Work ledger processes may share one metrics file, so each process writes its own temporary file.
+  auto tmp_path = mPath;
+  tmp_path += fmt::format(".{}.tmp", getpid());
+
+  {
+    std::ofstream fhandle(tmp_path, std::ios_base::out | std::ios_base::trunc);
+    fhandle << Format(progress, counts, timings);
+    fhandle.flush();
+    if (!fhandle) {
+      return absl::Status(absl::StatusCode::kInternal, fmt::format("Could not write metrics {}", tmp_path.string()));
+    }
+  }
+
+  std::error_code err_code;
+  std::filesystem::rename(tmp_path, mPath, err_code);
+  if (err_code) {
+    const auto msg = fmt::format("Could not move metrics to {}: {}", mPath.string(), err_code.message());
+    return absl::Status(absl::StatusCode::kInternal, msg);
+  }
+
+  return absl::OkStatus();
+}
+
+auto MetricsExporter::Format(const Progress& progress, const StatusCounts& counts,
+                             const core::WindowTimingStats& timings) -> std::string {
+  std::string result;
+  const auto num_remaining = progress.mNumTotalWindows - progress.mNumDoneWindows;
+
+  AppendGauge(result, "lancet_windows", "Windows of the run that are done or remaining");
+  AppendSample(result, "lancet_windows", R"(state="done")", static_cast<f64>(progress.mNumDoneWindows));
+  AppendSample(result, "lancet_windows", R"(state="remaining")", static_cast<f64>(num_remaining));
+
+  AppendGauge(result, "lancet_window_results", "Windows processed by this process by status, counting each retry");
+  for (const auto& [status, count] : counts) {
+    const auto labels = fmt::format(R"(status="{}")", core::ToString(status));
+    AppendSample(result, "lancet_window_results", labels, static_cast<f64>(count));
+  }
+
+  AppendGauge(result, "lancet_windows_per_second", "Windows done per second");
+  AppendSample(result, "lancet_windows_per_second", {}, progress.mWindowsPerSecond);
+  AppendGauge(result, "lancet_eta_seconds", "Estimated seconds until all windows are done");
+  AppendSample(result, "lancet_eta_seconds", {}, absl::ToDoubleSeconds(progress.mEta));
+  AppendGauge(result, "lancet_elapsed_seconds", "Seconds since the current shard started processing");
+  AppendSample(result, "lancet_elapsed_seconds", {}, absl::ToDoubleSeconds(progress.mElapsed));
+  AppendGauge(result, "lancet_variant_store_variants", "Variants held in memory until they are written to the VCF");
+  AppendSample(result, "lancet_variant_store_variants", {}, static_cast<f64>(progress.mNumStoredVariants));
+  AppendGauge(result, "lancet_resident_memory_bytes", "Resident set size of the process");
+  AppendSample(result, "lancet_resident_memory_bytes", {}, static_cast<f64>(progress.mResidentBytes));
+
+  AppendGauge(result, "lancet_stage_seconds", "Cumulative seconds spent in each stage over all windows");
+  for (usize idx = 0; idx < core::WindowTimings::NUM_STAGES; ++idx) {
+    const auto stage = static_cast<core::WindowTimings::Stage>(idx);
+    const auto labels = fmt::format(R"(stage="{}")", core::StageName(stage));
+    AppendSample(result, "lancet_stage_seconds", labels, absl::ToDoubleSeconds(timings.TotalRuntime(stage)));
+  }
+
+  result += "# EOF\n";
+  return result;
+}
+
+auto MetricsExporter::CurrentResidentBytes() -> u64 {
+  // Second field of statm is the number of resident pages
+  std::ifstream statm_file("/proc/self/statm");
+  u64 num_total_pages = 0;
+  u64 num_resident_pages = 0;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!(statm_file >> num_total_pages >> num_resident_pages)) return 0;
+
+  const auto page_size = sysconf(_SC_PAGESIZE);
+  return page_size > 0 ? num_resident_pages * static_cast<u64>(page_size) : 0;
+}
+
+}  // namespace lancet::cli
@@ -0,0 +1,52 @@
+#ifndef SRC_LANCET_CLI_METRICS_EXPORTER_H_
+#define SRC_LANCET_CLI_METRICS_EXPORTER_H_
+
+#include <filesystem>
+#include <string>
+#include <utility>
+
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "lancet/base/types.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window_timings.h"
+
+namespace lancet::cli {
+
+// Writes run progress and throughput to the `--metrics-file` in the OpenMetrics text format, so that
+// node_exporter's textfile collector can scrape it. Every write atomically replaces the previous file.
+class MetricsExporter {
+ public:
+  using StatusCounts = absl::btree_map<core::VariantBuilder::StatusCode, u64>;
+
+  struct Progress {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    usize mNumTotalWindows = 0;
+    usize mNumDoneWindows = 0;
+    f64 mWindowsPerSecond = 0.0;
+    absl::Duration mEta = absl::ZeroDuration();
+    absl::Duration mElapsed = absl::ZeroDuration();
+    usize mNumStoredVariants = 0;
+    u64 mResidentBytes = 0;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  explicit MetricsExporter(std::filesystem::path path) : mPath(std::move(path)) {}
+
+  [[nodiscard]] auto Write(const Progress& progress, const StatusCounts& counts,
+                           const core::WindowTimingStats& timings) const -> absl::Status;
+
+  [[nodiscard]] static auto Format(const Progress& progress, const StatusCounts& counts,
+                                   const core::WindowTimingStats& timings) -> std::string;
+
+  // Resident set size of this process, or 0 if it is not available
+  [[nodiscard]] static auto CurrentResidentBytes() -> u64;
+
+ private:
+  std::filesystem::path mPath;
+};
+
+}  // namespace lancet::cli
+
+#endif  // SRC_LANCET_CLI_METRICS_EXPORTER_H_
@@ -1,26 +1,24 @@
 #include "lancet/cli/pipeline_runner.h"
 
 #include <algorithm>
-#include <chrono>  // NOLINT(misc-include-cleaner)
 #include <cmath>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <functional>
+#include <ios>
+#include <iterator>
 #include <memory>
 #include <numeric>
 #include <stop_token>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <thread>
 #include <utility>
 #include <vector>
 
-// #ifndef LANCET_DEVELOP_MODE
-// #include "gperftools/profiler.h"
-// #endif
-
 #include "absl/container/btree_map.h"
-#include "absl/container/fixed_array.h"
 #include "absl/hash/hash.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -28,32 +26,62 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "blockingconcurrentqueue.h"
 #include "concurrentqueue.h"
+#include "lancet/base/alloc_tracker.h"
+#include "lancet/base/completion_tracker.h"
 #include "lancet/base/logging.h"
+#include "lancet/base/perf_counters.h"
+#include "lancet/base/thread_placement.h"
 #include "lancet/base/timer.h"
+#include "lancet/base/trace_recorder.h"
 #include "lancet/base/types.h"
 #include "lancet/base/version.h"
+#include "lancet/caller/variant_call.h"
+#include "lancet/cli/checkpoint.h"
+#include "lancet/cli/cpu_profiler.h"
 #include "lancet/cli/cli_params.h"
 #include "lancet/cli/eta_timer.h"
+#include "lancet/cli/metrics_exporter.h"
+#include "lancet/cli/window_stats_writer.h"
+#include "lancet/cli/work_ledger.h"
 #include "lancet/core/async_worker.h"
 #include "lancet/core/read_collector.h"
+#include "lancet/core/shard_planner.h"
 #include "lancet/core/variant_builder.h"
 #include "lancet/core/variant_store.h"
 #include "lancet/core/window.h"
 #include "lancet/core/window_builder.h"
+#include "lancet/core/window_cache.h"
+#include "lancet/core/window_cost_model.h"
+#include "lancet/core/window_scheduler.h"
+#include "lancet/core/window_timings.h"
 #include "lancet/hts/alignment.h"
 #include "lancet/hts/bgzf_ostream.h"
 #include "lancet/hts/extractor.h"
 #include "lancet/hts/reference.h"
 #include "spdlog/fmt/bundled/core.h"
 
+using lancet::cli::CpuProfiler;
 using lancet::core::AsyncWorker;
 using lancet::core::VariantBuilder;
 using WindowStats = absl::btree_map<VariantBuilder::StatusCode, u64>;
 
 namespace {
 
+[[nodiscard]] auto WorkerThreadName(const AsyncWorker::Stage stage, const usize worker_idx) -> std::string {
+  switch (stage) {
+    case AsyncWorker::Stage::READS:
+      return fmt::format("reads worker {}", worker_idx);
+    case AsyncWorker::Stage::ASSEMBLY:
+      return fmt::format("assembly worker {}", worker_idx);
+    default:
+      return fmt::format("worker {}", worker_idx);
+  }
+}
+
 [[nodiscard]] inline auto InitWindowStats() -> absl::btree_map<VariantBuilder::StatusCode, u64> {
+  using VariantBuilder::StatusCode::DEFERRED_OVER_BUDGET;
   using VariantBuilder::StatusCode::FOUND_GENOTYPED_VARIANT;
   using VariantBuilder::StatusCode::MISSING_NO_MSA_VARIANTS;
   using VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION;
@@ -68,10 +96,12 @@ namespace {
                      {SKIPPED_INACTIVE_REGION, 0},
                      {SKIPPED_NOASM_HAPLOTYPE, 0},
                      {MISSING_NO_MSA_VARIANTS, 0},
-                     {FOUND_GENOTYPED_VARIANT, 0}};
+                     {FOUND_GENOTYPED_VARIANT, 0},
+                     {DEFERRED_OVER_BUDGET, 0}};
 }
 
 void LogWindowStats(const WindowStats &stats) {
+  using VariantBuilder::StatusCode::DEFERRED_OVER_BUDGET;
   using VariantBuilder::StatusCode::FOUND_GENOTYPED_VARIANT;
   using VariantBuilder::StatusCode::MISSING_NO_MSA_VARIANTS;
   using VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION;
@@ -81,7 +111,8 @@ void LogWindowStats(const WindowStats &stats) {
 
   using CodeCounts = std::pair<const VariantBuilder::StatusCode, u64>;
   static const auto summer = [](const u64 sum, const CodeCounts &item) -> u64 { return sum + item.second; };
-  const auto nwindows = std::accumulate(stats.cbegin(), stats.cend(), 0, summer);
+  // Deferred windows are counted again with the status of their retry, so they are not part of the total
+  const auto nwindows = std::accumulate(stats.cbegin(), stats.cend(), 0, summer) - stats.at(DEFERRED_OVER_BUDGET);
 
   std::ranges::for_each(stats, [&nwindows](const CodeCounts &item) {
     const auto [status_code, count] = item;
@@ -105,41 +136,106 @@ void LogWindowStats(const WindowStats &stats) {
       case FOUND_GENOTYPED_VARIANT:
         LOG_INFO("FOUND_GENOTYPED_VARIANT | {:>8.4f}% of total windows | {} windows", pct_count, count)
         break;
+      case DEFERRED_OVER_BUDGET:
+        LOG_INFO("DEFERRED_OVER_BUDGET    | {:>8.4f}% of total windows | {} windows", pct_count, count)
+        break;
       default:
         break;
     }
   });
 }
 
+void LogAllocReport(const AllocTracker::Usage &usage) {
+  static constexpr f64 BYTES_PER_MEBIBYTE = 1024.0 * 1024.0;
+  for (usize idx = 0; idx < AllocTracker::NUM_SUBSYSTEMS; ++idx) {
+    const auto &counts = usage.at(idx);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (counts.mNumAllocs == 0) continue;
+    const auto subsystem = AllocTracker::ToString(static_cast<AllocTracker::Subsystem>(idx));
+    const auto total_mib = static_cast<f64>(counts.mNumBytes) / BYTES_PER_MEBIBYTE;
+    const auto peak_mib = static_cast<f64>(counts.mPeakBytes) / BYTES_PER_MEBIBYTE;
+    LOG_INFO("{:<15} | {:>12} allocations | {:>12.2f} MiB allocated | {:>10.2f} MiB peak", subsystem,
+             counts.mNumAllocs, total_mib, peak_mib)
+  }
+}
+
+[[nodiscard]] auto LoadCheckpoint(const std::filesystem::path &path, const usize num_windows)
+    -> lancet::cli::Checkpoint {
+  auto result = lancet::cli::Checkpoint::Read(path);
+  if (!result.ok()) {
+    LOG_CRITICAL("Could not resume from checkpoint: {}", result.status().message())
+    std::exit(EXIT_FAILURE);
+  }
+
+  const auto is_past_end = [&num_windows](const auto &range) -> bool { return range.second > num_windows; };
+  if (result->NumWindows() != num_windows || std::ranges::any_of(result->DoneRanges(), is_past_end)) {
+    LOG_CRITICAL("Checkpoint {} was made for {} windows, but current run has {} windows. Check that all parameters "
+                 "are the same as in the checkpointed run",
+                 path.string(), result->NumWindows(), num_windows)
+    std::exit(EXIT_FAILURE);
+  }
+
+  return *std::move(result);
+}
+
+void RestoreVariants(const lancet::cli::Checkpoint &checkpoint, lancet::core::VariantStore &store) {
+  std::vector<lancet::core::VariantStore::Value> variants;
+  variants.reserve(checkpoint.Variants().size());
+  for (const auto &serialized : checkpoint.Variants()) {
+    auto variant = lancet::caller::VariantCall::Deserialize(serialized);
+    if (!variant.ok()) {
+      LOG_CRITICAL("Could not restore variant from checkpoint: {}", variant.status().message())
+      std::exit(EXIT_FAILURE);
+    }
+    variants.emplace_back(*std::move(variant));
+  }
+
+  store.AddVariants(std::move(variants));
+}
+
+[[nodiscard]] auto MakeWindowCache(const lancet::cli::CliParams &params) -> AsyncWorker::WindowCachePtr {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (params.mCacheDir.empty()) return nullptr;
+
+  // Cached windows are never assembled again, so they would be missing from the graphs directory
+  if (!params.mVariantBuilder.mOutGraphsDir.empty()) {
+    LOG_WARN("Window cache {} is not used, since graphs are written to {}", params.mCacheDir.string(),
+             params.mVariantBuilder.mOutGraphsDir.string())
+    return nullptr;
+  }
+
+  auto result = std::make_shared<const lancet::core::WindowCache>(params.mCacheDir, params.mVariantBuilder);
+  LOG_INFO("Using window cache {} with run fingerprint {:016x}", params.mCacheDir.string(), result->RunFingerprint())
+  return result;
+}
+
 }  // namespace
 
 // NOLINTBEGIN(bugprone-easily-swappable-parameters,performance-unnecessary-value-param)
-void PipelineWorker(std::stop_token stop_token, const moodycamel::ProducerToken *in_token,
-                    AsyncWorker::InQueuePtr in_queue, AsyncWorker::OutQueuePtr out_queue,
-                    AsyncWorker::VariantStorePtr vstore, AsyncWorker::BuilderParamsPtr params) {
+void PipelineWorker(std::stop_token stop_token, const ThreadPlacement *placement, const usize worker_idx,
+                    AsyncWorker::Stage stage, AsyncWorker::Queues queues, AsyncWorker::VariantStorePtr vstore,
+                    AsyncWorker::BuilderParamsPtr params, AsyncWorker::WindowCachePtr cache) {
   // NOLINTEND(bugprone-easily-swappable-parameters,performance-unnecessary-value-param)
-  // #ifndef LANCET_DEVELOP_MODE
+  // Pin before building the worker, so that the VariantBuilder, its graph and aligner buffers are all
+  // first touched, and hence allocated, on the NUMA node this thread is pinned to
+  placement->PinCurrentThread(worker_idx);
   // NOLINTNEXTLINE(readability-braces-around-statements)
-  // if (ProfilingIsEnabledForAllThreads() != 0) ProfilerRegisterThread();
-  // #endif
-  auto worker =
-      std::make_unique<AsyncWorker>(std::move(in_queue), std::move(out_queue), std::move(vstore), std::move(params));
-  worker->Process(std::move(stop_token), *in_token);
+  if (TraceRecorder::IsEnabled()) TraceRecorder::SetThreadName(WorkerThreadName(stage, worker_idx));
+  CpuProfiler::RegisterCurrentThread();
+
+  auto worker = std::make_unique<AsyncWorker>(stage, std::move(queues), std::move(vstore), std::move(params),
+                                              std::move(cache));
+  worker->Process(std::move(stop_token));
 }
 
 namespace lancet::cli {
 
-PipelineRunner::PipelineRunner(std::shared_ptr<CliParams> params) : mParamsPtr(std::move(params)) {
-  // #ifndef LANCET_DEVELOP_MODE
-  //   setenv("CPUPROFILE_PER_THREAD_TIMERS", "1", 1);
-  //   setenv("CPUPROFILE_FREQUENCY", "10000", 1);
-  //   const auto timestamp = absl::FormatTime("%Y%m%d%ET%H%M%S", absl::Now(), absl::LocalTimeZone());
-  //   const auto fname = fmt::format("Lancet.cpu_profile.{}.bin", timestamp);
-  //   ProfilerStart(fname.c_str());
-  // #endif
-}
+PipelineRunner::PipelineRunner(std::shared_ptr<CliParams> params) : mParamsPtr(std::move(params)) {}
 
 void PipelineRunner::Run() {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!mParamsPtr->mCpuProfile.empty()) CpuProfiler::PrepareEnvironment(mParamsPtr->mCpuProfileHz);
+
   Timer timer;
   static thread_local const auto tid = std::this_thread::get_id();
   LOG_INFO("Using main thread {:#x} to synchronize variant calling pipeline", absl::Hash<std::thread::id>()(tid))
@@ -152,105 +248,401 @@ void PipelineRunner::Run() {
     std::filesystem::create_directories(mParamsPtr->mVariantBuilder.mOutGraphsDir);
   }
 
+  if (!mParamsPtr->mVariantBuilder.mCaptureDir.empty()) {
+    mParamsPtr->mVariantBuilder.mCaptureMinRuntime = absl::Seconds(mParamsPtr->mCaptureMinSecs);
+    std::filesystem::create_directories(mParamsPtr->mVariantBuilder.mCaptureDir);
+  }
+
   mParamsPtr->mOutVcfGz = std::filesystem::absolute(mParamsPtr->mOutVcfGz);
   if (!std::filesystem::exists(mParamsPtr->mOutVcfGz.parent_path())) {
     std::filesystem::create_directories(mParamsPtr->mOutVcfGz.parent_path());
   }
 
+  // Enabled before any worker thread is started, so that workers name their thread in the trace
+  if (!mParamsPtr->mTraceFile.empty()) {
+    TraceRecorder::Enable();
+    TraceRecorder::SetThreadName("main");
+  }
+
+  if (!mParamsPtr->mWindowStats.empty()) {
+    mWindowStats = std::make_unique<WindowStatsWriter>();
+    if (!mWindowStats->Open(mParamsPtr->mWindowStats)) {
+      LOG_CRITICAL("Could not open window stats file: {}", mParamsPtr->mWindowStats.string())
+      std::exit(EXIT_FAILURE);
+    }
+  }
+
+  if (mParamsPtr->mPerfCounters) {
+    const auto reason = PerfCounters::Enable();
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!reason.empty()) LOG_WARN("Hardware performance counters are not available: {}", reason)
+  }
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mParamsPtr->mAllocStats) AllocTracker::Enable();
+
+  const auto is_profiling = StartCpuProfiler();
+  // Shards are planned once per run, and every work ledger block of this process reuses the same plan
+  const auto all_windows = BuildAllWindows(*mParamsPtr);
+  const auto is_sharded = mParamsPtr->mNumShards > 1 || !mParamsPtr->mWorkLedger.empty();
+  const auto shards =
+      is_sharded ? PlanShards(*mParamsPtr, all_windows) : std::vector<core::ShardPlanner::WindowRange>{};
+  usize num_total_windows = 0;
+  if (!mParamsPtr->mWorkLedger.empty()) {
+    num_total_windows = ProcessLedgerBlocks(all_windows, shards);
+  } else if (shards.empty()) {
+    num_total_windows = ProcessShard(WindowShard{.mWindows = all_windows});
+  } else {
+    const auto shard_idx = mParamsPtr->mShardIndex;
+    num_total_windows = ProcessShard(SliceShard(*mParamsPtr, all_windows, shards.at(shard_idx), shard_idx));
+  }
+  if (is_profiling) {
+    CpuProfiler::Stop();
+    LOG_INFO("Wrote CPU profile to {}", mParamsPtr->mCpuProfile.string())
+  }
+  core::LogStageCounterReport();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (AllocTracker::IsEnabled()) LogAllocReport(AllocTracker::TotalUsage());
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mWindowStats != nullptr) mWindowStats->Close();
+  if (TraceRecorder::IsEnabled() && !TraceRecorder::WriteJson(mParamsPtr->mTraceFile)) {
+    LOG_WARN("Could not write trace file: {}", mParamsPtr->mTraceFile.string())
+  }
+
+  const auto total_runtime = absl::FormatDuration(absl::Trunc(timer.Runtime(), absl::Milliseconds(1)));
+  LOG_INFO("Successfully completed processing {} windows | Runtime={}", num_total_windows, total_runtime)
+  std::exit(EXIT_SUCCESS);
+}
+
+auto PipelineRunner::StartCpuProfiler() const -> bool {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mParamsPtr->mCpuProfile.empty()) return false;
+
+  if (!CpuProfiler::IS_SUPPORTED) {
+    LOG_WARN("Ignoring --cpu-profile since this build of Lancet does not include the gperftools CPU profiler")
+    return false;
+  }
+
+  const auto profile_path = std::filesystem::absolute(mParamsPtr->mCpuProfile);
+  if (!CpuProfiler::Start(profile_path)) {
+    LOG_CRITICAL("Could not start CPU profiler with output file: {}", profile_path.string())
+    std::exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("Sampling CPU profile of main and worker threads at {} Hz", mParamsPtr->mCpuProfileHz)
+  return true;
+}
+
+auto PipelineRunner::ProcessShard(WindowShard shard) -> usize {
+  Timer timer;
+  const auto num_total_windows = shard.mWindows.NumTotal();
+
+  const auto checkpoint_path = Checkpoint::PathForOutput(mParamsPtr->mOutVcfGz);
+  const auto resume_from = mParamsPtr->mResume ? LoadCheckpoint(checkpoint_path, num_total_windows) : Checkpoint();
+
   hts::BgzfOstream output_vcf;
-  if (!output_vcf.Open(mParamsPtr->mOutVcfGz, hts::BgzfFormat::VCF)) {
+  const auto &out_path = mParamsPtr->mOutVcfGz;
+  // Outputs of work ledger blocks are stitched into one VCF with a single header, which is only indexed then
+  const auto is_ledger_block = !mParamsPtr->mWorkLedger.empty();
+  const auto out_format = is_ledger_block ? hts::BgzfFormat::UNSPECIFIED : hts::BgzfFormat::VCF;
+  const auto is_vcf_open = mParamsPtr->mResume
+                               ? output_vcf.OpenForAppend(out_path, out_format, resume_from.VcfOffset())
+                               : output_vcf.Open(out_path, out_format);
+  if (!is_vcf_open) {
     LOG_CRITICAL("Could not open output VCF file: {}", mParamsPtr->mOutVcfGz.string())
     std::exit(EXIT_FAILURE);
   }
 
-  output_vcf << BuildVcfHeader(*mParamsPtr);
-  const auto windows = BuildWindows(*mParamsPtr);
-  LOG_INFO("Processing {} window(s) with {} VariantBuilder thread(s)", windows.size(), mParamsPtr->mNumWorkerThreads)
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!mParamsPtr->mResume && !is_ledger_block) output_vcf << BuildVcfHeader(*mParamsPtr);
+  const auto num_threads = mParamsPtr->mNumWorkerThreads;
+  const auto num_io_threads = mParamsPtr->mNumIoThreads;
+  LOG_INFO("Processing {} window(s) with {} VariantBuilder thread(s)", num_total_windows, num_threads)
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (num_io_threads > 0) LOG_INFO("Collecting reads ahead of VariantBuilder threads in {} thread(s)", num_io_threads)
+
+  CompletionTracker done_windows(num_total_windows);
+  for (const auto &[first_done, last_done] : resume_from.DoneRanges()) {
+    for (auto idx = first_done; idx < last_done; ++idx) {
+      done_windows.MarkDone(idx);
+    }
+  }
+
+  const auto num_resumed_windows = done_windows.NumDone();
+  if (mParamsPtr->mResume) {
+    LOG_INFO("Resuming from checkpoint with {} of {} window(s) already done and {} unflushed variant(s)",
+             num_resumed_windows, num_total_windows, resume_from.Variants().size())
+  }
 
-  const auto num_total_windows = windows.size();
-  static absl::FixedArray<bool> done_windows(num_total_windows);
-  done_windows.fill(false);
+  constexpr usize nbuffer_windows = 100;
 
-  const auto send_qptr = std::make_shared<AsyncWorker::InputQueue>(windows.size());
-  const auto recv_qptr = std::make_shared<AsyncWorker::OutputQueue>(windows.size());
+  // Keep only a couple of windows queued per worker, so that most dispatch decisions are made by the
+  // scheduler as late as possible with the runtimes of already processed neighbour windows available.
+  // With a separate I/O stage, this also bounds the hand-off queue to about two collected windows per
+  // assembly thread, which caps the memory held by reads collected ahead of assembly.
+  const auto max_windows_in_flight = (2 * num_threads) + num_io_threads;
+  const auto lookahead_per_thread = core::WindowScheduler::LOOKAHEAD_WINDOWS_PER_THREAD;
+  // Lookahead of at least `nbuffer_windows` keeps the window used as the flush boundary available in the scheduler
+  const auto scheduler_lookahead = std::max(nbuffer_windows, lookahead_per_thread * num_threads);
+  core::WindowScheduler::CostModels cost_models;
+  const auto num_cost_models = std::min(num_threads, core::WindowScheduler::MAX_PREDICTION_THREADS);
+  for (usize idx = 0; idx < std::max(num_cost_models, usize(1)); ++idx) {
+    cost_models.emplace_back(std::make_unique<core::WindowCostModel>(mParamsPtr->mVariantBuilder.mRdCollParams,
+                                                                     mParamsPtr->mVariantBuilder.mGraphParams));
+  }
+  core::WindowScheduler scheduler(std::move(shard.mWindows), std::move(cost_models), scheduler_lookahead);
+
+  const auto num_all_threads = num_threads + num_io_threads;
+  const auto send_qptr = std::make_shared<AsyncWorker::InputQueue>(max_windows_in_flight + num_all_threads);
+  const auto recv_qptr = std::make_shared<AsyncWorker::OutputQueue>(max_windows_in_flight + num_all_threads);
+  const auto handoff_qptr = std::make_shared<AsyncWorker::HandoffQueue>(max_windows_in_flight + num_threads);
   const moodycamel::ProducerToken producer_token(*send_qptr);
+
+  usize num_in_flight = 0;
+  const auto dispatch_windows = [&]() {
+    const auto batch = scheduler.NextBatch(max_windows_in_flight - num_in_flight, done_windows);
+    num_in_flight += batch.size();
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstringop-overflow"
-  send_qptr->enqueue_bulk(producer_token, windows.begin(), windows.size());
+    send_qptr->enqueue_bulk(producer_token, batch.begin(), batch.size());
 #pragma GCC diagnostic pop
+  };
+
+  dispatch_windows();
 
   std::vector<std::jthread> worker_threads;
-  worker_threads.reserve(mParamsPtr->mNumWorkerThreads);
+  worker_threads.reserve(num_all_threads);
   const auto varstore = std::make_shared<core::VariantStore>();
+  varstore->SetOutputRange(shard.mOwnedStart, shard.mOwnedEnd);
+  RestoreVariants(resume_from, *varstore);
   const auto vb_params = std::make_shared<const core::VariantBuilder::Params>(mParamsPtr->mVariantBuilder);
-  for (usize idx = 0; idx < mParamsPtr->mNumWorkerThreads; ++idx) {
-    worker_threads.emplace_back(PipelineWorker, &producer_token, send_qptr, recv_qptr, varstore, vb_params);
+  const auto window_cache = MakeWindowCache(*mParamsPtr);
+  const auto pin_policy = ThreadPlacement::ParsePolicy(mParamsPtr->mPinThreads).value_or(ThreadPlacement::Policy::NONE);
+  const ThreadPlacement placement(pin_policy);
+  const AsyncWorker::Queues worker_queues{.mInput = send_qptr, .mHandoff = handoff_qptr, .mOutput = recv_qptr};
+  const auto compute_stage = num_io_threads > 0 ? AsyncWorker::Stage::ASSEMBLY : AsyncWorker::Stage::FULL;
+  for (usize idx = 0; idx < num_all_threads; ++idx) {
+    const auto stage = idx < num_io_threads ? AsyncWorker::Stage::READS : compute_stage;
+    worker_threads.emplace_back(PipelineWorker, &placement, idx, stage, worker_queues, varstore, vb_params,
+                                window_cache);
   }
 
-  static const auto all_windows_upto_idx_done = [](const usize window_idx) -> bool {
-    const auto *last_itr = window_idx >= done_windows.size() ? done_windows.cend() : done_windows.cbegin() + window_idx;
-    return std::all_of(done_windows.cbegin(), last_itr, [](const bool is_window_done) { return is_window_done; });
-  };
-
-  static const auto percent_done = [&num_total_windows](const usize ndone) -> f64 {
+  const auto percent_done = [&num_total_windows](const usize ndone) -> f64 {
     return 100.0 * (static_cast<f64>(ndone) / static_cast<f64>(num_total_windows));
   };
 
-  usize idx_to_flush = 0;
-  usize num_completed = 0;
   core::AsyncWorker::Result async_worker_result;
   moodycamel::ConsumerToken result_consumer_token(*recv_qptr);
 
   auto stats = InitWindowStats();
-  constexpr usize nbuffer_windows = 100;
-  EtaTimer eta_timer(num_total_windows);
-
-  while (num_completed != num_total_windows) {
-    if (!recv_qptr->try_dequeue(result_consumer_token, async_worker_result)) {
-      using namespace std::chrono_literals;
-      std::this_thread::sleep_for(1s);
-      continue;
-    }
+  core::WindowTimingStats timing_stats;
+  EtaTimer eta_timer(num_total_windows - num_resumed_windows);
+  Timer checkpoint_timer;
+  const auto checkpoint_interval = absl::Seconds(mParamsPtr->mCheckpointSecs);
+
+  Timer metrics_timer;
+  const auto metrics_interval = absl::Seconds(mParamsPtr->mMetricsSecs);
+  const auto write_metrics = [&]() {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mParamsPtr->mMetricsFile.empty()) return;
+    const MetricsExporter::Progress progress{
+        .mNumTotalWindows = num_total_windows,
+        .mNumDoneWindows = done_windows.NumDone(),
+        .mWindowsPerSecond = eta_timer.RatePerSecond(),
+        .mEta = eta_timer.EstimatedEta(),
+        .mElapsed = timer.Runtime(),
+        .mNumStoredVariants = varstore->NumVariants(),
+        .mResidentBytes = MetricsExporter::CurrentResidentBytes(),
+    };
+    const auto status = MetricsExporter(mParamsPtr->mMetricsFile).Write(progress, stats, timing_stats);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!status.ok()) LOG_WARN("Could not write metrics: {}", status.message())
+    metrics_timer.Reset();
+  };
 
-    num_completed++;
+  while (!done_windows.IsAllDone()) {
+    TraceScope wait_trace("WAIT_RESULTS");
+    recv_qptr->wait_dequeue(result_consumer_token, async_worker_result);
+    wait_trace.End();
     stats.at(async_worker_result.mStatus) += 1;
-    done_windows[async_worker_result.mGenomeIdx] = true;
-    const core::WindowPtr &curr_win = windows[async_worker_result.mGenomeIdx];
+    timing_stats.Add(async_worker_result.mTimings);
+
+    // Window is looked up before the next batch is dispatched, since finishing a gap window can move the done
+    // frontier far past the lookahead, e.g. after resuming with fewer threads, which drops the window
+    const core::WindowPtr curr_win = scheduler.WindowAt(async_worker_result.mGenomeIdx);
     const auto win_name = curr_win->ToSamtoolsRegion();
     const auto win_status = core::ToString(async_worker_result.mStatus);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mWindowStats != nullptr) mWindowStats->Write(*curr_win, async_worker_result);
+
+    // Deferred windows are not done yet, since the scheduler queues them for a retry with reduced effort
+    const auto is_deferred = async_worker_result.mStatus == VariantBuilder::StatusCode::DEFERRED_OVER_BUDGET;
+    const auto frontier_moved = !is_deferred && done_windows.MarkDone(async_worker_result.mGenomeIdx);
+    scheduler.MarkDone(async_worker_result);
+    num_in_flight--;
+    dispatch_windows();
 
-    eta_timer.Increment();
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!is_deferred) eta_timer.Increment();
     const auto elapsed_rt = absl::FormatDuration(absl::Trunc(timer.Runtime(), absl::Seconds(1)));
     const auto rem_rt = absl::FormatDuration(absl::Trunc(eta_timer.EstimatedEta(), absl::Seconds(1)));
     const auto win_rt = absl::FormatDuration(absl::Trunc(async_worker_result.mRuntime, absl::Microseconds(100)));
 
     LOG_INFO("Progress: {:>8.4f}% | Elapsed: {} | ETA: {} @ {:.2f}/s | {} done with {} in {}",
-             percent_done(num_completed), elapsed_rt, rem_rt, eta_timer.RatePerSecond(), win_name, win_status, win_rt)
+             percent_done(done_windows.NumDone()), elapsed_rt, rem_rt, eta_timer.RatePerSecond(), win_name, win_status,
+             win_rt)
+
+    // Flush only when the done frontier moves. Variants before the window `nbuffer_windows` behind the
+    // frontier cannot be updated by any pending window anymore, so one flush covers all of them at once
+    if (frontier_moved && done_windows.Frontier() > nbuffer_windows) {
+      const TraceScope flush_trace("FLUSH_VARIANTS");
+      const auto &flush_boundary = scheduler.WindowBehindFrontier(nbuffer_windows, done_windows);
+      varstore->FlushVariantsBeforeWindow(*flush_boundary, output_vcf);
+    }
 
-    if (all_windows_upto_idx_done(idx_to_flush + nbuffer_windows)) {
-      varstore->FlushVariantsBeforeWindow(*windows[idx_to_flush], output_vcf);
-      idx_to_flush++;
+    if (mParamsPtr->mCheckpointSecs > 0 && checkpoint_timer.Runtime() >= checkpoint_interval) {
+      const TraceScope checkpoint_trace("CHECKPOINT");
+      // Workers add variants to the store before reporting the window as done, so snapshotting the done
+      // windows before the store guarantees that every done window has its variants in the checkpoint
+      auto done_ranges = done_windows.DoneRanges();
+      auto unflushed_variants = varstore->SerializeUnflushed();
+      // Output VCF is synced to disk before the checkpoint is written, so the checkpoint never gets ahead of it
+      const auto vcf_offset = output_vcf.FlushBlock();
+      if (vcf_offset < 0) {
+        LOG_WARN("Could not sync output VCF to disk, skipping checkpoint")
+      } else {
+        const Checkpoint checkpoint(num_total_windows, vcf_offset, std::move(done_ranges),
+                                    std::move(unflushed_variants));
+        const auto status = checkpoint.Write(checkpoint_path);
+        // NOLINTNEXTLINE(readability-braces-around-statements)
+        if (!status.ok()) LOG_WARN("Could not write checkpoint: {}", status.message())
+      }
+      checkpoint_timer.Reset();
     }
+
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (metrics_timer.Runtime() >= metrics_interval) write_metrics();
   }
 
+  // Wake up all parked workers with one nullptr shutdown window each, so they quit without waiting on a timeout.
+  // Workers of the assembly stage park on the hand-off queue, so their shutdown windows are sent there.
+  const auto num_handoff_workers = compute_stage == AsyncWorker::Stage::ASSEMBLY ? num_threads : 0;
+  const std::vector<core::WindowPtr> shutdown_signals(worker_threads.size() - num_handoff_workers, nullptr);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+  send_qptr->enqueue_bulk(producer_token, shutdown_signals.begin(), shutdown_signals.size());
+#pragma GCC diagnostic pop
+  for (usize idx = 0; idx < num_handoff_workers; ++idx) {
+    handoff_qptr->enqueue(AsyncWorker::CollectedWindow{});
+  }
   std::ranges::for_each(worker_threads, std::mem_fn(&std::jthread::request_stop));
   std::ranges::for_each(worker_threads, std::mem_fn(&std::jthread::join));
 
-  // #ifndef LANCET_DEVELOP_MODE
-  //   ProfilerStop();
-  //   ProfilerFlush();
-  // #endif
-
   varstore->FlushAllVariantsInStore(output_vcf);
   output_vcf.Close();
 
+  // Output VCF is complete, so a stale checkpoint must not be resumed from anymore
+  std::error_code remove_err;
+  std::filesystem::remove(checkpoint_path, remove_err);
+
+  // Last metrics of the shard show all windows as done, with the variant store flushed
+  write_metrics();
   LogWindowStats(stats);
-  const auto total_runtime = absl::FormatDuration(absl::Trunc(timer.Runtime(), absl::Milliseconds(1)));
-  LOG_INFO("Successfully completed processing {} windows | Runtime={}", num_total_windows, total_runtime)
-  std::exit(EXIT_SUCCESS);
+  timing_stats.LogReport();
+  scheduler.LogPredictionReport();
+  return num_total_windows;
+}
+
+auto PipelineRunner::ProcessLedgerBlocks(const core::WindowGenerator &all_windows,
+                                         const std::vector<core::ShardPlanner::WindowRange> &blocks) -> usize {
+  const auto final_out_path = mParamsPtr->mOutVcfGz;
+  const auto num_blocks = blocks.size();
+  WorkLedger ledger(std::filesystem::absolute(mParamsPtr->mWorkLedger), num_blocks);
+  const auto exit_on_error = [&ledger](const absl::Status &status) {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (status.ok()) return;
+    LOG_CRITICAL("Could not update work ledger as {}: {}", ledger.OwnerId(), status.message())
+    std::exit(EXIT_FAILURE);
+  };
+
+  usize num_done_windows = 0;
+  while (true) {
+    const auto claimed = ledger.ClaimNextBlock();
+    exit_on_error(claimed.status());
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!claimed->has_value()) break;
+
+    // Blocks are shards of the same run, so every block is processed exactly like `--shard-index` would process it.
+    // A checkpoint left behind by a crashed process that claimed the block before is resumed from.
+    const auto block_idx = claimed->value();
+    mParamsPtr->mOutVcfGz = WorkLedger::PartialPath(final_out_path, block_idx);
+    mParamsPtr->mResume = std::filesystem::exists(Checkpoint::PathForOutput(mParamsPtr->mOutVcfGz));
+    LOG_INFO("Claimed block {} of {} from work ledger {}", block_idx, num_blocks, mParamsPtr->mWorkLedger.string())
+
+    num_done_windows += ProcessShard(SliceShard(*mParamsPtr, all_windows, blocks[block_idx], block_idx));
+    exit_on_error(ledger.MarkDone(block_idx));
+  }
+
+  // Any process may stitch once every block is done, so a crashed stitching process is replaced by the next one
+  mParamsPtr->mOutVcfGz = final_out_path;
+  mParamsPtr->mResume = false;
+  const auto claimed_stitch = ledger.ClaimStitch();
+  exit_on_error(claimed_stitch.status());
+  if (claimed_stitch.value() && !std::filesystem::exists(final_out_path)) {
+    StitchLedgerBlocks(num_blocks);
+    return num_done_windows;
+  }
+
+  LOG_INFO("No blocks left to claim in work ledger {}. Output VCF is written by the process stitching the blocks",
+           mParamsPtr->mWorkLedger.string())
+  return num_done_windows;
+}
+
+void PipelineRunner::StitchLedgerBlocks(const usize num_blocks) const {
+  const auto &out_path = mParamsPtr->mOutVcfGz;
+  auto tmp_path = out_path;
+  tmp_path += ".tmp";
+
+  {
+    hts::BgzfOstream header_vcf;
+    if (!header_vcf.Open(tmp_path)) {
+      LOG_CRITICAL("Could not open output VCF file: {}", tmp_path.string())
+      std::exit(EXIT_FAILURE);
+    }
+    header_vcf << BuildVcfHeader(*mParamsPtr);
+  }
+
+  // Concatenated BGZF files are a valid BGZF file, so block outputs are appended without recompressing them
+  std::ofstream out_handle(tmp_path, std::ios_base::binary | std::ios_base::app);
+  for (usize block_idx = 0; block_idx < num_blocks; ++block_idx) {
+    const auto block_path = WorkLedger::PartialPath(out_path, block_idx);
+    std::ifstream block_handle(block_path, std::ios_base::binary);
+    if (!block_handle) {
+      LOG_CRITICAL("Could not open output of work ledger block {}: {}", block_idx, block_path.string())
+      std::exit(EXIT_FAILURE);
+    }
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (block_handle.peek() != std::ifstream::traits_type::eof()) out_handle << block_handle.rdbuf();
+  }
+
+  out_handle.close();
+  std::error_code err_code;
+  std::filesystem::rename(tmp_path, out_path, err_code);
+  if (!out_handle || err_code) {
+    LOG_CRITICAL("Could not write stitched output VCF file: {}", out_path.string())
+    std::exit(EXIT_FAILURE);
+  }
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!hts::BgzfOstream::BuildIndex(out_path, hts::BgzfFormat::VCF)) LOG_WARN("Could not index {}", out_path.string())
+  for (usize block_idx = 0; block_idx < num_blocks; ++block_idx) {
+    std::filesystem::remove(WorkLedger::PartialPath(out_path, block_idx), err_code);
+  }
+
+  LOG_INFO("Stitched outputs of {} work ledger blocks into {}", num_blocks, out_path.string())
 }
 
-auto PipelineRunner::BuildWindows(const CliParams &params) -> std::vector<core::WindowPtr> {
+auto PipelineRunner::BuildAllWindows(const CliParams &params) -> core::WindowGenerator {
   core::WindowBuilder window_builder(params.mVariantBuilder.mRdCollParams.mRefPath, params.mWindowBuilder);
   window_builder.AddBatchRegions(absl::MakeConstSpan(params.mInRegions));
   window_builder.AddBatchRegions(params.mBedFile);
@@ -260,7 +652,51 @@ auto PipelineRunner::BuildWindows(const CliParams &params) -> std::vector<core::
     window_builder.AddAllReferenceRegions();
   }
 
-  return window_builder.BuildWindows();
+  return window_builder.MakeGenerator();
+}
+
+auto PipelineRunner::PlanShards(const CliParams &params, const core::WindowGenerator &all_windows)
+    -> std::vector<core::ShardPlanner::WindowRange> {
+  const core::WindowCostModel cost_model(params.mVariantBuilder.mRdCollParams, params.mVariantBuilder.mGraphParams);
+  const core::ShardPlanner planner(all_windows, cost_model);
+  return planner.Partition(params.mNumShards);
+}
+
+auto PipelineRunner::SliceShard(const CliParams &params, const core::WindowGenerator &all_windows,
+                                const core::ShardPlanner::WindowRange &owned, const usize shard_idx) -> WindowShard {
+  const auto [first, last] = owned;
+  const auto num_all_windows = all_windows.NumTotal();
+
+  WindowShard result;
+  if (first == last) {
+    LOG_WARN("Shard {} of {} has no windows to process", shard_idx, params.mNumShards)
+    result.mOwnedEnd = result.mOwnedStart;
+    return result;
+  }
+
+  // Windows just outside the owned range overlap the owned edge windows, so they are evaluated as
+  // well to find the same variants an unsharded run would. Only owned range variants are written out.
+  const auto window_len = static_cast<f64>(params.mWindowBuilder.mWindowLength);
+  const auto step_size = static_cast<f64>(core::WindowBuilder::StepSize(params.mWindowBuilder));
+  const auto num_halo_windows = static_cast<usize>(std::ceil(window_len / step_size)) + 1;
+  const auto halo_first = first > num_halo_windows ? first - num_halo_windows : 0;
+  const auto halo_last = std::min(num_all_windows, last + num_halo_windows);
+
+  const auto window_at = [&all_windows](const usize genome_idx) -> core::WindowPtr {
+    return all_windows.Slice(genome_idx, genome_idx + 1).Next();
+  };
+
+  // NOLINTBEGIN(readability-braces-around-statements)
+  if (first > 0) result.mOwnedStart = {window_at(first)->ChromIndex(), window_at(first)->StartPos1()};
+  if (last < num_all_windows) result.mOwnedEnd = {window_at(last)->ChromIndex(), window_at(last)->StartPos1()};
+  // NOLINTEND(readability-braces-around-statements)
+
+  result.mWindows = all_windows.Slice(halo_first, halo_last);
+
+  const auto num_halo = (first - halo_first) + (halo_last - last);
+  LOG_INFO("Shard {} of {} owns windows {}-{} of {} and evaluates {} extra overlapping window(s) at its edges",
+           shard_idx, params.mNumShards, first, last, num_all_windows, num_halo)
+  return result;
 }
 
 auto PipelineRunner::BuildVcfHeader(const CliParams &params) -> std::string {
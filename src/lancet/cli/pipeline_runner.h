@@ -3,8 +3,13 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "lancet/cli/cli_params.h"
+#include "lancet/cli/window_stats_writer.h"
+#include "lancet/core/shard_planner.h"
+#include "lancet/core/variant_store.h"
+#include "lancet/core/window_generator.h"
 
 namespace lancet::cli {
 
@@ -16,8 +21,35 @@ class PipelineRunner {
 
  private:
   std::shared_ptr<CliParams> mParamsPtr;
-
-  [[nodiscard]] static auto BuildWindows(const CliParams& params) -> std::vector<core::WindowPtr>;
+  // Only set with `--window-stats`. Rows of all shards processed by this run go to the same table.
+  std::unique_ptr<WindowStatsWriter> mWindowStats;
+
+  struct WindowShard {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    core::WindowGenerator mWindows;
+    core::VariantStore::GenomePosition mOwnedStart = core::VariantStore::GENOME_START;
+    core::VariantStore::GenomePosition mOwnedEnd = core::VariantStore::GENOME_END;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  // Processes the windows of one shard into the output VCF and returns the number of windows in the shard
+  [[nodiscard]] auto ProcessShard(WindowShard shard) -> usize;
+
+  // Claims blocks from the work ledger until none is left, processing each block as a shard into a partial
+  // output. Once every block is done, the first process to claim stitching writes the output VCF from the
+  // partial outputs. Windows are planned into blocks only once, and shared by all blocks of the process.
+  [[nodiscard]] auto ProcessLedgerBlocks(const core::WindowGenerator& all_windows,
+                                         const std::vector<core::ShardPlanner::WindowRange>& blocks) -> usize;
+  void StitchLedgerBlocks(usize num_blocks) const;
+
+  // Starts the CPU profiler if `--cpu-profile` is set. Returns true if the profiler was started.
+  [[nodiscard]] auto StartCpuProfiler() const -> bool;
+
+  [[nodiscard]] static auto BuildAllWindows(const CliParams& params) -> core::WindowGenerator;
+  [[nodiscard]] static auto PlanShards(const CliParams& params, const core::WindowGenerator& all_windows)
+      -> std::vector<core::ShardPlanner::WindowRange>;
+  [[nodiscard]] static auto SliceShard(const CliParams& params, const core::WindowGenerator& all_windows,
+                                       const core::ShardPlanner::WindowRange& owned, usize shard_idx) -> WindowShard;
   [[nodiscard]] static auto BuildVcfHeader(const CliParams& params) -> std::string;
 
   void ValidateAndPopulateParams();
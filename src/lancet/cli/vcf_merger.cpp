@@ -0,0 +1,226 @@
+#include "lancet/cli/vcf_merger.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "htslib/bgzf.h"
+#include "lancet/base/types.h"
+#include "lancet/hts/bgzf_ostream.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+constexpr std::string_view CONTIG_PREFIX = "##contig=<ID=";
+constexpr std::string_view COLUMNS_PREFIX = "#CHROM";
+
+}  // namespace
+
+namespace lancet::cli {
+
+auto VcfMerger::Merge() -> absl::StatusOr<usize> {
+  const auto open_status = OpenInputs();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!open_status.ok()) return open_status;
+
+  hts::BgzfOstream output_vcf;
+  if (!output_vcf.Open(mParams.mOutVcfGz, hts::BgzfFormat::VCF)) {
+    const auto msg = fmt::format("Could not open output VCF file: {}", mParams.mOutVcfGz.string());
+    return absl::Status(absl::StatusCode::kUnavailable, msg);
+  }
+
+  for (const auto& line : mCursors.front().mHeaderLines) {
+    output_vcf << line << '\n';
+  }
+
+  std::vector<usize> heap;
+  heap.reserve(mCursors.size());
+  const auto heap_order = [this](const usize lhs, const usize rhs) -> bool { return IsBefore(rhs, lhs); };
+  const auto advance_cursor = [this, &heap, &heap_order](const usize cursor_idx) -> absl::Status {
+    auto status = Advance(mCursors[cursor_idx]);
+    if (status.ok() && mCursors[cursor_idx].mHasRecord) {
+      heap.push_back(cursor_idx);
+      std::ranges::push_heap(heap, heap_order);
+    }
+    return status;
+  };
+
+  for (usize idx = 0; idx < mCursors.size(); ++idx) {
+    const auto status = advance_cursor(idx);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!status.ok()) return status;
+  }
+
+  usize num_written = 0;
+  while (!heap.empty()) {
+    std::ranges::pop_heap(heap, heap_order);
+    const auto first_idx = heap.back();
+    heap.pop_back();
+
+    // Kept record is copied, since the cursor record is still needed to check that the input is sorted
+    auto kept = mCursors[first_idx].mRecord;
+    auto status = advance_cursor(first_idx);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!status.ok()) return status;
+
+    while (!heap.empty() && mCursors[heap.front()].mRecord.Key() == kept.Key()) {
+      std::ranges::pop_heap(heap, heap_order);
+      const auto dup_idx = heap.back();
+      heap.pop_back();
+
+      const auto& other = mCursors[dup_idx].mRecord;
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (kept.mTotalCoverage < other.mTotalCoverage && kept.mQuality < other.mQuality) kept = other;
+
+      status = advance_cursor(dup_idx);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!status.ok()) return status;
+    }
+
+    output_vcf << kept.mLine << '\n';
+    num_written++;
+  }
+
+  output_vcf.Close();
+  return num_written;
+}
+
+auto VcfMerger::OpenInputs() -> absl::Status {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mParams.mInVcfs.empty()) return absl::Status(absl::StatusCode::kInvalidArgument, "No input VCFs to merge");
+
+  mCursors.clear();
+  mCursors.reserve(mParams.mInVcfs.size());
+  for (const auto& in_path : mParams.mInVcfs) {
+    auto& cursor = mCursors.emplace_back();
+    cursor.mPath = in_path;
+    cursor.mHandle.reset(bgzf_open(in_path.c_str(), "r"));
+    if (cursor.mHandle == nullptr) {
+      return absl::Status(absl::StatusCode::kNotFound, fmt::format("Could not open input VCF {}", in_path.string()));
+    }
+
+    while (bgzf_getline(cursor.mHandle.get(), '\n', &mLineBuffer) >= 0) {
+      const std::string_view line(ks_str(&mLineBuffer), ks_len(&mLineBuffer));
+      if (!absl::StartsWith(line, "#")) {
+        return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Missing #CHROM line in {}", in_path.string()));
+      }
+
+      cursor.mHeaderLines.emplace_back(line);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (absl::StartsWith(line, COLUMNS_PREFIX)) break;
+
+      // Chromosomes are ordered as in the contig header lines, which is the reference order Lancet writes in
+      if (absl::StartsWith(line, CONTIG_PREFIX)) {
+        const std::string_view contig_id = line.substr(CONTIG_PREFIX.length(), line.find_first_of(",>") -
+                                                                                   CONTIG_PREFIX.length());
+        mChromIndices.try_emplace(std::string(contig_id), mChromIndices.size());
+      }
+    }
+
+    if (cursor.mHeaderLines.empty() || !absl::StartsWith(cursor.mHeaderLines.back(), COLUMNS_PREFIX)) {
+      return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Missing #CHROM line in {}", in_path.string()));
+    }
+
+    if (cursor.mHeaderLines.back() != mCursors.front().mHeaderLines.back()) {
+      const auto msg = fmt::format("Samples in {} differ from samples in {}", in_path.string(),
+                                   mCursors.front().mPath.string());
+      return absl::Status(absl::StatusCode::kFailedPrecondition, msg);
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+auto VcfMerger::Advance(InputCursor& cursor) -> absl::Status {
+  while (true) {
+    const auto nread = bgzf_getline(cursor.mHandle.get(), '\n', &mLineBuffer);
+    if (nread == -1) {
+      cursor.mHasRecord = false;
+      return absl::OkStatus();
+    }
+
+    if (nread < -1) {
+      return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Could not read from {}", cursor.mPath.string()));
+    }
+
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (nread > 0) break;
+  }
+
+  auto record = ParseRecord(cursor);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!record.ok()) return record.status();
+
+  if (cursor.mHasRecord && record->Key() < cursor.mRecord.Key()) {
+    const auto msg = fmt::format("Input VCF {} is not sorted at {}:{}", cursor.mPath.string(),
+                                 record->mLine.substr(0, record->mLine.find('\t')), record->mStartPos1);
+    return absl::Status(absl::StatusCode::kFailedPrecondition, msg);
+  }
+
+  cursor.mRecord = std::move(record).value();
+  cursor.mHasRecord = true;
+  return absl::OkStatus();
+}
+
+auto VcfMerger::ParseRecord(const InputCursor& cursor) const -> absl::StatusOr<Record> {
+  static constexpr usize MIN_NUM_COLUMNS = 10;
+  static constexpr usize FORMAT_COLUMN_IDX = 8;
+
+  Record result;
+  result.mLine.assign(mLineBuffer.s, mLineBuffer.l);
+  const std::vector<std::string_view> columns = absl::StrSplit(result.mLine, '\t');
+  const auto parse_error = [&cursor, &result]() -> absl::Status {
+    const auto msg = fmt::format("Invalid VCF record in {}: {}", cursor.mPath.string(), result.mLine);
+    return absl::Status(absl::StatusCode::kDataLoss, msg);
+  };
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (columns.size() < MIN_NUM_COLUMNS || !absl::SimpleAtoi(columns[1], &result.mStartPos1)) return parse_error();
+
+  const auto chrom_itr = mChromIndices.find(columns[0]);
+  if (chrom_itr == mChromIndices.end()) {
+    const auto msg = fmt::format("Chromosome {} in {} has no contig header line", columns[0], cursor.mPath.string());
+    return absl::Status(absl::StatusCode::kDataLoss, msg);
+  }
+
+  result.mChromIndex = chrom_itr->second;
+  result.mRefAllele = columns[3];
+  result.mAltAllele = columns[4];
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (columns[5] != "." && !absl::SimpleAtod(columns[5], &result.mQuality)) return parse_error();
+
+  // Total coverage of a variant is the sum of its per sample DP values
+  const std::vector<std::string_view> format_keys = absl::StrSplit(columns[FORMAT_COLUMN_IDX], ':');
+  const auto dp_itr = std::ranges::find(format_keys, "DP");
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (dp_itr == format_keys.end()) return result;
+
+  const auto dp_idx = static_cast<usize>(std::distance(format_keys.begin(), dp_itr));
+  for (usize col_idx = FORMAT_COLUMN_IDX + 1; col_idx < columns.size(); ++col_idx) {
+    const std::vector<std::string_view> sample_values = absl::StrSplit(columns[col_idx], ':');
+    u64 sample_cov = 0;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (dp_idx < sample_values.size() && absl::SimpleAtoi(sample_values[dp_idx], &sample_cov)) {
+      result.mTotalCoverage += sample_cov;
+    }
+  }
+
+  return result;
+}
+
+auto VcfMerger::IsBefore(const usize lhs_cursor, const usize rhs_cursor) const -> bool {
+  const auto lhs_key = mCursors[lhs_cursor].mRecord.Key();
+  const auto rhs_key = mCursors[rhs_cursor].mRecord.Key();
+  // Records of the same variant are merged in the order their inputs were given
+  return lhs_key != rhs_key ? lhs_key < rhs_key : lhs_cursor < rhs_cursor;
+}
+
+}  // namespace lancet::cli
@@ -0,0 +1,92 @@
+#ifndef SRC_LANCET_CLI_VCF_MERGER_H_
+#define SRC_LANCET_CLI_VCF_MERGER_H_
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "htslib/bgzf.h"
+#include "htslib/kstring.h"
+#include "lancet/base/types.h"
+
+namespace lancet::cli {
+
+namespace detail {
+
+struct BgzfDeleter {
+  void operator()(BGZF* handle) noexcept { bgzf_close(handle); }
+};
+
+}  // namespace detail
+
+// Merges coordinate sorted Lancet VCFs from overlapping or adjacent regions into one indexed VCF. Inputs
+// are streamed with a k-way merge, so memory use depends only on the number of inputs. Records of the
+// same variant found in several inputs are deduplicated with the rule `VariantStore::AddVariants` uses
+// for overlapping windows: a later record replaces the kept one only if it has both higher total
+// coverage and higher quality. Inputs are considered in the order they were given for ties.
+class VcfMerger {
+ public:
+  struct Params {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    std::vector<std::filesystem::path> mInVcfs;
+    std::filesystem::path mOutVcfGz;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  explicit VcfMerger(Params params) : mParams(std::move(params)) {}
+  ~VcfMerger() { ks_free(&mLineBuffer); }
+
+  VcfMerger(const VcfMerger&) = delete;
+  VcfMerger(VcfMerger&&) = delete;
+  auto operator=(const VcfMerger&) -> VcfMerger& = delete;
+  auto operator=(VcfMerger&&) -> VcfMerger& = delete;
+
+  // Returns the number of records written, after deduplication
+  [[nodiscard]] auto Merge() -> absl::StatusOr<usize>;
+
+ private:
+  using ChromIndexMap = absl::flat_hash_map<std::string, usize>;
+
+  struct Record {
+    std::string mLine;
+    std::string mRefAllele;
+    std::string mAltAllele;
+    usize mChromIndex = 0;
+    u64 mStartPos1 = 0;
+    u64 mTotalCoverage = 0;
+    f64 mQuality = 0.0;
+
+    // Same identity as the variant hash used by VariantStore, and the same order Lancet writes records in
+    [[nodiscard]] auto Key() const -> std::tuple<usize, u64, const std::string&, const std::string&> {
+      return {mChromIndex, mStartPos1, mRefAllele, mAltAllele};
+    }
+  };
+
+  struct InputCursor {
+    std::filesystem::path mPath;
+    std::unique_ptr<BGZF, detail::BgzfDeleter> mHandle;
+    std::vector<std::string> mHeaderLines;
+    Record mRecord;
+    bool mHasRecord = false;
+  };
+
+  Params mParams;
+  ChromIndexMap mChromIndices;
+  std::vector<InputCursor> mCursors;
+  kstring_t mLineBuffer = KS_INITIALIZE;
+
+  [[nodiscard]] auto OpenInputs() -> absl::Status;
+  [[nodiscard]] auto Advance(InputCursor& cursor) -> absl::Status;
+  [[nodiscard]] auto ParseRecord(const InputCursor& cursor) const -> absl::StatusOr<Record>;
+  [[nodiscard]] auto IsBefore(usize lhs_cursor, usize rhs_cursor) const -> bool;
+};
+
+}  // namespace lancet::cli
+
+#endif  // SRC_LANCET_CLI_VCF_MERGER_H_
@@ -0,0 +1,96 @@
+#include "lancet/cli/window_stats_writer.h"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "lancet/base/alloc_tracker.h"
+#include "lancet/base/types.h"
+#include "lancet/cbdg/graph.h"
+#include "lancet/core/async_worker.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+constexpr std::string_view TABLE_HEADER =
+    "#region\tstatus\truntime_us\treads_collected\treads_sampled\tkmer_attempts\tfinal_k\tnodes_built\tedges_built\t"
+    "nodes_pruned\tedges_pruned\tnum_components\tnum_haplotypes\tmsa_width\tnum_variants\talloc_counts\t"
+    "alloc_bytes\talloc_peak_bytes\n";
+
+// Lists are comma separated, and fields of windows that did not reach a stage are written as `.`
+constexpr std::string_view MISSING_FIELD = ".";
+
+// Comma separated `SUBSYSTEM:value` list of subsystems that allocated, which is empty without `--alloc-stats`
+[[nodiscard]] auto AllocField(const AllocTracker::Usage& usage, u64 AllocTracker::Counts::* field) -> std::string {
+  std::string result;
+  for (usize idx = 0; idx < AllocTracker::NUM_SUBSYSTEMS; ++idx) {
+    const auto& counts = usage.at(idx);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (counts.mNumAllocs == 0) continue;
+    const auto subsystem = AllocTracker::ToString(static_cast<AllocTracker::Subsystem>(idx));
+    absl::StrAppend(&result, result.empty() ? "" : ",", subsystem, ":", counts.*field);
+  }
+  return result.empty() ? std::string(MISSING_FIELD) : result;
+}
+
+}  // namespace
+
+namespace lancet::cli {
+
+auto WindowStatsWriter::Open(const std::filesystem::path& path) -> bool {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!mOutStream.Open(path)) return false;
+  mOutStream << TABLE_HEADER;
+  return true;
+}
+
+void WindowStatsWriter::Write(const core::Window& window, const core::AsyncWorker::Result& result) {
+  using SampleReads = core::VariantBuilder::Telemetry::SampleReads;
+  const auto& telemetry = result.mTelemetry;
+
+  std::string reads_collected(MISSING_FIELD);
+  std::string reads_sampled(MISSING_FIELD);
+  if (!telemetry.mSampleReads.empty()) {
+    reads_collected = absl::StrJoin(telemetry.mSampleReads, ",", [](std::string* out, const SampleReads& item) {
+      out->append(fmt::format("{}:{}", item.mSampleName, item.mNumCollected));
+    });
+    reads_sampled = absl::StrJoin(telemetry.mSampleReads, ",", [](std::string* out, const SampleReads& item) {
+      out->append(fmt::format("{}:{}", item.mSampleName, item.mNumSampled));
+    });
+  }
+
+  const auto runtime_us = absl::ToInt64Microseconds(result.mRuntime);
+  mOutStream << fmt::format("{}\t{}\t{}\t{}\t{}\t", window.ToSamtoolsRegion(), core::ToString(result.mStatus),
+                            runtime_us, reads_collected, reads_sampled);
+
+  WriteAssemblyFields(telemetry);
+  mOutStream << fmt::format("{}\t{}\t{}\n", AllocField(result.mAllocs, &AllocTracker::Counts::mNumAllocs),
+                            AllocField(result.mAllocs, &AllocTracker::Counts::mNumBytes),
+                            AllocField(result.mAllocs, &AllocTracker::Counts::mPeakBytes));
+}
+
+void WindowStatsWriter::WriteAssemblyFields(const core::VariantBuilder::Telemetry& telemetry) {
+  using KmerAttempt = cbdg::Graph::KmerAttempt;
+  if (telemetry.mKmerAttempts.empty()) {
+    mOutStream << fmt::format("{0}\t{0}\t{0}\t{0}\t{0}\t{0}\t{0}\t{0}\t{0}\t{0}\t", MISSING_FIELD);
+    return;
+  }
+
+  const auto kmer_attempts = absl::StrJoin(telemetry.mKmerAttempts, ",", [](std::string* out, const KmerAttempt& item) {
+    out->append(fmt::format("{}:{}", item.mKmerLen, cbdg::Graph::ToString(item.mOutcome)));
+  });
+
+  // Graph sizes are reported for the last k value tried, which is the one that assembled the window if any did
+  const auto& final_attempt = telemetry.mKmerAttempts.back();
+  mOutStream << fmt::format("{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t", kmer_attempts, final_attempt.mKmerLen,
+                            final_attempt.mNumNodesBuilt, final_attempt.mNumEdgesBuilt, final_attempt.mNumNodesPruned,
+                            final_attempt.mNumEdgesPruned, final_attempt.mNumComponents, telemetry.mNumHaplotypes,
+                            telemetry.mMsaWidth, telemetry.mNumVariants);
+}
+
+}  // namespace lancet::cli
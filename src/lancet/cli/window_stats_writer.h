@@ -0,0 +1,32 @@
+#ifndef SRC_LANCET_CLI_WINDOW_STATS_WRITER_H_
+#define SRC_LANCET_CLI_WINDOW_STATS_WRITER_H_
+
+#include <filesystem>
+
+#include "lancet/core/async_worker.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window.h"
+#include "lancet/hts/bgzf_ostream.h"
+
+namespace lancet::cli {
+
+// Writes the `--window-stats` table, with one tab separated row of read counts, assembly graph complexity
+// and runtime for each processed window. Deferred windows get one row for each time they are processed.
+class WindowStatsWriter {
+ public:
+  WindowStatsWriter() = default;
+
+  [[nodiscard]] auto Open(const std::filesystem::path& path) -> bool;
+  void Write(const core::Window& window, const core::AsyncWorker::Result& result);
+  void Close() { mOutStream.Close(); }
+
+ private:
+  hts::BgzfOstream mOutStream;
+
+  // Writes the assembly graph fields of a row, each followed by a tab
+  void WriteAssemblyFields(const core::VariantBuilder::Telemetry& telemetry);
+};
+
+}  // namespace lancet::cli
+
+#endif  // SRC_LANCET_CLI_WINDOW_STATS_WRITER_H_
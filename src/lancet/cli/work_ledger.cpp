@@ -0,0 +1,216 @@
+#include "lancet/cli/work_ledger.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "lancet/base/types.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+constexpr std::string_view HEADER_LINE = "##lancet_work_ledger=1";
+constexpr std::string_view NUM_BLOCKS_KEY = "NUM_BLOCKS\t";
+constexpr std::string_view CLAIM_KEY = "CLAIM\t";
+constexpr std::string_view DONE_KEY = "DONE\t";
+constexpr std::string_view STITCH_KEY = "STITCH\t";
+
+[[nodiscard]] auto CurrentHostName() -> std::string {
+  static constexpr usize MAX_HOST_NAME_LEN = 256;
+  std::array<char, MAX_HOST_NAME_LEN> buffer{};
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (gethostname(buffer.data(), buffer.size() - 1) != 0) return "localhost";
+  return {buffer.data()};
+}
+
+}  // namespace
+
+namespace lancet::cli {
+
+WorkLedger::WorkLedger(std::filesystem::path path, const usize num_blocks)
+    : mPath(std::move(path)), mNumBlocks(num_blocks), mHostName(CurrentHostName()),
+      mOwnerId(fmt::format("{}\t{}", mHostName, getpid())) {}
+
+auto WorkLedger::ClaimNextBlock() -> absl::StatusOr<std::optional<usize>> {
+  std::optional<usize> result;
+  const auto status = LockedUpdate([this, &result](const LedgerState& ledger) -> std::string {
+    for (usize idx = 0; idx < ledger.mBlocks.size(); ++idx) {
+      const auto& state = ledger.mBlocks[idx];
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (state.mIsDone || (state.mIsClaimed && !IsStaleClaim(state))) continue;
+      result = idx;
+      return fmt::format("{}{}\t{}\n", CLAIM_KEY, idx, mOwnerId);
+    }
+    return {};
+  });
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!status.ok()) return status;
+  return result;
+}
+
+auto WorkLedger::MarkDone(const usize block_idx) -> absl::Status {
+  return LockedUpdate([&block_idx](const LedgerState&) { return fmt::format("{}{}\n", DONE_KEY, block_idx); });
+}
+
+auto WorkLedger::ClaimStitch() -> absl::StatusOr<bool> {
+  bool claimed = false;
+  const auto status = LockedUpdate([this, &claimed](const LedgerState& ledger) -> std::string {
+    const auto all_done = std::ranges::all_of(ledger.mBlocks, [](const BlockState& state) { return state.mIsDone; });
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!all_done || (ledger.mStitch.mIsClaimed && !IsStaleClaim(ledger.mStitch))) return {};
+    claimed = true;
+    return fmt::format("{}{}\n", STITCH_KEY, mOwnerId);
+  });
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!status.ok()) return status;
+  return claimed;
+}
+
+auto WorkLedger::PartialPath(const std::filesystem::path& out_path, const usize block_idx) -> std::filesystem::path {
+  auto result = out_path;
+  result += fmt::format(".block{:05d}.part", block_idx);
+  return result;
+}
+
+template <typename Update>
+auto WorkLedger::LockedUpdate(Update&& update) -> absl::Status {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-signed-bitwise)
+  const int fdesc = open(mPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fdesc < 0) {
+    return absl::Status(absl::StatusCode::kUnavailable, fmt::format("Could not open work ledger {}", mPath.string()));
+  }
+
+  // Closing the file descriptor also releases the lock
+  const absl::Cleanup close_ledger = [fdesc] { close(fdesc); };
+  if (flock(fdesc, LOCK_EX) != 0) {
+    return absl::Status(absl::StatusCode::kUnavailable, fmt::format("Could not lock work ledger {}", mPath.string()));
+  }
+
+  std::string contents;
+  static constexpr usize READ_CHUNK_SIZE = 65536;
+  std::array<char, READ_CHUNK_SIZE> buffer{};
+  lseek(fdesc, 0, SEEK_SET);
+  for (auto nread = read(fdesc, buffer.data(), buffer.size()); nread != 0;
+       nread = read(fdesc, buffer.data(), buffer.size())) {
+    if (nread < 0) {
+      return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Could not read work ledger {}", mPath.string()));
+    }
+    contents.append(buffer.data(), static_cast<usize>(nread));
+  }
+
+  const auto ledger = ParseLedgerState(contents);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!ledger.ok()) return ledger.status();
+
+  auto appended = std::forward<Update>(update)(*ledger);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (contents.empty()) appended = fmt::format("{}\n{}{}\n{}", HEADER_LINE, NUM_BLOCKS_KEY, mNumBlocks, appended);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (appended.empty()) return absl::OkStatus();
+
+  // Ledger updates are only a few bytes, so a single append write is never interleaved with other updates
+  const auto nwritten = write(fdesc, appended.data(), appended.size());
+  if (nwritten != static_cast<ssize_t>(appended.size()) || fdatasync(fdesc) != 0) {
+    return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Could not update work ledger {}", mPath.string()));
+  }
+
+  return absl::OkStatus();
+}
+
+auto WorkLedger::ParseLedgerState(const std::string& contents) const -> absl::StatusOr<LedgerState> {
+  LedgerState results{.mBlocks = std::vector<BlockState>(mNumBlocks), .mStitch = {}};
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (contents.empty()) return results;
+
+  usize line_num = 0;
+  const auto parse_error = [this, &line_num]() -> absl::Status {
+    const auto msg = fmt::format("Could not parse line {} in work ledger {}", line_num, mPath.string());
+    return absl::Status(absl::StatusCode::kDataLoss, msg);
+  };
+
+  for (const std::string_view line : absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+    line_num++;
+    std::string_view entry = line;
+    if (line_num == 1) {
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (line != HEADER_LINE) return parse_error();
+      continue;
+    }
+
+    if (absl::ConsumePrefix(&entry, NUM_BLOCKS_KEY)) {
+      usize num_blocks = 0;
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!absl::SimpleAtoi(entry, &num_blocks)) return parse_error();
+      if (num_blocks != mNumBlocks) {
+        const auto msg = fmt::format("Work ledger {} has {} blocks, but current run has {} blocks. Check that all "
+                                     "processes use the same --num-shards",
+                                     mPath.string(), num_blocks, mNumBlocks);
+        return absl::Status(absl::StatusCode::kFailedPrecondition, msg);
+      }
+      continue;
+    }
+
+    usize block_idx = 0;
+    if (absl::ConsumePrefix(&entry, DONE_KEY)) {
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!absl::SimpleAtoi(entry, &block_idx) || block_idx >= mNumBlocks) return parse_error();
+      results.mBlocks[block_idx].mIsDone = true;
+      continue;
+    }
+
+    if (absl::ConsumePrefix(&entry, STITCH_KEY)) {
+      const std::vector<std::string_view> tokens = absl::StrSplit(entry, '\t');
+      i64 process_id = -1;
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (tokens.size() != 2 || !absl::SimpleAtoi(tokens[1], &process_id)) return parse_error();
+      results.mStitch.mHostName = tokens[0];
+      results.mStitch.mProcessId = process_id;
+      results.mStitch.mIsClaimed = true;
+      continue;
+    }
+
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!absl::ConsumePrefix(&entry, CLAIM_KEY)) return parse_error();
+    const std::vector<std::string_view> tokens = absl::StrSplit(entry, '\t');
+    i64 process_id = -1;
+    const auto is_valid_claim = tokens.size() == 3 && absl::SimpleAtoi(tokens[0], &block_idx) &&
+                                block_idx < mNumBlocks && absl::SimpleAtoi(tokens[2], &process_id);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!is_valid_claim) return parse_error();
+
+    // Later claims of a block replace earlier stale claims
+    results.mBlocks[block_idx].mHostName = tokens[1];
+    results.mBlocks[block_idx].mProcessId = process_id;
+    results.mBlocks[block_idx].mIsClaimed = true;
+  }
+
+  return results;
+}
+
+auto WorkLedger::IsStaleClaim(const BlockState& state) const -> bool {
+  // Liveness can only be checked for processes on the same host, so claims from other hosts are never stale
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (state.mHostName != mHostName || state.mProcessId <= 0) return false;
+  return kill(static_cast<pid_t>(state.mProcessId), 0) != 0 && errno == ESRCH;
+}
+
+}  // namespace lancet::cli
@@ -0,0 +1,69 @@
+#ifndef SRC_LANCET_CLI_WORK_LEDGER_H_
+#define SRC_LANCET_CLI_WORK_LEDGER_H_
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "lancet/base/types.h"
+
+namespace lancet::cli {
+
+// Append-only ledger of work blocks shared by independent processes through a common filesystem.
+// Every update holds an exclusive `flock` on the ledger file, so processes on one host, or on hosts
+// sharing an NFS mount, never claim the same block twice. Claims made by processes on the same host
+// that are no longer running are claimed again, so a crashed process does not leave its block unclaimed.
+// Stitching the block outputs is claimed the same way once every block is done.
+class WorkLedger {
+ public:
+  WorkLedger(std::filesystem::path path, usize num_blocks);
+
+  // Claims the first block that is neither done nor claimed by a running process. Returns nullopt once
+  // no claimable block is left, which includes blocks still being processed by other processes.
+  [[nodiscard]] auto ClaimNextBlock() -> absl::StatusOr<std::optional<usize>>;
+
+  [[nodiscard]] auto MarkDone(usize block_idx) -> absl::Status;
+
+  // Claims stitching of the block outputs. Returns true only once every block is done, and only if no
+  // running process has claimed stitching before, so a crashed stitching process is replaced by the next one.
+  [[nodiscard]] auto ClaimStitch() -> absl::StatusOr<bool>;
+
+  // Partial output file with the variants of one block, next to the final output file
+  [[nodiscard]] static auto PartialPath(const std::filesystem::path& out_path, usize block_idx)
+      -> std::filesystem::path;
+
+  [[nodiscard]] auto NumBlocks() const noexcept -> usize { return mNumBlocks; }
+  [[nodiscard]] auto OwnerId() const noexcept -> const std::string& { return mOwnerId; }
+
+ private:
+  std::filesystem::path mPath;
+  usize mNumBlocks = 0;
+  std::string mHostName;
+  std::string mOwnerId;
+
+  struct BlockState {
+    std::string mHostName;
+    i64 mProcessId = -1;
+    bool mIsClaimed = false;
+    bool mIsDone = false;
+  };
+
+  struct LedgerState {
+    std::vector<BlockState> mBlocks;
+    BlockState mStitch;
+  };
+
+  // Holds the ledger lock while `update` reads the current ledger state and returns lines to append
+  template <typename Update>
+  [[nodiscard]] auto LockedUpdate(Update&& update) -> absl::Status;
+
+  [[nodiscard]] auto ParseLedgerState(const std::string& contents) const -> absl::StatusOr<LedgerState>;
+  [[nodiscard]] auto IsStaleClaim(const BlockState& state) const -> bool;
+};
+
+}  // namespace lancet::cli
+
+#endif  // SRC_LANCET_CLI_WORK_LEDGER_H_
@@ -1,44 +1,166 @@
 #include "lancet/core/async_worker.h"
 
 #include <stop_token>
+#include <string>
+#include <utility>
 
-#include "concurrentqueue.h"
+#include "blockingconcurrentqueue.h"
+#include "lancet/base/alloc_tracker.h"
 #include "lancet/base/logging.h"
 #include "lancet/base/timer.h"
+#include "lancet/base/trace_recorder.h"
 #include "lancet/base/types.h"
 #include "lancet/core/window.h"
 
 namespace lancet::core {
 
 // NOLINTNEXTLINE(performance-unnecessary-value-param)
-void AsyncWorker::Process(std::stop_token stop_token, const moodycamel::ProducerToken& in_token) {
+void AsyncWorker::Process(std::stop_token stop_token) {
   static thread_local const auto tid = absl::Hash<std::thread::id>()(std::this_thread::get_id());
   LOG_DEBUG("Starting AsyncWorker thread {:#x}", tid)
 
-  Timer timer;
   usize num_done = 0;
-  auto window_ptr = std::make_shared<Window>();
-  const moodycamel::ProducerToken out_token(*mOutPtr);
+  switch (mStage) {
+    case Stage::READS:
+      num_done = CollectWindowReads(stop_token);
+      break;
+    case Stage::ASSEMBLY:
+      num_done = AssembleCollectedWindows(stop_token);
+      break;
+    default:
+      num_done = ProcessFullWindows(stop_token);
+      break;
+  }
 
-  while (true) {
-    // Check if stop is requested for this thread by the RunMain/caller thread
-    // NOLINTNEXTLINE(readability-braces-around-statements)
-    if (stop_token.stop_requested()) break;
+  LOG_DEBUG("Quitting AsyncWorker thread {:#x} after processing {} windows", tid, num_done)
+}
 
-    // Get the next available unprocessed window from the RunMain/caller thread
-    // NOLINTNEXTLINE(readability-braces-around-statements)
-    if (!mInPtr->try_dequeue_from_producer(in_token, window_ptr)) continue;
+auto AsyncWorker::ProcessFullWindows(const std::stop_token& stop_token) -> usize {
+  Timer timer;
+  usize num_done = 0;
+  WindowPtr window_ptr = nullptr;
+  moodycamel::ConsumerToken in_token(*mQueues.mInput);
+  const moodycamel::ProducerToken out_token(*mQueues.mOutput);
 
+  // Consumer tokens rotate across the producer sub-queues, so idle workers pick up whatever windows are
+  // still pending instead of spinning on one. nullptr window is the shutdown signal sent by the RunMain thread.
+  while (WaitDequeue(stop_token, *mQueues.mInput, in_token, window_ptr) && window_ptr != nullptr) {
     timer.Reset();
+    const auto region = TraceRegion(*window_ptr);
+    const TraceScope window_trace("WINDOW", region);
+    const AllocSpan window_allocs;
+    if (ServeFromCache(*window_ptr, out_token, timer)) {
+      num_done++;
+      continue;
+    }
+
     auto variants = mBuilderPtr->ProcessWindow(std::const_pointer_cast<const Window>(window_ptr));
-    mStorePtr->AddVariants(std::move(variants));
+    const auto status_code = mBuilderPtr->CurrentStatus();
+    StoreResults(*window_ptr, status_code, std::move(variants));
+    mQueues.mOutput->enqueue(out_token, Result{window_ptr->GenomeIndex(), timer.Runtime(), status_code,
+                                               mBuilderPtr->CurrentTimings(), mBuilderPtr->CurrentTelemetry(),
+                                               window_allocs.Elapsed()});
+    num_done++;
+  }
 
+  return num_done;
+}
+
+auto AsyncWorker::CollectWindowReads(const std::stop_token& stop_token) -> usize {
+  Timer timer;
+  usize num_done = 0;
+  WindowPtr window_ptr = nullptr;
+  moodycamel::ConsumerToken in_token(*mQueues.mInput);
+  const moodycamel::ProducerToken handoff_token(*mQueues.mHandoff);
+  const moodycamel::ProducerToken out_token(*mQueues.mOutput);
+
+  while (WaitDequeue(stop_token, *mQueues.mInput, in_token, window_ptr) && window_ptr != nullptr) {
+    timer.Reset();
+    const auto region = TraceRegion(*window_ptr);
+    const TraceScope window_trace("COLLECT_READS", region);
+    const AllocSpan window_allocs;
+    if (ServeFromCache(*window_ptr, out_token, timer)) {
+      num_done++;
+      continue;
+    }
+
+    auto reads = mBuilderPtr->CollectWindowReads(std::const_pointer_cast<const Window>(window_ptr));
     const auto status_code = mBuilderPtr->CurrentStatus();
-    mOutPtr->enqueue(out_token, Result{window_ptr->GenomeIndex(), timer.Runtime(), status_code});
+
+    // Windows skipped before assembly are reported as done right away, without going through the hand-off
+    if (status_code == VariantBuilder::StatusCode::UNKNOWN) {
+      const auto& timings = mBuilderPtr->CurrentTimings();
+      mQueues.mHandoff->enqueue(handoff_token, CollectedWindow{window_ptr, std::move(reads), timer.Runtime(), timings,
+                                                               window_allocs.Elapsed()});
+    } else {
+      StoreResults(*window_ptr, status_code, {});
+      mQueues.mOutput->enqueue(out_token, Result{window_ptr->GenomeIndex(), timer.Runtime(), status_code,
+                                                 mBuilderPtr->CurrentTimings(), mBuilderPtr->CurrentTelemetry(),
+                                                 window_allocs.Elapsed()});
+    }
+
     num_done++;
   }
 
-  LOG_DEBUG("Quitting AsyncWorker thread {:#x} after processing {} windows", tid, num_done)
+  return num_done;
+}
+
+auto AsyncWorker::AssembleCollectedWindows(const std::stop_token& stop_token) -> usize {
+  Timer timer;
+  usize num_done = 0;
+  CollectedWindow collected;
+  moodycamel::ConsumerToken handoff_token(*mQueues.mHandoff);
+  const moodycamel::ProducerToken out_token(*mQueues.mOutput);
+
+  while (WaitDequeue(stop_token, *mQueues.mHandoff, handoff_token, collected) && collected.mWindow != nullptr) {
+    timer.Reset();
+    const auto window_ptr = std::const_pointer_cast<const Window>(collected.mWindow);
+    const auto region = TraceRegion(*window_ptr);
+    const TraceScope window_trace("ASSEMBLE", region);
+    const AllocSpan window_allocs;
+    auto variants = mBuilderPtr->BuildVariants(window_ptr, collected.mReads);
+    const auto status_code = mBuilderPtr->CurrentStatus();
+    StoreResults(*window_ptr, status_code, std::move(variants));
+
+    // Reported runtime and timings cover both stages, so that the scheduler sees the full cost of the window
+    const auto runtime = collected.mRuntime + timer.Runtime();
+    auto timings = collected.mTimings;
+    timings += mBuilderPtr->CurrentTimings();
+    const auto allocs = AllocTracker::Combine(collected.mAllocs, window_allocs.Elapsed());
+    mQueues.mOutput->enqueue(out_token, Result{window_ptr->GenomeIndex(), runtime, status_code, timings,
+                                               mBuilderPtr->CurrentTelemetry(), allocs});
+    collected = CollectedWindow{};
+    num_done++;
+  }
+
+  return num_done;
+}
+
+auto AsyncWorker::ServeFromCache(const Window& window, const moodycamel::ProducerToken& out_token,
+                                 Timer& timer) -> bool {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mCachePtr == nullptr) return false;
+
+  auto cached = mCachePtr->Lookup(window);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!cached.has_value()) return false;
+
+  LOG_DEBUG("Found {} cached variant(s) for window {}", cached->mVariants.size(), window.ToSamtoolsRegion())
+  mStorePtr->AddVariants(std::move(cached->mVariants));
+  mQueues.mOutput->enqueue(out_token, Result{window.GenomeIndex(), timer.Runtime(), cached->mStatus, {}, {}, {}});
+  return true;
+}
+
+auto AsyncWorker::TraceRegion(const Window& window) -> std::string {
+  return TraceRecorder::IsEnabled() ? window.ToSamtoolsRegion() : std::string();
+}
+
+void AsyncWorker::StoreResults(const Window& window, const VariantBuilder::StatusCode status,
+                               VariantBuilder::WindowResults variants) {
+  // Variants are cached before they are added, since the store takes ownership of them
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mCachePtr != nullptr) mCachePtr->Store(window, status, variants);
+  mStorePtr->AddVariants(std::move(variants));
 }
 
 }  // namespace lancet::core
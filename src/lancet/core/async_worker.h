@@ -1,16 +1,26 @@
 #ifndef SRC_LANCET_CORE_ASYNC_WORKER_H_
 #define SRC_LANCET_CORE_ASYNC_WORKER_H_
 
+#include <chrono>
 #include <memory>
 #include <stop_token>
+#include <string>
+#include <type_traits>
 #include <utility>
 
 #include "absl/time/time.h"
-#include "concurrentqueue.h"
+#include "blockingconcurrentqueue.h"
+#include "lancet/base/alloc_tracker.h"
+#include "lancet/base/timer.h"
+#include "lancet/base/trace_recorder.h"
 #include "lancet/base/types.h"
+#include "lancet/base/wait_stats.h"
+#include "lancet/core/read_collector.h"
 #include "lancet/core/variant_builder.h"
 #include "lancet/core/variant_store.h"
 #include "lancet/core/window.h"
+#include "lancet/core/window_cache.h"
+#include "lancet/core/window_timings.h"
 
 namespace lancet::core {
 
@@ -21,29 +31,92 @@ class AsyncWorker {
     usize mGenomeIdx = 0;
     absl::Duration mRuntime = absl::ZeroDuration();
     VariantBuilder::StatusCode mStatus = VariantBuilder::StatusCode::UNKNOWN;
+    WindowTimings mTimings;
+    VariantBuilder::Telemetry mTelemetry;
+    // Allocations of the worker while processing the window, only counted with `--alloc-stats`
+    AllocTracker::Usage mAllocs{};
     // NOLINTEND(misc-non-private-member-variables-in-classes)
   };
 
-  using InputQueue = moodycamel::ConcurrentQueue<WindowPtr>;
-  using OutputQueue = moodycamel::ConcurrentQueue<Result>;
+  // Window whose reads were collected by a READS stage worker, waiting for an ASSEMBLY stage worker
+  struct CollectedWindow {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    WindowPtr mWindow = nullptr;
+    ReadCollector::Result mReads;
+    absl::Duration mRuntime = absl::ZeroDuration();
+    WindowTimings mTimings;
+    AllocTracker::Usage mAllocs{};
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  // FULL workers process each window from start to end. With a separate I/O pool, READS workers collect
+  // reads for upcoming windows and hand them off to ASSEMBLY workers, so that waiting on alignment file
+  // decoding overlaps with assembly and genotyping of already collected windows.
+  enum class Stage : u8 { FULL, READS, ASSEMBLY };
+
+  // Max time an idle worker stays parked on its input queue before re-checking its stop token. A nullptr
+  // window in the input or hand-off queue is the shutdown signal and wakes up a parked worker immediately.
+  static constexpr auto MAX_IDLE_WAIT = std::chrono::milliseconds(250);
+
+  using InputQueue = moodycamel::BlockingConcurrentQueue<WindowPtr>;
+  using HandoffQueue = moodycamel::BlockingConcurrentQueue<CollectedWindow>;
+  using OutputQueue = moodycamel::BlockingConcurrentQueue<Result>;
 
   using InQueuePtr = std::shared_ptr<InputQueue>;
+  using HandoffQueuePtr = std::shared_ptr<HandoffQueue>;
   using OutQueuePtr = std::shared_ptr<OutputQueue>;
   using VariantStorePtr = std::shared_ptr<VariantStore>;
   using VariantBuilderPtr = std::unique_ptr<VariantBuilder>;
   using BuilderParamsPtr = std::shared_ptr<const VariantBuilder::Params>;
+  using WindowCachePtr = std::shared_ptr<const WindowCache>;
 
-  AsyncWorker(InQueuePtr in_queue, OutQueuePtr out_queue, VariantStorePtr vstore, BuilderParamsPtr prms)
-      : mInPtr(std::move(in_queue)), mOutPtr(std::move(out_queue)), mStorePtr(std::move(vstore)),
-        mBuilderPtr(std::make_unique<VariantBuilder>(std::move(prms))) {}
+  struct Queues {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    InQueuePtr mInput;
+    HandoffQueuePtr mHandoff;
+    OutQueuePtr mOutput;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
 
-  void Process(std::stop_token stop_token, const moodycamel::ProducerToken& in_token);
+  // Windows are served from and stored into `cache` when it is not nullptr
+  AsyncWorker(Stage stage, Queues queues, VariantStorePtr vstore, BuilderParamsPtr prms, WindowCachePtr cache)
+      : mStage(stage), mQueues(std::move(queues)), mStorePtr(std::move(vstore)),
+        mBuilderPtr(std::make_unique<VariantBuilder>(std::move(prms))), mCachePtr(std::move(cache)) {}
+
+  void Process(std::stop_token stop_token);
 
  private:
-  InQueuePtr mInPtr;
-  OutQueuePtr mOutPtr;
+  Stage mStage;
+  Queues mQueues;
   VariantStorePtr mStorePtr;
   VariantBuilderPtr mBuilderPtr;
+  WindowCachePtr mCachePtr;
+
+  [[nodiscard]] auto ProcessFullWindows(const std::stop_token& stop_token) -> usize;
+  [[nodiscard]] auto CollectWindowReads(const std::stop_token& stop_token) -> usize;
+  [[nodiscard]] auto AssembleCollectedWindows(const std::stop_token& stop_token) -> usize;
+
+  // Adds cached variants of `window` to the store and reports the window as done. False if not cached.
+  [[nodiscard]] auto ServeFromCache(const Window& window, const moodycamel::ProducerToken& out_token,
+                                    Timer& timer) -> bool;
+  void StoreResults(const Window& window, VariantBuilder::StatusCode status, VariantBuilder::WindowResults variants);
+
+  // Region of `window` shown with its trace events. Empty when tracing is disabled, to skip formatting it.
+  [[nodiscard]] static auto TraceRegion(const Window& window) -> std::string;
+
+  // Parks on `queue` until the next item is available. Returns false only if stop was requested.
+  template <typename Queue, typename Item>
+  [[nodiscard]] static auto WaitDequeue(const std::stop_token& stop_token, Queue& queue,
+                                        moodycamel::ConsumerToken& token, Item& item) -> bool {
+    const TraceScope wait_trace("QUEUE_WAIT");
+    constexpr auto is_handoff = std::is_same_v<Queue, HandoffQueue>;
+    const WaitScope queue_wait(is_handoff ? WaitStats::Kind::HANDOFF_QUEUE : WaitStats::Kind::INPUT_QUEUE);
+    while (!stop_token.stop_requested()) {
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (queue.wait_dequeue_timed(token, item, MAX_IDLE_WAIT)) return true;
+    }
+    return false;
+  }
 };
 
 }  // namespace lancet::core
@@ -18,6 +18,7 @@
 #include "absl/container/btree_map.h"
 #include "absl/strings/ascii.h"
 #include "absl/types/span.h"
+#include "lancet/base/alloc_tracker.h"
 #include "lancet/base/assert.h"
 #include "lancet/base/types.h"
 #include "lancet/cbdg/label.h"
@@ -98,6 +99,7 @@ ReadCollector::ReadCollector(Params params) : mParams(std::move(params)), mIsGer
 
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
 auto ReadCollector::CollectRegionResult(const Region& region) -> Result {
+  const AllocScope alloc_scope(AllocTracker::Subsystem::READ_COLLECTION);
   std::vector<Read> sampled_reads;
   std::vector<Read> all_reads;
   absl::flat_hash_map<std::string, hts::Alignment::MateInfo> expected_mates;
@@ -198,6 +200,7 @@ auto ReadCollector::CollectRegionResult(const Region& region) -> Result {
     sampled_reads.insert(sampled_reads.end(), all_reads.begin(), read_end_position);
     const auto sampled_base_count = std::accumulate(all_reads.begin(), read_end_position, 0, base_summer);
 
+    sinfo.SetNumCollectedReads(num_total_reads);
     sinfo.SetNumSampledReads(sampled_read_count);
     sinfo.SetNumSampledBases(sampled_base_count);
     sinfo.CalculateMeanSampledCov(region.Length());
@@ -34,6 +34,7 @@ class ReadCollector {
     // NOLINTEND(misc-non-private-member-variables-in-classes)
 
     [[nodiscard]] auto SamplesCount() const -> usize { return mNormalPaths.size() + mTumorPaths.size(); }
+    [[nodiscard]] auto IsGermlineMode() const -> bool { return mTumorPaths.empty(); }
   };
 
   using Read = cbdg::Read;
@@ -23,6 +23,7 @@ class SampleInfo {
   [[nodiscard]] auto FileName() const noexcept -> std::string { return mFilePath.filename().string(); }
   [[nodiscard]] auto TagKind() const noexcept -> cbdg::Label::Tag { return mTag; }
 
+  [[nodiscard]] auto NumCollectedReads() const noexcept -> u64 { return mNumCollectedReads; }
   [[nodiscard]] auto NumSampledReads() const noexcept -> u64 { return mNumSampledReads; }
   [[nodiscard]] auto NumSampledBases() const noexcept -> u64 { return mNumSampledBases; }
   [[nodiscard]] auto MeanTotalCov() const noexcept -> f64 { return mMeanTotalCov; }
@@ -68,6 +69,7 @@ class SampleInfo {
   };
 
  private:
+  u64 mNumCollectedReads = 0;
   u64 mNumSampledReads = 0;
   u64 mNumSampledBases = 0;
   f64 mMeanTotalCov = 0.0;
@@ -79,6 +81,7 @@ class SampleInfo {
   cbdg::Label::Tag mTag = cbdg::Label::REFERENCE;
 
   friend class ReadCollector;
+  void SetNumCollectedReads(const u64 num_reads) { mNumCollectedReads = num_reads; }
   void SetNumSampledReads(const u64 num_reads) { mNumSampledReads = num_reads; }
   void SetNumSampledBases(const u64 num_bases) { mNumSampledBases = num_bases; }
 
@@ -0,0 +1,81 @@
+#include "lancet/core/shard_planner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "lancet/base/types.h"
+#include "lancet/core/window.h"
+#include "lancet/core/window_cost_model.h"
+#include "lancet/core/window_generator.h"
+
+namespace lancet::core {
+
+ShardPlanner::ShardPlanner(WindowGenerator windows, const WindowCostModel& model) : mNumWindows(windows.NumTotal()) {
+  // Only the first and last window of the current block are kept around while walking the windows
+  auto block_first = windows.Next();
+  while (block_first != nullptr) {
+    auto block_last = block_first;
+    usize block_size = 1;
+    auto next_window = windows.Next();
+    while (next_window != nullptr && block_size < WINDOWS_PER_BLOCK &&
+           next_window->ChromIndex() == block_first->ChromIndex()) {
+      block_last = std::move(next_window);
+      block_size++;
+      next_window = windows.Next();
+    }
+
+    mBlockStarts.push_back(block_first->GenomeIndex());
+    mBlockCosts.push_back(model.PredictSpan(*block_first, *block_last, block_size));
+    block_first = std::move(next_window);
+  }
+}
+
+auto ShardPlanner::BlockRange(const usize block_idx) const -> WindowRange {
+  const auto block_end = block_idx + 1 < mBlockStarts.size() ? mBlockStarts[block_idx + 1] : mNumWindows;
+  return {mBlockStarts[block_idx], block_end};
+}
+
+auto ShardPlanner::Partition(const usize num_shards) const -> std::vector<WindowRange> {
+  std::vector<WindowRange> results(num_shards, {mNumWindows, mNumWindows});
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (num_shards == 0 || mBlockCosts.empty()) return results;
+
+  // Fall back to balancing the number of blocks if no block has any predicted cost
+  const auto total_cost = std::accumulate(mBlockCosts.cbegin(), mBlockCosts.cend(), 0.0);
+  const auto block_cost = [&total_cost, this](const usize block_idx) -> f64 {
+    return total_cost > 0.0 ? mBlockCosts[block_idx] : 1.0;
+  };
+  const auto effective_total = total_cost > 0.0 ? total_cost : static_cast<f64>(mBlockCosts.size());
+
+  // Each block goes to the shard that its cost midpoint falls into. Midpoints only increase along the
+  // genome, so every shard gets one contiguous run of blocks.
+  f64 cost_before_block = 0.0;
+  const auto nshards = static_cast<f64>(num_shards);
+  for (usize block_idx = 0; block_idx < mBlockCosts.size(); ++block_idx) {
+    const auto midpoint = cost_before_block + (block_cost(block_idx) / 2.0);
+    const auto raw_shard_idx = static_cast<usize>(std::floor(nshards * midpoint / effective_total));
+    const auto shard_idx = std::min(num_shards - 1, raw_shard_idx);
+    const auto [first, last] = BlockRange(block_idx);
+
+    auto& shard_range = results[shard_idx];
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (shard_range.first == mNumWindows) shard_range.first = first;
+    shard_range.second = last;
+    cost_before_block += block_cost(block_idx);
+  }
+
+  // Empty shards get an empty range placed where they would have started, to keep all ranges ordered
+  for (usize idx = num_shards; idx > 0; --idx) {
+    auto& shard_range = results[idx - 1];
+    const auto next_start = idx < num_shards ? results[idx].first : mNumWindows;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (shard_range.first == mNumWindows && shard_range.second == mNumWindows) shard_range = {next_start, next_start};
+  }
+
+  return results;
+}
+
+}  // namespace lancet::core
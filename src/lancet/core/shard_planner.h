@@ -0,0 +1,41 @@
+#ifndef SRC_LANCET_CORE_SHARD_PLANNER_H_
+#define SRC_LANCET_CORE_SHARD_PLANNER_H_
+
+#include <utility>
+#include <vector>
+
+#include "lancet/base/types.h"
+#include "lancet/core/window_cost_model.h"
+#include "lancet/core/window_generator.h"
+
+namespace lancet::core {
+
+// Splits the genome ordered windows into contiguous blocks of windows with a predicted cost each.
+// Blocks never span chromosomes, and are the unit of work that gets assigned to shards, so that every
+// invocation with the same inputs deterministically computes the same shard boundaries.
+class ShardPlanner {
+ public:
+  static constexpr usize WINDOWS_PER_BLOCK = 1000;
+
+  // Half-open `[first, last)` range of window genome indices
+  using WindowRange = std::pair<usize, usize>;
+
+  ShardPlanner(WindowGenerator windows, const WindowCostModel& model);
+
+  [[nodiscard]] auto NumBlocks() const noexcept -> usize { return mBlockCosts.size(); }
+  [[nodiscard]] auto BlockRange(usize block_idx) const -> WindowRange;
+  [[nodiscard]] auto BlockCost(usize block_idx) const -> f64 { return mBlockCosts.at(block_idx); }
+
+  // Assigns contiguous runs of blocks with roughly equal total cost to each shard. Shards get an
+  // empty range only when there are fewer blocks than shards.
+  [[nodiscard]] auto Partition(usize num_shards) const -> std::vector<WindowRange>;
+
+ private:
+  usize mNumWindows = 0;
+  std::vector<usize> mBlockStarts;
+  std::vector<f64> mBlockCosts;
+};
+
+}  // namespace lancet::core
+
+#endif  // SRC_LANCET_CORE_SHARD_PLANNER_H_
@@ -10,10 +10,15 @@
 #include <vector>
 
 #include "absl/hash/hash.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "lancet/base/alloc_tracker.h"
 #include "lancet/base/logging.h"
+#include "lancet/base/perf_counters.h"
 #include "lancet/base/repeat.h"
 #include "lancet/base/sliding.h"
+#include "lancet/base/timer.h"
+#include "lancet/base/trace_recorder.h"
 #include "lancet/base/types.h"
 #include "lancet/caller/msa_builder.h"
 #include "lancet/caller/variant_call.h"
@@ -21,62 +26,179 @@
 #include "lancet/cbdg/read.h"
 #include "lancet/core/sample_info.h"
 #include "lancet/core/window.h"
+#include "lancet/core/window_capture.h"
+#include "lancet/core/window_timings.h"
 #include "spdlog/fmt/bundled/core.h"
 
+namespace {
+
+using lancet::core::WindowTimings;
+
+// Adds the runtime of each stage to the window timings, records it as a trace event with `--trace-file`
+// and accumulates its hardware counters with `--perf-counters`
+class StageClock {
+ public:
+  explicit StageClock(WindowTimings *timings) : mTimings(timings) { Restart(); }
+
+  void Restart() {
+    mTimer.Reset();
+    mCounters.Restart();
+    mNestedRuntime = absl::ZeroDuration();
+    mNestedCounters = PerfCounters::Values();
+    mTraceStartNs = TraceRecorder::IsEnabled() ? MonotonicNowNs() : -1;
+  }
+
+  // Adds a stage that was measured elsewhere and is nested within the current stage
+  void AddNested(const WindowTimings::Stage stage, const absl::Duration runtime, const PerfCounters::Values &counters) {
+    mTimings->Add(stage, runtime);
+    mNestedRuntime += runtime;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!PerfCounters::IsEnabled()) return;
+    PerfCounters::Accumulate(static_cast<usize>(stage), counters);
+    mNestedCounters += counters;
+  }
+
+  // Nested stages added since the last restart are excluded from `stage`
+  void EndStage(const WindowTimings::Stage stage) {
+    mTimings->Add(stage, mTimer.Runtime() - mNestedRuntime);
+    if (PerfCounters::IsEnabled()) {
+      auto counters = mCounters.Elapsed();
+      counters -= mNestedCounters;
+      PerfCounters::Accumulate(static_cast<usize>(stage), counters);
+    }
+
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mTraceStartNs >= 0) TraceRecorder::Record(StageName(stage), mTraceStartNs, MonotonicNowNs());
+    Restart();
+  }
+
+ private:
+  WindowTimings *mTimings;
+  Timer mTimer;
+  PerfSpan mCounters;
+  absl::Duration mNestedRuntime = absl::ZeroDuration();
+  PerfCounters::Values mNestedCounters;
+  i64 mTraceStartNs = -1;
+};
+
+static_assert(WindowTimings::NUM_STAGES <= PerfCounters::MAX_SLOTS);
+
+}  // namespace
+
 namespace lancet::core {
 
 VariantBuilder::VariantBuilder(std::shared_ptr<const Params> params)
-    : mDebruijnGraph(params->mGraphParams), mReadCollector(params->mRdCollParams), mParamsPtr(std::move(params)) {
+    : mDebruijnGraph(params->mGraphParams),
+      mRetryGraph(MakeRetryGraphParams(params->mGraphParams)),
+      mParamsPtr(std::move(params)) {
   mGenotyper.SetNumSamples(mParamsPtr->mRdCollParams.SamplesCount());
-  mGenotyper.SetIsGermlineMode(mReadCollector.IsGermlineMode());
+  mGenotyper.SetIsGermlineMode(mParamsPtr->mRdCollParams.IsGermlineMode());
 }
 
 auto VariantBuilder::ProcessWindow(const std::shared_ptr<const Window> &window) -> WindowResults {
+  const auto rc_result = CollectWindowReads(window);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mCurrentCode != StatusCode::UNKNOWN) return {};
+
+  const auto collect_timings = mCurrentTimings;
+  auto variants = BuildVariants(window, rc_result);
+  mCurrentTimings += collect_timings;
+  return variants;
+}
+
+auto VariantBuilder::CollectWindowReads(const std::shared_ptr<const Window> &window) -> ReadCollector::Result {
   const auto region = window->AsRegionPtr();
   const auto reg_str = region->ToSamtoolsRegion();
   static thread_local const auto tid = absl::Hash<std::thread::id>()(std::this_thread::get_id());
   LOG_DEBUG("Processing window {} in thread {:#x}", reg_str, tid)
+  mCurrentCode = StatusCode::UNKNOWN;
+  mCurrentTimings.Reset();
+  mCurrentTelemetry = Telemetry{};
 
+  StageClock clock(&mCurrentTimings);
   if (static_cast<usize>(std::ranges::count(window->SeqView(), 'N')) == window->Length()) {
+    clock.EndStage(WindowTimings::Stage::REPEAT_CHECK);
     LOG_DEBUG("Skipping window {} since it has only N bases in reference", reg_str)
     mCurrentCode = StatusCode::SKIPPED_NONLY_REF_BASES;
     return {};
   }
 
-  if (HasExactRepeat(SlidingView(window->SeqView(), mParamsPtr->mGraphParams.mMaxKmerLen))) {
+  const auto has_ref_repeat = HasExactRepeat(SlidingView(window->SeqView(), mParamsPtr->mGraphParams.mMaxKmerLen));
+  clock.EndStage(WindowTimings::Stage::REPEAT_CHECK);
+  if (has_ref_repeat) {
     LOG_DEBUG("Skipping window {} since reference has repeat {}-mers", reg_str, mParamsPtr->mGraphParams.mMaxKmerLen)
     mCurrentCode = StatusCode::SKIPPED_REF_REPEAT_SEEN;
     return {};
   }
 
   const auto &rc_params = mParamsPtr->mRdCollParams;
-  if (!mParamsPtr->mSkipActiveRegion && !ReadCollector::IsActiveRegion(rc_params, *region)) {
+  const auto is_active = mParamsPtr->mSkipActiveRegion || ReadCollector::IsActiveRegion(rc_params, *region);
+  clock.EndStage(WindowTimings::Stage::ACTIVE_REGION);
+  if (!is_active) {
     LOG_DEBUG("Skipping window {} since it has no evidence of mutation in any sample", reg_str)
     mCurrentCode = StatusCode::SKIPPED_INACTIVE_REGION;
     return {};
   }
 
-  LOG_DEBUG("Collecting all available sample reads for window {}", reg_str)
-  const auto rc_result = mReadCollector.CollectRegionResult(*region);
-  const absl::Span<const cbdg::Read> reads = absl::MakeConstSpan(rc_result.mSampleReads);
-  const absl::Span<const SampleInfo> samples = absl::MakeConstSpan(rc_result.mSampleList);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mReadCollector == nullptr) mReadCollector = std::make_unique<ReadCollector>(rc_params);
 
-  const auto total_cov = SampleInfo::CombinedSampledCov(samples, window->Length());
+  LOG_DEBUG("Collecting all available sample reads for window {}", reg_str)
+  auto rc_result = mReadCollector->CollectRegionResult(*region);
+  const auto total_cov = SampleInfo::CombinedSampledCov(absl::MakeConstSpan(rc_result.mSampleList), window->Length());
+  clock.EndStage(WindowTimings::Stage::READ_COLLECTION);
+  SetSampleReads(absl::MakeConstSpan(rc_result.mSampleList));
   if (total_cov < static_cast<f64>(mParamsPtr->mGraphParams.mMinAnchorCov)) {
     LOG_DEBUG("Skipping window {} since it has only {:.2f}x total sample coverage", reg_str, total_cov)
     mCurrentCode = StatusCode::SKIPPED_INACTIVE_REGION;
     return {};
   }
 
+  return rc_result;
+}
+
+auto VariantBuilder::BuildVariants(const std::shared_ptr<const Window> &window, const ReadCollector::Result &rc_result)
+    -> WindowResults {
+  Timer timer;
+  auto variants = AssembleAndGenotype(window, rc_result);
+  if (!mParamsPtr->mCaptureDir.empty() && timer.Runtime() >= mParamsPtr->mCaptureMinRuntime) {
+    CaptureWindow(*window, rc_result);
+  }
+  return variants;
+}
+
+auto VariantBuilder::AssembleAndGenotype(const std::shared_ptr<const Window> &window,
+                                         const ReadCollector::Result &rc_result) -> WindowResults {
+  const auto reg_str = window->ToSamtoolsRegion();
+  const absl::Span<const cbdg::Read> reads = absl::MakeConstSpan(rc_result.mSampleReads);
+  const absl::Span<const SampleInfo> samples = absl::MakeConstSpan(rc_result.mSampleList);
+  const auto total_cov = SampleInfo::CombinedSampledCov(samples, window->Length());
+  mCurrentTimings.Reset();
+  mCurrentTelemetry = Telemetry{};
+  SetSampleReads(samples);
+
+  StageClock clock(&mCurrentTimings);
   LOG_DEBUG("Building graph for {} with {} sample reads and {:.2f}x total coverage", reg_str, reads.size(), total_cov)
   // First haplotype from each component will always be the reference haplotype sequence for the graph
-  const auto dbg_rslt = mDebruijnGraph.BuildComponentHaplotypes(window->AsRegionPtr(), reads);
+  auto &graph = window->IsRetry() ? mRetryGraph : mDebruijnGraph;
+  const auto dbg_rslt = graph.BuildComponentHaplotypes(window->AsRegionPtr(), reads);
   const auto &component_haplotypes = dbg_rslt.mGraphHaplotypes;
+  // Path enumeration is timed inside the graph, so the rest of the graph runtime is spent building and pruning it
+  clock.AddNested(WindowTimings::Stage::PATH_TRAVERSAL, dbg_rslt.mTraversalRuntime, dbg_rslt.mTraversalCounters);
+  clock.EndStage(WindowTimings::Stage::GRAPH_BUILD);
+  mCurrentTelemetry.mKmerAttempts = dbg_rslt.mKmerAttempts;
+
+  if (dbg_rslt.mIsOverBudget) {
+    LOG_DEBUG("Deferring window {} since graph traversals exceeded the budget with k={}", reg_str, graph.CurrentK())
+    mCurrentCode = StatusCode::DEFERRED_OVER_BUDGET;
+    return {};
+  }
 
   static const auto summer = [](const u64 sum, const auto &comp_haps) -> u64 { return sum + comp_haps.size() - 1; };
   const auto num_asm_haps = std::accumulate(component_haplotypes.cbegin(), component_haplotypes.cend(), 0, summer);
+  mCurrentTelemetry.mNumHaplotypes = static_cast<usize>(num_asm_haps);
   if (num_asm_haps == 0) {
-    LOG_DEBUG("Could not assemble any haplotypes for window {} with k={}", reg_str, mDebruijnGraph.CurrentK())
+    LOG_DEBUG("Could not assemble any haplotypes for window {} with k={}", reg_str, graph.CurrentK())
     mCurrentCode = StatusCode::SKIPPED_NOASM_HAPLOTYPE;
     return {};
   }
@@ -89,8 +211,12 @@ auto VariantBuilder::ProcessWindow(const std::shared_ptr<const Window> &window)
     LOG_DEBUG("Building MSA for graph component {} from window {} with {} haplotypes", idx, reg_str, nhaps)
 
     const absl::Span<const std::string> ref_and_alt_haps = absl::MakeConstSpan(comp_haps);
+    clock.Restart();
     const caller::MsaBuilder msa_builder(ref_and_alt_haps, MakeGfaPath(*window, idx));
+    clock.EndStage(WindowTimings::Stage::MSA_BUILD);
+    mCurrentTelemetry.mMsaWidth = std::max(mCurrentTelemetry.mMsaWidth, msa_builder.MsaWidth());
     const caller::VariantSet vset(msa_builder, *window, anchor_start);
+    clock.EndStage(WindowTimings::Stage::VARIANT_SET);
 
     if (vset.IsEmpty()) {
       LOG_DEBUG("No variants found in graph component {} for window {} with {} haplotypes", idx, reg_str, nhaps)
@@ -98,10 +224,14 @@ auto VariantBuilder::ProcessWindow(const std::shared_ptr<const Window> &window)
     }
 
     LOG_DEBUG("Found variant(s) in graph component {} for window {} with {} haplotypes", idx, reg_str, nhaps)
-    for (auto &&[variant, evidence] : mGenotyper.Genotype(ref_and_alt_haps, reads, vset)) {
+    auto genotyped = mGenotyper.Genotype(ref_and_alt_haps, reads, vset);
+    clock.EndStage(WindowTimings::Stage::GENOTYPE);
+    const AllocScope alloc_scope(AllocTracker::Subsystem::VARIANT_CALL);
+    for (auto &&[variant, evidence] : genotyped) {
       variants.emplace_back(
-          std::make_unique<caller::VariantCall>(variant, std::move(evidence), samples, mDebruijnGraph.CurrentK()));
+          std::make_unique<caller::VariantCall>(variant, std::move(evidence), samples, graph.CurrentK()));
     }
+    clock.EndStage(WindowTimings::Stage::VARIANT_FORMAT);
   }
 
   if (variants.empty()) {
@@ -111,10 +241,39 @@ auto VariantBuilder::ProcessWindow(const std::shared_ptr<const Window> &window)
   }
 
   mCurrentCode = StatusCode::FOUND_GENOTYPED_VARIANT;
+  mCurrentTelemetry.mNumVariants = variants.size();
   LOG_DEBUG("Genotyped {} variant(s) for window {} by re-aligning sample reads", variants.size(), reg_str)
   return variants;
 }
 
+void VariantBuilder::CaptureWindow(const Window &window, const ReadCollector::Result &rc_result) const {
+  // Retried windows are captured with the graph parameters they were actually assembled with
+  const auto &params = mParamsPtr->mGraphParams;
+  const WindowCapture capture(window, window.IsRetry() ? MakeRetryGraphParams(params) : params, rc_result);
+  const auto suffix = window.IsRetry() ? "_retry" : "";
+  const auto fname = fmt::format("{}_{}_{}{}.txt.gz", window.ChromName(), window.StartPos1(), window.EndPos1(), suffix);
+  const auto status = capture.Write(mParamsPtr->mCaptureDir / fname);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!status.ok()) LOG_WARN("Could not capture window {}: {}", window.ToSamtoolsRegion(), status.message())
+}
+
+auto VariantBuilder::MakeRetryGraphParams(cbdg::Graph::Params params) -> cbdg::Graph::Params {
+  // Retries try every other k value of the regular k-mer range, without any budget, so that they always finish
+  params.mKmerStepLen = static_cast<u16>(params.mKmerStepLen * 2);
+  params.mWindowVisitBudget = 0;
+  return params;
+}
+
+void VariantBuilder::SetSampleReads(absl::Span<const SampleInfo> samples) {
+  mCurrentTelemetry.mSampleReads.clear();
+  mCurrentTelemetry.mSampleReads.reserve(samples.size());
+  for (const auto &sinfo : samples) {
+    mCurrentTelemetry.mSampleReads.push_back(Telemetry::SampleReads{.mSampleName = std::string(sinfo.SampleName()),
+                                                                    .mNumCollected = sinfo.NumCollectedReads(),
+                                                                    .mNumSampled = sinfo.NumSampledReads()});
+  }
+}
+
 auto VariantBuilder::MakeGfaPath(const Window &win, const usize comp_id) const -> std::filesystem::path {
   // NOLINTNEXTLINE(readability-braces-around-statements)
   if (mParamsPtr->mOutGraphsDir.empty()) return {};
@@ -126,6 +285,7 @@ auto VariantBuilder::MakeGfaPath(const Window &win, const usize comp_id) const -
 }
 
 auto ToString(const VariantBuilder::StatusCode status_code) -> std::string {
+  using VariantBuilder::StatusCode::DEFERRED_OVER_BUDGET;
   using VariantBuilder::StatusCode::FOUND_GENOTYPED_VARIANT;
   using VariantBuilder::StatusCode::MISSING_NO_MSA_VARIANTS;
   using VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION;
@@ -146,6 +306,8 @@ auto ToString(const VariantBuilder::StatusCode status_code) -> std::string {
       return "MISSING_NO_MSA_VARIANTS";
     case FOUND_GENOTYPED_VARIANT:
       return "FOUND_GENOTYPED_VARIANT";
+    case DEFERRED_OVER_BUDGET:
+      return "DEFERRED_OVER_BUDGET";
     default:
       break;
   }
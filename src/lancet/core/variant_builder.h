@@ -6,12 +6,16 @@
 #include <string>
 #include <vector>
 
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "lancet/base/types.h"
 #include "lancet/caller/genotyper.h"
 #include "lancet/caller/variant_call.h"
 #include "lancet/cbdg/graph.h"
 #include "lancet/core/read_collector.h"
+#include "lancet/core/sample_info.h"
 #include "lancet/core/window.h"
+#include "lancet/core/window_timings.h"
 
 namespace lancet::core {
 
@@ -23,6 +27,9 @@ class VariantBuilder {
   struct Params {
     bool mSkipActiveRegion = false;
     std::filesystem::path mOutGraphsDir;
+    // Inputs of windows whose assembly takes at least `mCaptureMinRuntime` are written to `mCaptureDir`
+    std::filesystem::path mCaptureDir;
+    absl::Duration mCaptureMinRuntime = absl::ZeroDuration();
 
     cbdg::Graph::Params mGraphParams;
     ReadCollector::Params mRdCollParams;
@@ -38,21 +45,63 @@ class VariantBuilder {
     SKIPPED_INACTIVE_REGION = 3,
     SKIPPED_NOASM_HAPLOTYPE = 4,
     MISSING_NO_MSA_VARIANTS = 5,
-    FOUND_GENOTYPED_VARIANT = 6
+    FOUND_GENOTYPED_VARIANT = 6,
+    DEFERRED_OVER_BUDGET = 7
+  };
+
+  // Read counts and assembly graph complexity of one window, reported in the `--window-stats` table
+  struct Telemetry {
+    struct SampleReads {
+      std::string mSampleName;
+      u64 mNumCollected = 0;
+      u64 mNumSampled = 0;
+    };
+
+    std::vector<SampleReads> mSampleReads;
+    std::vector<cbdg::Graph::KmerAttempt> mKmerAttempts;
+    usize mNumHaplotypes = 0;
+    usize mMsaWidth = 0;
+    usize mNumVariants = 0;
   };
 
   [[nodiscard]] auto CurrentStatus() const noexcept -> StatusCode { return mCurrentCode; }
+  // Telemetry of the last window. Set by both `CollectWindowReads` and `BuildVariants`, since the latter
+  // may run in a different builder than the one that collected the reads.
+  [[nodiscard]] auto CurrentTelemetry() const noexcept -> const Telemetry& { return mCurrentTelemetry; }
+  // Stage timings of the last call to `ProcessWindow`, `CollectWindowReads` or `BuildVariants`
+  [[nodiscard]] auto CurrentTimings() const noexcept -> const WindowTimings& { return mCurrentTimings; }
 
   using WindowResults = std::vector<std::unique_ptr<caller::VariantCall>>;
   [[nodiscard]] auto ProcessWindow(const std::shared_ptr<const Window>& window) -> WindowResults;
 
+  // I/O bound first half of `ProcessWindow`, which only reads the reference and the alignment files.
+  // Current status is set to a skip code if the window needs no assembly, otherwise it is left UNKNOWN.
+  [[nodiscard]] auto CollectWindowReads(const std::shared_ptr<const Window>& window) -> ReadCollector::Result;
+
+  // CPU bound second half of `ProcessWindow`, which assembles, aligns and genotypes the collected reads.
+  // Current status is set to DEFERRED_OVER_BUDGET if assembly exceeded the window visit budget, so that
+  // the window can be retried later. Retried windows use a reduced k-mer range and no budget.
+  [[nodiscard]] auto BuildVariants(const std::shared_ptr<const Window>& window, const ReadCollector::Result& rc_result)
+      -> WindowResults;
+
  private:
   cbdg::Graph mDebruijnGraph;
-  ReadCollector mReadCollector;
+  cbdg::Graph mRetryGraph;
+  // Alignment files are only opened by the first call to `CollectWindowReads`, so that builders used
+  // only for assembly in a separate compute stage never open them
+  std::unique_ptr<ReadCollector> mReadCollector;
   caller::Genotyper mGenotyper;
   std::shared_ptr<const Params> mParamsPtr;
   StatusCode mCurrentCode = StatusCode::UNKNOWN;
+  WindowTimings mCurrentTimings;
+  Telemetry mCurrentTelemetry;
+
+  [[nodiscard]] auto AssembleAndGenotype(const std::shared_ptr<const Window>& window,
+                                         const ReadCollector::Result& rc_result) -> WindowResults;
+  void CaptureWindow(const Window& window, const ReadCollector::Result& rc_result) const;
 
+  [[nodiscard]] static auto MakeRetryGraphParams(cbdg::Graph::Params params) -> cbdg::Graph::Params;
+  void SetSampleReads(absl::Span<const SampleInfo> samples);
   [[nodiscard]] auto MakeGfaPath(const Window& win, usize comp_id) const -> std::filesystem::path;
 };
 
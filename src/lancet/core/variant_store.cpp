@@ -1,14 +1,19 @@
 #include "lancet/core/variant_store.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <ostream>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "lancet/base/alloc_tracker.h"
 #include "lancet/base/logging.h"
+#include "lancet/base/trace_recorder.h"
+#include "lancet/base/wait_stats.h"
 #include "lancet/caller/raw_variant.h"
 #include "spdlog/fmt/bundled/ostream.h"
 #include "spdlog/fmt/ostr.h"
@@ -16,11 +21,23 @@
 
 namespace lancet::core {
 
+void VariantStore::SetOutputRange(const GenomePosition &start, const GenomePosition &end) {
+  const absl::MutexLock lock(&mMutex);
+  mOutputStart = start;
+  mOutputEnd = end;
+}
+
 void VariantStore::AddVariants(std::vector<Value> &&variants) {
   // NOLINTNEXTLINE(readability-braces-around-statements)
   if (variants.empty()) return;
 
+  const AllocScope alloc_scope(AllocTracker::Subsystem::VARIANT_STORE);
+  // Lock waits show up in the trace, so that contention between workers adding variants is visible
+  TraceScope lock_trace("STORE_LOCK_WAIT");
+  WaitScope lock_wait(WaitStats::Kind::STORE_LOCK);
   const absl::MutexLock lock(&mMutex);
+  lock_wait.End();
+  lock_trace.End();
   for (auto &&curr : variants) {
     const auto identifier = curr->Identifier();
     auto prev = mData.find(identifier);
@@ -37,13 +54,23 @@ void VariantStore::AddVariants(std::vector<Value> &&variants) {
 }
 
 void VariantStore::FlushVariantsBeforeWindow(const Window &win, std::ostream &out) {
+  const AllocScope alloc_scope(AllocTracker::Subsystem::VARIANT_STORE);
+  TraceScope lock_trace("STORE_LOCK_WAIT");
+  WaitScope lock_wait(WaitStats::Kind::STORE_LOCK);
   const absl::MutexLock lock(&mMutex);
+  lock_wait.End();
+  lock_trace.End();
+  // Workers adding variants wait on the mutex for as long as the flush holds it
+  const WaitScope flush_wait(WaitStats::Kind::FLUSH);
   const auto variant_keys_to_extract = KeysBeforeWindow(win);
   ExtractKeysAndDumpToStream(absl::MakeConstSpan(variant_keys_to_extract), out);
 }
 
 void VariantStore::FlushAllVariantsInStore(std::ostream &out) {
+  const AllocScope alloc_scope(AllocTracker::Subsystem::VARIANT_STORE);
+  TraceScope lock_trace("STORE_LOCK_WAIT");
   const absl::MutexLock lock(&mMutex);
+  lock_trace.End();
   std::vector<Key> variant_keys_to_extract;
   variant_keys_to_extract.reserve(mData.size());
 
@@ -53,6 +80,25 @@ void VariantStore::FlushAllVariantsInStore(std::ostream &out) {
   ExtractKeysAndDumpToStream(absl::MakeConstSpan(variant_keys_to_extract), out);
 }
 
+auto VariantStore::NumVariants() -> usize {
+  const absl::MutexLock lock(&mMutex);
+  return mData.size();
+}
+
+auto VariantStore::SerializeUnflushed() -> std::vector<std::string> {
+  const AllocScope alloc_scope(AllocTracker::Subsystem::VARIANT_STORE);
+  const absl::MutexLock lock(&mMutex);
+  std::vector<const caller::VariantCall *> variants;
+  variants.reserve(mData.size());
+  std::ranges::transform(mData, std::back_inserter(variants), [](const Item &item) { return item.second.get(); });
+  std::ranges::sort(variants, [](const auto *lhs, const auto *rhs) -> bool { return *lhs < *rhs; });
+
+  std::vector<std::string> results;
+  results.reserve(variants.size());
+  std::ranges::transform(variants, std::back_inserter(results), std::mem_fn(&caller::VariantCall::Serialize));
+  return results;
+}
+
 auto VariantStore::KeysBeforeWindow(const Window &win) const -> std::vector<Key> {
   std::vector<Key> results;
   results.reserve(mData.size());
@@ -76,10 +122,15 @@ void VariantStore::ExtractKeysAndDumpToStream(absl::Span<const Key> keys, std::o
   using caller::RawVariant::State::NONE;
   using caller::RawVariant::Type::REF;
   static const auto has_no_support = [](const Value &item) { return item->Category() == REF || item->State() == NONE; };
-  std::ranges::for_each(keys, [&variants, this](const Key &key) {
+  const auto is_outside_range = [&out_start = mOutputStart, &out_end = mOutputEnd](const Value &item) -> bool {
+    const auto position = GenomePosition{item->ChromIndex(), item->StartPos1()};
+    return position < out_start || position >= out_end;
+  };
+
+  std::ranges::for_each(keys, [&variants, &is_outside_range, this](const Key &key) {
     auto handle = this->mData.extract(key);
     // NOLINTNEXTLINE(readability-braces-around-statements)
-    if (handle.empty() || has_no_support(handle.mapped())) return;
+    if (handle.empty() || has_no_support(handle.mapped()) || is_outside_range(handle.mapped())) return;
     variants.emplace_back(std::move(handle.mapped()));
   });
 
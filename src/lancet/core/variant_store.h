@@ -2,7 +2,9 @@
 #define SRC_LANCET_CORE_VARIANT_STORE_H_
 
 #include <iosfwd>
+#include <limits>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -10,6 +12,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "lancet/base/types.h"
 #include "lancet/caller/variant_call.h"
 #include "lancet/core/window.h"
 
@@ -21,15 +24,32 @@ class VariantStore {
   using Value = std::unique_ptr<caller::VariantCall>;
   using Item = std::pair<const Key, Value>;
 
+  // Chromosome index and 1-based start position of a variant in the genome
+  using GenomePosition = std::pair<usize, usize>;
+  static constexpr auto GENOME_START = GenomePosition{0, 0};
+  static constexpr auto GENOME_END =
+      GenomePosition{std::numeric_limits<usize>::max(), std::numeric_limits<usize>::max()};
+
   VariantStore() = default;
 
+  // Only variants starting in the half-open `[start, end)` range are written out, others are dropped when flushed
+  void SetOutputRange(const GenomePosition& start, const GenomePosition& end) ABSL_LOCKS_EXCLUDED(mMutex);
+
   void AddVariants(std::vector<Value>&& variants) ABSL_LOCKS_EXCLUDED(mMutex);
   void FlushVariantsBeforeWindow(const Window& win, std::ostream& out) ABSL_LOCKS_EXCLUDED(mMutex);
   void FlushAllVariantsInStore(std::ostream& out) ABSL_LOCKS_EXCLUDED(mMutex);
 
+  // Serialized copies of all variants not yet flushed, in genome order. Restore them with `AddVariants`
+  [[nodiscard]] auto SerializeUnflushed() -> std::vector<std::string> ABSL_LOCKS_EXCLUDED(mMutex);
+
+  // Number of variants added and not yet flushed
+  [[nodiscard]] auto NumVariants() -> usize ABSL_LOCKS_EXCLUDED(mMutex);
+
  private:
   absl::Mutex mMutex;
   absl::flat_hash_map<Key, Value> mData ABSL_GUARDED_BY(mMutex);
+  GenomePosition mOutputStart ABSL_GUARDED_BY(mMutex) = GENOME_START;
+  GenomePosition mOutputEnd ABSL_GUARDED_BY(mMutex) = GENOME_END;
 
   [[nodiscard]] ABSL_SHARED_LOCKS_REQUIRED(mMutex) auto KeysBeforeWindow(const Window& win) const -> std::vector<Key>;
   void ExtractKeysAndDumpToStream(absl::Span<const Key> keys, std::ostream& out) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mMutex);
@@ -23,12 +23,20 @@ class Window {
   Window() = default;
   Window(RegSpec reg_spec, Chrom chrom, RefPath ref_path)
       : mSpec(std::move(reg_spec)), mChrom(std::move(chrom)), mRefPath(std::move(ref_path)) {}
+  // Window with an already built sequence, which never reads the reference. Used to replay captured windows.
+  Window(RegSpec reg_spec, Chrom chrom, RegionPtr region)
+      : mChrom(std::move(chrom)), mSpec(std::move(reg_spec)), mRegPtr(std::move(region)) {}
 
   void SetGenomeIndex(const usize window_index) { mGenIdx = window_index; }
 
+  // Set before a window that exceeded its assembly budget is dispatched again with reduced assembly effort
+  void MarkAsRetry() { mIsRetry = true; }
+  [[nodiscard]] auto IsRetry() const -> bool { return mIsRetry; }
+
   [[nodiscard]] auto GenomeIndex() const -> usize { return mGenIdx; }
   [[nodiscard]] auto ChromIndex() const -> usize { return mChrom.Index(); }
   [[nodiscard]] auto ChromName() const -> std::string { return mChrom.Name(); }
+  [[nodiscard]] auto ChromLength() const -> u64 { return mChrom.Length(); }
   [[nodiscard]] auto StartPos1() const -> u64 { return mSpec.mRegionSpan[0].value_or(1); }
   [[nodiscard]] auto EndPos1() const -> u64 { return mSpec.mRegionSpan[1].value_or(mChrom.Length()); }
   [[nodiscard]] auto Length() const -> usize { return mSpec.Length() != 0 ? mSpec.Length() : mChrom.Length(); }
@@ -54,8 +62,16 @@ class Window {
     return mRegPtr;
   }
 
+  // Build the window sequence from an already open reference, instead of opening the reference just for this window
+  void EnsureRegionBuilt(const hts::Reference& reference) const {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (mRegPtr != nullptr || mSpec.mChromName.empty()) return;
+    mRegPtr = std::make_shared<const hts::Reference::Region>(reference.MakeRegion(mSpec));
+  }
+
  private:
   usize mGenIdx = 0;
+  bool mIsRetry = false;
   Chrom mChrom;
   RegSpec mSpec;
   RefPath mRefPath;
@@ -66,7 +82,7 @@ class Window {
     if (mRegPtr != nullptr || mRefPath.empty() || mSpec.mChromName.empty()) return;
 
     const hts::Reference reference(mRefPath);
-    mRegPtr = std::make_shared<const hts::Reference::Region>(reference.MakeRegion(mSpec));
+    EnsureRegionBuilt(reference);
   }
 };
 
@@ -21,7 +21,7 @@
 #include "absl/types/span.h"
 #include "lancet/base/logging.h"
 #include "lancet/base/types.h"
-#include "lancet/core/window.h"
+#include "lancet/core/window_generator.h"
 #include "spdlog/fmt/bundled/core.h"
 
 namespace lancet::core {
@@ -118,61 +118,27 @@ auto WindowBuilder::StepSize(const Params &params) -> i64 {
   return static_cast<i64>(std::ceil(val / 100.0) * 100.0);
 }
 
-auto WindowBuilder::BuildWindows() const -> std::vector<WindowPtr> {
+auto WindowBuilder::MakeGenerator() const -> WindowGenerator {
   // NOLINTNEXTLINE(readability-braces-around-statements)
   if (mInputRegions.empty()) return {};
 
-  std::string rspec;
   const auto nregs = mInputRegions.size();
   const auto window_len = static_cast<i64>(mParams.mWindowLength);
   const auto pct_olap = static_cast<i64>(mParams.mPercentOverlap);
   LOG_INFO("Using {} input region(s) to build {}bp moving windows with {}% overlap", nregs, window_len, pct_olap)
 
-  const auto step_size = StepSize(mParams);
-  absl::flat_hash_set<WindowPtr> uniq_windows;
+  std::vector<WindowGenerator::InputRegion> padded_regions;
+  padded_regions.reserve(nregs);
 
   for (ParseRegionResult region : mInputRegions) {
     PadInputRegion(region);
-    const auto chrom = mRefPtr->FindChromByName(region.mChromName).value();
-
-    if (region.Length() <= window_len) {
-      auto wptr = std::make_shared<Window>(std::move(region), chrom, mRefPtr->FastaPath());
-      uniq_windows.emplace(std::move(wptr));
-      continue;
-    }
-
-    const auto chrom_has_colon = region.mChromName.find(':') != std::string::npos;
-    auto curr_window_start = static_cast<i64>(region.mRegionSpan[0].value());
-    const auto max_window_pos = static_cast<i64>(region.mRegionSpan[1].value());
-
-    while ((curr_window_start + window_len) <= max_window_pos) {
-      const i64 curr_window_end = curr_window_start + window_len;
-      rspec = chrom_has_colon ? fmt::format("{{{}}}:{}-{}", region.mChromName, curr_window_start, curr_window_end)
-                              : fmt::format("{}:{}-{}", region.mChromName, curr_window_start, curr_window_end);
-
-      auto wptr = std::make_shared<Window>(mRefPtr->ParseRegion(rspec.c_str()), chrom, mRefPtr->FastaPath());
-      uniq_windows.emplace(std::move(wptr));
-      curr_window_start += step_size;
-    }
+    auto chrom = mRefPtr->FindChromByName(region.mChromName).value();
+    padded_regions.emplace_back(WindowGenerator::InputRegion{.mChrom = std::move(chrom),
+                                                             .mStartPos1 = region.mRegionSpan[0].value(),
+                                                             .mEndPos1 = region.mRegionSpan[1].value()});
   }
 
-  static const auto WindowPtrComparator = [](const WindowPtr &first, const WindowPtr &second) -> bool {
-    // NOLINTBEGIN(readability-braces-around-statements)
-    if (first->ChromIndex() != second->ChromIndex()) return first->ChromIndex() < second->ChromIndex();
-    if (first->StartPos1() != second->StartPos1()) return first->StartPos1() < second->StartPos1();
-    return first->EndPos1() < second->EndPos1();
-    // NOLINTEND(readability-braces-around-statements)
-  };
-
-  usize current_idx = 0;
-  std::vector<WindowPtr> results(uniq_windows.cbegin(), uniq_windows.cend());
-  std::ranges::sort(results, WindowPtrComparator);
-  std::ranges::for_each(results, [&current_idx](WindowPtr &window_ptr) {
-    window_ptr->SetGenomeIndex(current_idx);
-    current_idx++;
-  });
-
-  return results;
+  return {padded_regions, mRefPtr->FastaPath(), window_len, StepSize(mParams)};
 }
 
 void WindowBuilder::PadInputRegion(ParseRegionResult &result) const {
@@ -9,7 +9,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
 #include "lancet/base/types.h"
-#include "lancet/core/window.h"
+#include "lancet/core/window_generator.h"
 #include "lancet/hts/reference.h"
 
 namespace lancet::core {
@@ -45,7 +45,8 @@ class WindowBuilder {
 
   [[nodiscard]] static auto StepSize(const Params& params) -> i64;
 
-  [[nodiscard]] auto BuildWindows() const -> std::vector<WindowPtr>;
+  // Padded input regions are turned into windows lazily, in genome order, by the returned generator
+  [[nodiscard]] auto MakeGenerator() const -> WindowGenerator;
 
  private:
   Params mParams;
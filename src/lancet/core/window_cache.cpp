@@ -0,0 +1,157 @@
+#include "lancet/core/window_cache.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
+#include "lancet/base/hash.h"
+#include "lancet/base/logging.h"
+#include "lancet/base/types.h"
+#include "lancet/base/version.h"
+#include "lancet/caller/variant_call.h"
+#include "spdlog/fmt/bundled/core.h"
+#include "spdlog/fmt/bundled/ostream.h"
+
+namespace {
+
+constexpr std::string_view HEADER_LINE = "##lancet_window_cache=1";
+constexpr std::string_view REGION_KEY = "REGION\t";
+constexpr std::string_view STATUS_KEY = "STATUS\t";
+constexpr std::string_view VARIANT_KEY = "VARIANT\t";
+
+}  // namespace
+
+namespace lancet::core {
+
+WindowCache::WindowCache(std::filesystem::path cache_dir, const VariantBuilder::Params &params)
+    : mCacheDir(std::move(cache_dir)), mRunFingerprint(MakeRunFingerprint(params)) {}
+
+auto WindowCache::Lookup(const Window &window) const -> std::optional<Entry> {
+  const auto region = window.ToSamtoolsRegion();
+  std::ifstream fhandle(EntryPath(region), std::ios_base::in);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!fhandle) return std::nullopt;
+
+  std::string line;
+  // NOLINTBEGIN(readability-braces-around-statements)
+  if (!std::getline(fhandle, line) || line != HEADER_LINE) return std::nullopt;
+  if (!std::getline(fhandle, line) || line != absl::StrCat(REGION_KEY, region)) return std::nullopt;
+  if (!std::getline(fhandle, line)) return std::nullopt;
+  // NOLINTEND(readability-braces-around-statements)
+
+  i32 status = 0;
+  std::string_view contents = line;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!absl::ConsumePrefix(&contents, STATUS_KEY) || !absl::SimpleAtoi(contents, &status)) return std::nullopt;
+
+  Entry result;
+  result.mStatus = static_cast<VariantBuilder::StatusCode>(status);
+  while (std::getline(fhandle, line)) {
+    contents = line;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!absl::ConsumePrefix(&contents, VARIANT_KEY)) return std::nullopt;
+
+    auto variant = caller::VariantCall::Deserialize(contents);
+    if (!variant.ok()) {
+      LOG_WARN("Ignoring invalid cache entry for window {}: {}", region, variant.status().message())
+      return std::nullopt;
+    }
+
+    result.mVariants.emplace_back(std::move(variant).value());
+  }
+
+  return result;
+}
+
+void WindowCache::Store(const Window &window, const VariantBuilder::StatusCode status,
+                        const VariantBuilder::WindowResults &variants) const {
+  using VariantBuilder::StatusCode::DEFERRED_OVER_BUDGET;
+  using VariantBuilder::StatusCode::UNKNOWN;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (status == UNKNOWN || status == DEFERRED_OVER_BUDGET) return;
+
+  const auto region = window.ToSamtoolsRegion();
+  const auto entry_path = EntryPath(region);
+  std::error_code err_code;
+  std::filesystem::create_directories(entry_path.parent_path(), err_code);
+
+  // Temporary names are unique per process and thread, so concurrent writers never share a temporary file
+  static thread_local const auto tid = absl::Hash<std::thread::id>()(std::this_thread::get_id());
+  auto tmp_path = entry_path;
+  tmp_path += fmt::format(".{}.{:x}.tmp", getpid(), tid);
+
+  {
+    std::ofstream fhandle(tmp_path, std::ios_base::out | std::ios_base::trunc);
+    fmt::print(fhandle, "{}\n{}{}\n{}{}\n", HEADER_LINE, REGION_KEY, region, STATUS_KEY, static_cast<i32>(status));
+    for (const auto &variant : variants) {
+      fmt::print(fhandle, "{}{}\n", VARIANT_KEY, variant->Serialize());
+    }
+
+    fhandle.flush();
+    if (!fhandle) {
+      LOG_WARN("Could not write cache entry for window {} to {}", region, tmp_path.string())
+      std::filesystem::remove(tmp_path, err_code);
+      return;
+    }
+  }
+
+  std::filesystem::rename(tmp_path, entry_path, err_code);
+  if (err_code) {
+    LOG_WARN("Could not move cache entry for window {} to {}: {}", region, entry_path.string(), err_code.message())
+    std::filesystem::remove(tmp_path, err_code);
+  }
+}
+
+auto WindowCache::EntryPath(const std::string &region) const -> std::filesystem::path {
+  // First byte of the key is used as a sub-directory, so that no single directory gets too many entries
+  const auto key = fmt::format("{:016x}", HashStr64(fmt::format("{:016x}\t{}", mRunFingerprint, region)));
+  return mCacheDir / key.substr(0, 2) / absl::StrCat(key, ".txt");
+}
+
+auto WindowCache::MakeRunFingerprint(const VariantBuilder::Params &params) -> u64 {
+  const auto &rc_prms = params.mRdCollParams;
+  const auto &grph_prms = params.mGraphParams;
+
+  auto inputs = fmt::format("version={}\nref={}\n", LancetFullVersion(), FileIdentity(rc_prms.mRefPath));
+  for (const auto &path : rc_prms.mNormalPaths) {
+    absl::StrAppend(&inputs, "normal=", FileIdentity(path), "\n");
+  }
+  for (const auto &path : rc_prms.mTumorPaths) {
+    absl::StrAppend(&inputs, "tumor=", FileIdentity(path), "\n");
+  }
+
+  absl::StrAppend(&inputs, fmt::format("max_sample_cov={}\nno_ctg_check={}\nextract_pairs={}\n", rc_prms.mMaxSampleCov,
+                                       rc_prms.mNoCtgCheck, rc_prms.mExtractPairs));
+  absl::StrAppend(&inputs, fmt::format("min_kmer={}\nmax_kmer={}\nkmer_step={}\n", grph_prms.mMinKmerLen,
+                                       grph_prms.mMaxKmerLen, grph_prms.mKmerStepLen));
+  absl::StrAppend(&inputs, fmt::format("min_node_cov={}\nmin_anchor_cov={}\nvisit_budget={}\n", grph_prms.mMinNodeCov,
+                                       grph_prms.mMinAnchorCov, grph_prms.mWindowVisitBudget));
+  absl::StrAppend(&inputs, fmt::format("skip_active_region={}\n", params.mSkipActiveRegion));
+  return HashStr64(inputs);
+}
+
+auto WindowCache::FileIdentity(const std::filesystem::path &path) -> std::string {
+  // Size and modification time stand in for the file contents, since hashing whole BAM/CRAM files would
+  // take longer than most re-runs. Missing files still get an identity, and simply never match later.
+  std::error_code err_code;
+  const auto abs_path = std::filesystem::absolute(path, err_code);
+  const auto file_size = std::filesystem::file_size(path, err_code);
+  const auto num_bytes = err_code ? 0 : file_size;
+  const auto mod_time = std::filesystem::last_write_time(path, err_code);
+  const auto mod_ticks = err_code ? 0 : mod_time.time_since_epoch().count();
+  return fmt::format("{}\t{}\t{}", abs_path.string(), num_bytes, mod_ticks);
+}
+
+}  // namespace lancet::core
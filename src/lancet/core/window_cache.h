@@ -0,0 +1,51 @@
+#ifndef SRC_LANCET_CORE_WINDOW_CACHE_H_
+#define SRC_LANCET_CORE_WINDOW_CACHE_H_
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "lancet/base/types.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window.h"
+
+namespace lancet::core {
+
+// On-disk cache of per-window results, so that re-runs over the same inputs with overlapping regions
+// only process windows that were never processed before. Entries are keyed by the window region and a
+// fingerprint of everything else that changes window results: the Lancet version, identity, size and
+// modification time of the reference and all alignment files, and all VariantBuilder parameters.
+// Safe to share across worker threads and across processes that use the same cache directory.
+class WindowCache {
+ public:
+  WindowCache(std::filesystem::path cache_dir, const VariantBuilder::Params& params);
+
+  struct Entry {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    VariantBuilder::StatusCode mStatus = VariantBuilder::StatusCode::UNKNOWN;
+    VariantBuilder::WindowResults mVariants;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  // Cached results of `window`, or nullopt if the window was not cached or its entry could not be read
+  [[nodiscard]] auto Lookup(const Window& window) const -> std::optional<Entry>;
+
+  // Final window results are stored, while windows without a final status, such as deferred ones, are not.
+  // Entries are written to a temporary file first and renamed, so readers never see a partial entry.
+  void Store(const Window& window, VariantBuilder::StatusCode status,
+             const VariantBuilder::WindowResults& variants) const;
+
+  [[nodiscard]] auto RunFingerprint() const noexcept -> u64 { return mRunFingerprint; }
+
+ private:
+  std::filesystem::path mCacheDir;
+  u64 mRunFingerprint = 0;
+
+  [[nodiscard]] auto EntryPath(const std::string& region) const -> std::filesystem::path;
+  [[nodiscard]] static auto MakeRunFingerprint(const VariantBuilder::Params& params) -> u64;
+  [[nodiscard]] static auto FileIdentity(const std::filesystem::path& path) -> std::string;
+};
+
+}  // namespace lancet::core
+
+#endif  // SRC_LANCET_CORE_WINDOW_CACHE_H_
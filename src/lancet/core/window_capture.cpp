@@ -0,0 +1,263 @@
+#include "lancet/core/window_capture.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "htslib/bgzf.h"
+#include "htslib/kstring.h"
+}
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "lancet/base/types.h"
+#include "lancet/hts/bgzf_ostream.h"
+#include "lancet/hts/reference.h"
+#include "spdlog/fmt/bundled/core.h"
+#include "spdlog/fmt/bundled/ostream.h"
+
+namespace {
+
+constexpr std::string_view HEADER_LINE = "##lancet_window_capture=1";
+constexpr std::string_view WINDOW_KEY = "WINDOW\t";
+constexpr std::string_view REFERENCE_KEY = "REFERENCE\t";
+constexpr std::string_view GRAPH_KEY = "GRAPH\t";
+constexpr std::string_view SAMPLE_KEY = "SAMPLE\t";
+constexpr std::string_view READ_KEY = "READ\t";
+
+// Base qualities are written as printable characters, with the same offset as FASTQ
+constexpr u8 PHRED_OFFSET = 33;
+
+struct BgzfDeleter {
+  void operator()(BGZF* handle) noexcept { bgzf_close(handle); }
+};
+
+// Integers of any width are parsed as i64, and are invalid if they do not fit into `T`
+template <typename T>
+[[nodiscard]] auto ParseInt(std::string_view text, T* result) -> bool {
+  i64 value = 0;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!absl::SimpleAtoi(text, &value) || !std::in_range<T>(value)) return false;
+  *result = static_cast<T>(value);
+  return true;
+}
+
+[[nodiscard]] auto ParseBool(std::string_view text, bool* result) -> bool {
+  *result = text == "1";
+  return text == "0" || text == "1";
+}
+
+[[nodiscard]] auto ParseTag(std::string_view text, lancet::cbdg::Label::Tag* result) -> bool {
+  u8 value = 0;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!ParseInt(text, &value)) return false;
+  *result = static_cast<lancet::cbdg::Label::Tag>(value);
+  return *result == lancet::cbdg::Label::NORMAL || *result == lancet::cbdg::Label::TUMOR;
+}
+
+[[nodiscard]] auto ParseRead(std::string_view contents) -> std::optional<lancet::cbdg::Read> {
+  const std::vector<std::string_view> tokens = absl::StrSplit(contents, '\t');
+  // NOLINTNEXTLINE(readability-magic-numbers)
+  if (tokens.size() != 11) return std::nullopt;
+
+  lancet::cbdg::Read::Fields fields;
+  // NOLINTBEGIN(readability-magic-numbers)
+  const auto is_valid = ParseTag(tokens[1], &fields.mTag) && ParseInt(tokens[3], &fields.mChromIdx) &&
+                        ParseInt(tokens[4], &fields.mStart0) && ParseInt(tokens[5], &fields.mSamFlag) &&
+                        ParseInt(tokens[6], &fields.mMapQual) && ParseInt(tokens[7], &fields.mPctAlnScoresDiff) &&
+                        ParseBool(tokens[8], &fields.mPassesAlnFilters) && tokens[9].size() == tokens[10].size();
+  // NOLINTEND(readability-magic-numbers)
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!is_valid) return std::nullopt;
+
+  fields.mSampleName = std::string(tokens[0]);
+  fields.mQname = std::string(tokens[2]);
+  fields.mSequence = std::string(tokens[9]);
+  fields.mQuality.reserve(tokens[10].size());
+  std::ranges::transform(tokens[10], std::back_inserter(fields.mQuality),
+                         [](const char qual) -> u8 { return static_cast<u8>(qual) - PHRED_OFFSET; });
+  return lancet::cbdg::Read(std::move(fields));
+}
+
+}  // namespace
+
+namespace lancet::core {
+
+WindowCapture::WindowCapture(const Window& window, const cbdg::Graph::Params& params,
+                             const ReadCollector::Result& rc_result)
+    : mChromName(window.ChromName()), mChromIdx(static_cast<i32>(window.ChromIndex())),
+      mChromLength(window.ChromLength()), mStartPos1(window.StartPos1()), mEndPos1(window.EndPos1()),
+      mIsRetry(window.IsRetry()), mRefSeq(window.SeqView()), mGraphParams(params), mReads(rc_result.mSampleReads) {
+  // Graphs of replayed windows are never written out
+  mGraphParams.mOutGraphsDir.clear();
+  mSamples.reserve(rc_result.mSampleList.size());
+  for (const auto& sinfo : rc_result.mSampleList) {
+    mSamples.push_back(Sample{.mSampleName = std::string(sinfo.SampleName()), .mTag = sinfo.TagKind()});
+  }
+}
+
+auto WindowCapture::Write(const std::filesystem::path& path) const -> absl::Status {
+  auto tmp_path = path;
+  tmp_path += ".tmp";
+
+  {
+    hts::BgzfOstream out_stream;
+    if (!out_stream.Open(tmp_path)) {
+      return absl::Status(absl::StatusCode::kInternal, fmt::format("Could not open {}", tmp_path.string()));
+    }
+
+    fmt::print(out_stream, "{}\n{}{}\t{}\t{}\t{}\t{}\t{:d}\n{}{}\n", HEADER_LINE, WINDOW_KEY, mChromName, mChromIdx,
+               mChromLength, mStartPos1, mEndPos1, mIsRetry, REFERENCE_KEY, mRefSeq);
+    fmt::print(out_stream, "{}{}\t{}\t{}\t{}\t{}\t{}\n", GRAPH_KEY, mGraphParams.mMinKmerLen, mGraphParams.mMaxKmerLen,
+               mGraphParams.mKmerStepLen, mGraphParams.mMinNodeCov, mGraphParams.mMinAnchorCov,
+               mGraphParams.mWindowVisitBudget);
+    for (const auto& sample : mSamples) {
+      fmt::print(out_stream, "{}{}\t{}\n", SAMPLE_KEY, sample.mSampleName, static_cast<u8>(sample.mTag));
+    }
+
+    std::string quals;
+    for (const auto& read : mReads) {
+      quals.clear();
+      std::ranges::transform(read.QualView(), std::back_inserter(quals),
+                             [](const u8 qual) -> char { return static_cast<char>(qual + PHRED_OFFSET); });
+      fmt::print(out_stream, "{}{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\t{:d}\t{}\t{}\n", READ_KEY, read.SampleName(),
+                 static_cast<u8>(read.TagKind()), read.QnameView(), read.ChromIndex(), read.StartPos0(),
+                 static_cast<u16>(read.BitwiseFlag()), read.MapQual(), read.PctAlnScoresDiff(),
+                 read.PassesAlnFilters(), read.SeqView(), quals);
+    }
+
+    out_stream.flush();
+    const auto is_written = static_cast<bool>(out_stream);
+    out_stream.Close();
+    if (!is_written) {
+      return absl::Status(absl::StatusCode::kInternal, fmt::format("Could not write {}", tmp_path.string()));
+    }
+  }
+
+  std::error_code err_code;
+  std::filesystem::rename(tmp_path, path, err_code);
+  if (err_code) {
+    const auto msg = fmt::format("Could not move window capture to {}: {}", path.string(), err_code.message());
+    return absl::Status(absl::StatusCode::kInternal, msg);
+  }
+
+  return absl::OkStatus();
+}
+
+auto WindowCapture::Read(const std::filesystem::path& path) -> absl::StatusOr<WindowCapture> {
+  const std::unique_ptr<BGZF, BgzfDeleter> handle(bgzf_open(path.c_str(), "r"));
+  if (handle == nullptr) {
+    return absl::Status(absl::StatusCode::kNotFound, fmt::format("Could not open window capture {}", path.string()));
+  }
+
+  kstring_t buffer = KS_INITIALIZE;
+  const std::unique_ptr<kstring_t, void (*)(kstring_t*)> buffer_guard(&buffer, ks_free);
+  const auto next_line = [&handle, &buffer](std::string_view* line) -> bool {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (bgzf_getline(handle.get(), '\n', &buffer) < 0) return false;
+    *line = std::string_view(ks_str(&buffer), ks_len(&buffer));
+    return true;
+  };
+
+  std::string_view line;
+  if (!next_line(&line) || line != HEADER_LINE) {
+    return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Invalid window capture header in {}", path.string()));
+  }
+
+  WindowCapture result;
+  usize line_num = 1;
+  const auto parse_error = [&path, &line_num]() -> absl::Status {
+    const auto msg = fmt::format("Could not parse line {} in window capture {}", line_num, path.string());
+    return absl::Status(absl::StatusCode::kDataLoss, msg);
+  };
+
+  while (next_line(&line)) {
+    line_num++;
+    std::string_view contents = line;
+    if (absl::ConsumePrefix(&contents, READ_KEY)) {
+      auto read = ParseRead(contents);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!read.has_value()) return parse_error();
+      result.mReads.emplace_back(std::move(read).value());
+      continue;
+    }
+
+    if (absl::ConsumePrefix(&contents, SAMPLE_KEY)) {
+      const std::vector<std::string_view> tokens = absl::StrSplit(contents, '\t');
+      Sample sample;
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (tokens.size() != 2 || !ParseTag(tokens[1], &sample.mTag)) return parse_error();
+      sample.mSampleName = std::string(tokens[0]);
+      result.mSamples.push_back(std::move(sample));
+      continue;
+    }
+
+    if (absl::ConsumePrefix(&contents, WINDOW_KEY)) {
+      const std::vector<std::string_view> tokens = absl::StrSplit(contents, '\t');
+      // NOLINTNEXTLINE(readability-magic-numbers)
+      const auto is_valid = tokens.size() == 6 && ParseInt(tokens[1], &result.mChromIdx) &&
+                            ParseInt(tokens[2], &result.mChromLength) && ParseInt(tokens[3], &result.mStartPos1) &&
+                            ParseInt(tokens[4], &result.mEndPos1) && ParseBool(tokens[5], &result.mIsRetry) &&
+                            result.mStartPos1 > 0 && result.mStartPos1 <= result.mEndPos1;
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!is_valid) return parse_error();
+      result.mChromName = std::string(tokens[0]);
+      continue;
+    }
+
+    if (absl::ConsumePrefix(&contents, GRAPH_KEY)) {
+      auto& params = result.mGraphParams;
+      const std::vector<std::string_view> tokens = absl::StrSplit(contents, '\t');
+      // NOLINTNEXTLINE(readability-magic-numbers)
+      const auto is_valid = tokens.size() == 6 && ParseInt(tokens[0], &params.mMinKmerLen) &&
+                            ParseInt(tokens[1], &params.mMaxKmerLen) && ParseInt(tokens[2], &params.mKmerStepLen) &&
+                            ParseInt(tokens[3], &params.mMinNodeCov) && ParseInt(tokens[4], &params.mMinAnchorCov) &&
+                            ParseInt(tokens[5], &params.mWindowVisitBudget);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!is_valid) return parse_error();
+      continue;
+    }
+
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!absl::ConsumePrefix(&contents, REFERENCE_KEY)) return parse_error();
+    result.mRefSeq = std::string(contents);
+  }
+
+  if (result.mChromName.empty() || result.mRefSeq.size() != result.mEndPos1 - result.mStartPos1 + 1) {
+    return absl::Status(absl::StatusCode::kDataLoss, fmt::format("Incomplete window capture {}", path.string()));
+  }
+
+  return result;
+}
+
+auto WindowCapture::MakeWindow() const -> WindowPtr {
+  auto seq = mRefSeq;
+  const hts::Reference::Chrom chrom(mChromIdx, mChromName, static_cast<hts_pos_t>(mChromLength));
+  const hts::Reference::OneBasedClosedOptional span{mStartPos1, mEndPos1};
+  // Region constructor is private to friends, so make_shared moves a region built here
+  auto region = std::make_shared<const hts::Reference::Region>(hts::Reference::Region(
+      static_cast<usize>(mChromIdx), std::make_pair(mStartPos1, mEndPos1), mChromName.c_str(), std::move(seq)));
+
+  auto result = std::make_shared<Window>(Window::RegSpec{.mChromName = mChromName, .mRegionSpan = span}, chrom,
+                                         std::move(region));
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mIsRetry) result->MarkAsRetry();
+  return result;
+}
+
+auto WindowCapture::IsGermlineMode() const -> bool {
+  return std::ranges::none_of(mSamples, [](const Sample& sample) { return sample.mTag == cbdg::Label::TUMOR; });
+}
+
+}  // namespace lancet::core
@@ -0,0 +1,65 @@
+#ifndef SRC_LANCET_CORE_WINDOW_CAPTURE_H_
+#define SRC_LANCET_CORE_WINDOW_CAPTURE_H_
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "lancet/base/types.h"
+#include "lancet/cbdg/graph.h"
+#include "lancet/cbdg/label.h"
+#include "lancet/cbdg/read.h"
+#include "lancet/core/read_collector.h"
+#include "lancet/core/window.h"
+
+namespace lancet::core {
+
+// Everything the assembly stage of one window depends on: the reference sequence of the window, the
+// collected reads with their samples and the graph parameters. Captured windows are written with
+// `--capture-windows`, so that slow windows can be replayed through assembly and genotyping without
+// the alignment files or the reference, e.g. by the replay benchmark.
+class WindowCapture {
+ public:
+  struct Sample {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    std::string mSampleName;
+    cbdg::Label::Tag mTag = cbdg::Label::REFERENCE;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  WindowCapture() = default;
+  WindowCapture(const Window& window, const cbdg::Graph::Params& params, const ReadCollector::Result& rc_result);
+
+  // Captures are BGZF compressed text, with one line for the window, its reference sequence, the graph
+  // parameters, each sample and each read. Files are written to a temporary path first and renamed.
+  [[nodiscard]] auto Write(const std::filesystem::path& path) const -> absl::Status;
+  [[nodiscard]] static auto Read(const std::filesystem::path& path) -> absl::StatusOr<WindowCapture>;
+
+  // Window with the captured reference sequence, which never reads the reference
+  [[nodiscard]] auto MakeWindow() const -> WindowPtr;
+
+  [[nodiscard]] auto GraphParams() const noexcept -> const cbdg::Graph::Params& { return mGraphParams; }
+  [[nodiscard]] auto Samples() const noexcept -> absl::Span<const Sample> { return mSamples; }
+  [[nodiscard]] auto Reads() const noexcept -> absl::Span<const cbdg::Read> { return mReads; }
+  [[nodiscard]] auto IsGermlineMode() const -> bool;
+
+ private:
+  std::string mChromName;
+  i32 mChromIdx = -1;
+  u64 mChromLength = 0;
+  u64 mStartPos1 = 0;
+  u64 mEndPos1 = 0;
+  bool mIsRetry = false;
+  std::string mRefSeq;
+
+  cbdg::Graph::Params mGraphParams;
+  std::vector<Sample> mSamples;
+  std::vector<cbdg::Read> mReads;
+};
+
+}  // namespace lancet::core
+
+#endif  // SRC_LANCET_CORE_WINDOW_CAPTURE_H_
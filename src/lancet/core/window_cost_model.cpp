@@ -0,0 +1,105 @@
+#include "lancet/core/window_cost_model.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lancet/base/repeat.h"
+#include "lancet/base/sliding.h"
+#include "lancet/base/types.h"
+#include "lancet/cbdg/graph.h"
+#include "lancet/core/read_collector.h"
+#include "lancet/core/window.h"
+#include "lancet/hts/extractor.h"
+#include "lancet/hts/reference.h"
+
+namespace lancet::core {
+
+WindowCostModel::WindowCostModel(const ReadCollector::Params& rc_params, const cbdg::Graph::Params& graph_params)
+    : mRefPtr(std::make_unique<hts::Reference>(rc_params.mRefPath)), mGraphParams(graph_params) {
+  mExtractors.reserve(rc_params.SamplesCount());
+  static const std::vector<std::string> no_tags;
+  const auto no_ctgcheck = rc_params.mNoCtgCheck;
+  const auto add_extractor = [no_ctgcheck, this](const std::filesystem::path& aln_path) {
+    using hts::Extractor;
+    this->mExtractors.emplace_back(
+        std::make_unique<Extractor>(aln_path, *this->mRefPtr, Extractor::DEFAULT_FIELDS, no_tags, no_ctgcheck));
+  };
+
+  std::ranges::for_each(rc_params.mNormalPaths, add_extractor);
+  std::ranges::for_each(rc_params.mTumorPaths, add_extractor);
+}
+
+auto WindowCostModel::Predict(const Window& win) const -> f64 {
+  win.EnsureRegionBuilt(*mRefPtr);
+  const auto seq = win.SeqView();
+
+  // Same reference only checks that VariantBuilder does before collecting any reads
+  // NOLINTBEGIN(readability-braces-around-statements)
+  if (static_cast<usize>(std::ranges::count(seq, 'N')) == win.Length()) return REF_SKIPPED_WINDOW_COST;
+  if (HasExactRepeat(SlidingView(seq, mGraphParams.mMaxKmerLen))) return REF_SKIPPED_WINDOW_COST;
+  // NOLINTEND(readability-braces-around-statements)
+
+  // Graph build and traversal work scales with the number of reads in the window, which is roughly
+  // proportional to the compressed alignment bytes. CRAM inputs report no bytes, so all windows
+  // then get the same data term and only the reference features decide the ordering.
+  const auto data_term = 1.0 + IndexedKiloBytes(win.ToSamtoolsRegion());
+
+  // Repetitive reference sequence makes cycles in the read graph more likely, each of which
+  // throws away the graph and retries assembly with a larger k-mer length
+  const auto repeat_term = 1.0 + static_cast<f64>(NumRepeatKmerLengths(seq));
+  return data_term * repeat_term;
+}
+
+auto WindowCostModel::PredictSpan(const Window& first, const Window& last, const usize num_windows) const -> f64 {
+  const auto span_start = first.StartPos1();
+  const auto span_end = std::max(first.EndPos1(), last.EndPos1());
+  const auto span = mRefPtr->MakeRegion(first.ChromName(), {span_start, span_end});
+  const auto seq = span.SeqView();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (seq.empty()) return 0.0;
+
+  const auto data_term = static_cast<f64>(num_windows) + IndexedKiloBytes(span.ToSamtoolsRegion());
+  // Windows with only N bases in the reference are skipped without reading any alignments
+  const auto num_n_bases = static_cast<f64>(std::ranges::count(seq, 'N'));
+  const auto non_n_fraction = 1.0 - (num_n_bases / static_cast<f64>(seq.length()));
+  return non_n_fraction * data_term;
+}
+
+auto WindowCostModel::IndexedKiloBytes(const std::string& region_spec) const -> f64 {
+  static constexpr f64 BYTES_PER_KILOBYTE = 1024.0;
+  const auto summer = [&region_spec](const u64 sum, const std::unique_ptr<hts::Extractor>& extractor) -> u64 {
+    return sum + extractor->IndexedBytesInRegion(region_spec);
+  };
+
+  const auto total_bytes = std::accumulate(mExtractors.cbegin(), mExtractors.cend(), u64(0), summer);
+  return static_cast<f64>(total_bytes) / BYTES_PER_KILOBYTE;
+}
+
+auto WindowCostModel::NumRepeatKmerLengths(std::string_view seq) const -> usize {
+  const auto min_k = mGraphParams.mMinKmerLen;
+  const auto step = static_cast<usize>(mGraphParams.mKmerStepLen);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (step == 0 || mGraphParams.mMaxKmerLen < min_k) return 0;
+
+  // An exact repeat of length k always contains an exact repeat of every shorter length, so the
+  // k-mer lengths with repeats form a prefix of all tried lengths and can be binary searched.
+  usize low = 0;
+  usize high = ((mGraphParams.mMaxKmerLen - min_k) / step) + 1;
+  while (low < high) {
+    const auto mid = low + ((high - low) / 2);
+    if (HasExactRepeat(SlidingView(seq, min_k + (mid * step)))) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+}  // namespace lancet::core
@@ -0,0 +1,48 @@
+#ifndef SRC_LANCET_CORE_WINDOW_COST_MODEL_H_
+#define SRC_LANCET_CORE_WINDOW_COST_MODEL_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lancet/base/types.h"
+#include "lancet/cbdg/graph.h"
+#include "lancet/core/read_collector.h"
+#include "lancet/core/window.h"
+#include "lancet/hts/extractor.h"
+#include "lancet/hts/reference.h"
+
+namespace lancet::core {
+
+// Predicts the relative cost of processing a window before it is processed, using only cheap
+// features: reference bases, reference repeat content and the BAM index byte span of all samples.
+// Predictions are in arbitrary cost units and are only meaningful relative to each other.
+class WindowCostModel {
+ public:
+  // Cost assigned to windows that VariantBuilder skips by only looking at the reference sequence
+  static constexpr f64 REF_SKIPPED_WINDOW_COST = 1e-3;
+
+  WindowCostModel(const ReadCollector::Params& rc_params, const cbdg::Graph::Params& graph_params);
+
+  // Builds the reference sequence of the window as a side effect, which workers re-use later
+  [[nodiscard]] auto Predict(const Window& win) const -> f64;
+
+  // Coarse cost of all windows from `first` to `last` on the same chromosome, without predicting each window
+  [[nodiscard]] auto PredictSpan(const Window& first, const Window& last, usize num_windows) const -> f64;
+
+ private:
+  std::unique_ptr<hts::Reference> mRefPtr;
+  std::vector<std::unique_ptr<hts::Extractor>> mExtractors;
+  cbdg::Graph::Params mGraphParams;
+
+  // Compressed alignment kilobytes overlapping the region summed across all samples
+  [[nodiscard]] auto IndexedKiloBytes(const std::string& region_spec) const -> f64;
+
+  // Number of k-mer lengths tried by the graph that have an exact repeat in the reference sequence
+  [[nodiscard]] auto NumRepeatKmerLengths(std::string_view seq) const -> usize;
+};
+
+}  // namespace lancet::core
+
+#endif  // SRC_LANCET_CORE_WINDOW_COST_MODEL_H_
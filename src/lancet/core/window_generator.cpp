@@ -0,0 +1,114 @@
+#include "lancet/core/window_generator.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lancet/base/types.h"
+#include "lancet/core/window.h"
+
+namespace lancet::core {
+
+WindowGenerator::WindowGenerator(const std::vector<InputRegion> &regions, std::filesystem::path ref_path,
+                                 const i64 window_len, const i64 step_size)
+    : mRefPath(std::move(ref_path)), mStepSize(static_cast<u64>(step_size)) {
+  const auto win_len = static_cast<u64>(window_len);
+  mCursors.reserve(regions.size());
+
+  for (const auto &region : regions) {
+    const auto region_len = region.mEndPos1 - region.mStartPos1 + 1;
+    if (region_len <= win_len) {
+      mCursors.emplace_back(RegionCursor{.mChrom = region.mChrom,
+                                         .mNextStart = region.mStartPos1,
+                                         .mLastStart = region.mStartPos1,
+                                         .mSpanLength = region.mEndPos1 - region.mStartPos1});
+      mEndIdx += 1;
+      continue;
+    }
+
+    // Windows start every `step_size` bases as long as the whole window fits inside the region
+    const auto num_windows = ((region.mEndPos1 - region.mStartPos1 - win_len) / mStepSize) + 1;
+    mCursors.emplace_back(RegionCursor{.mChrom = region.mChrom,
+                                       .mNextStart = region.mStartPos1,
+                                       .mLastStart = region.mStartPos1 + ((num_windows - 1) * mStepSize),
+                                       .mSpanLength = win_len});
+    mEndIdx += num_windows;
+  }
+
+  std::ranges::sort(mCursors, [](const RegionCursor &lhs, const RegionCursor &rhs) { return lhs.Key() < rhs.Key(); });
+}
+
+auto WindowGenerator::Next() -> WindowPtr {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mNumPopped >= mEndIdx) return nullptr;
+
+  const auto next_window = PopNextWindow();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!next_window.has_value()) return nullptr;
+
+  const auto &[cursor_idx, start_pos1] = next_window.value();
+  const auto &cursor = mCursors[cursor_idx];
+  const auto end_pos1 = start_pos1 + cursor.mSpanLength;
+  auto spec = Window::RegSpec{.mChromName = cursor.mChrom.Name(), .mRegionSpan = {start_pos1, end_pos1}};
+  auto window_ptr = std::make_shared<Window>(std::move(spec), cursor.mChrom, mRefPath);
+  window_ptr->SetGenomeIndex(mNumPopped - 1 - mFirstIdx);
+  return window_ptr;
+}
+
+void WindowGenerator::Skip(const usize count) {
+  for (usize idx = 0; idx < count && mNumPopped < mEndIdx; ++idx) {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!PopNextWindow().has_value()) return;
+  }
+}
+
+auto WindowGenerator::Slice(const usize first, const usize last) const -> WindowGenerator {
+  WindowGenerator result(*this);
+  result.mFirstIdx = std::min(mFirstIdx + first, mEndIdx);
+  result.mEndIdx = std::min(mFirstIdx + last, mEndIdx);
+  result.Skip(result.mFirstIdx - std::min(result.mFirstIdx, mNumPopped));
+  return result;
+}
+
+auto WindowGenerator::IsBefore(const usize lhs_cursor, const usize rhs_cursor) const -> bool {
+  const auto lhs_key = mCursors[lhs_cursor].Key();
+  const auto rhs_key = mCursors[rhs_cursor].Key();
+  // Identical windows from different input regions are generated in input region order
+  return lhs_key != rhs_key ? lhs_key < rhs_key : lhs_cursor < rhs_cursor;
+}
+
+auto WindowGenerator::PopNextWindow() -> std::optional<std::pair<usize, u64>> {
+  const auto heap_order = [this](const usize lhs, const usize rhs) -> bool { return IsBefore(rhs, lhs); };
+
+  // Cursors are sorted by their first window, so a cursor only has to join the merge once its first
+  // window is not after the earliest window of all cursors already in the merge
+  while (mNextCursorIdx < mCursors.size() && (mActive.empty() || !IsBefore(mActive.front(), mNextCursorIdx))) {
+    mActive.push_back(mNextCursorIdx);
+    std::ranges::push_heap(mActive, heap_order);
+    mNextCursorIdx++;
+  }
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mActive.empty()) return std::nullopt;
+
+  std::ranges::pop_heap(mActive, heap_order);
+  const auto cursor_idx = mActive.back();
+  auto &cursor = mCursors[cursor_idx];
+  const auto start_pos1 = cursor.mNextStart;
+  mNumPopped++;
+
+  if (cursor.mNextStart == cursor.mLastStart) {
+    mActive.pop_back();
+  } else {
+    cursor.mNextStart += mStepSize;
+    std::ranges::push_heap(mActive, heap_order);
+  }
+
+  return std::make_pair(cursor_idx, start_pos1);
+}
+
+}  // namespace lancet::core
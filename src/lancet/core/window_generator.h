@@ -0,0 +1,77 @@
+#ifndef SRC_LANCET_CORE_WINDOW_GENERATOR_H_
+#define SRC_LANCET_CORE_WINDOW_GENERATOR_H_
+
+#include <filesystem>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "lancet/base/types.h"
+#include "lancet/core/window.h"
+
+namespace lancet::core {
+
+// Yields the moving windows of all input regions in genome order, one at a time. Windows are only built
+// when they are requested, so memory use depends on the number of overlapping input regions and not on
+// the size of the genome. The total number of windows is known up front without building any of them.
+class WindowGenerator {
+ public:
+  // One padded input region with its chromosome. Regions shorter than a window become a single window.
+  struct InputRegion {
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    Window::Chrom mChrom;
+    u64 mStartPos1 = 0;
+    u64 mEndPos1 = 0;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+  };
+
+  WindowGenerator() = default;
+  WindowGenerator(const std::vector<InputRegion>& regions, std::filesystem::path ref_path, i64 window_len,
+                  i64 step_size);
+
+  // Next window in genome order with its genome index set, or nullptr once all windows were generated
+  [[nodiscard]] auto Next() -> WindowPtr;
+
+  // Advances past the next `count` windows without building them
+  void Skip(usize count);
+
+  // Windows `[first, last)` of this generator, with genome indices starting again from 0
+  [[nodiscard]] auto Slice(usize first, usize last) const -> WindowGenerator;
+
+  [[nodiscard]] auto NumTotal() const noexcept -> usize { return mEndIdx - mFirstIdx; }
+
+ private:
+  // Windows of one input region that are not generated yet
+  struct RegionCursor {
+    Window::Chrom mChrom;
+    u64 mNextStart = 0;
+    u64 mLastStart = 0;
+    u64 mSpanLength = 0;
+
+    [[nodiscard]] auto Key() const -> std::tuple<usize, u64, u64> {
+      return {mChrom.Index(), mNextStart, mNextStart + mSpanLength};
+    }
+  };
+
+  std::filesystem::path mRefPath;
+  u64 mStepSize = 0;
+
+  // Cursors sorted by their first window, and a min-heap of cursors that already joined the merge
+  std::vector<RegionCursor> mCursors;
+  std::vector<usize> mActive;
+  usize mNextCursorIdx = 0;
+
+  usize mNumPopped = 0;
+  usize mFirstIdx = 0;
+  usize mEndIdx = 0;
+
+  [[nodiscard]] auto IsBefore(usize lhs_cursor, usize rhs_cursor) const -> bool;
+
+  // Cursor index and start position of the next window in genome order, if any window is left
+  [[nodiscard]] auto PopNextWindow() -> std::optional<std::pair<usize, u64>>;
+};
+
+}  // namespace lancet::core
+
+#endif  // SRC_LANCET_CORE_WINDOW_GENERATOR_H_
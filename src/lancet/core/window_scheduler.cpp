@@ -0,0 +1,272 @@
+#include "lancet/core/window_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "lancet/base/assert.h"
+#include "lancet/base/logging.h"
+#include "lancet/base/types.h"
+#include "lancet/core/async_worker.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window.h"
+#include "lancet/core/window_cost_model.h"
+#include "lancet/core/window_generator.h"
+
+namespace lancet::core {
+
+WindowScheduler::WindowScheduler(WindowGenerator windows, CostModels models, const usize max_lookahead)
+    : mWindows(std::move(windows)), mModels(std::move(models)), mNumWindows(mWindows.NumTotal()),
+      mMaxLookahead(std::max(max_lookahead, usize(1))) {
+  mStates.reserve(mMaxLookahead + (2 * NEIGHBOUR_RADIUS));
+  mSlowest.reserve(NUM_SLOWEST_TO_REPORT + 1);
+}
+
+auto WindowScheduler::NextBatch(const usize max_count, const CompletionTracker& done_windows)
+    -> std::vector<WindowPtr> {
+  const auto done_frontier = done_windows.Frontier();
+  DropWindowsBehind(done_frontier);
+  AdmitWindowsUpto(std::min(mNumWindows, done_frontier + mMaxLookahead), done_windows);
+
+  std::vector<WindowPtr> results;
+  results.reserve(std::min(max_count, mPending.size()));
+  while (results.size() < max_count && !mPending.empty()) {
+    const auto genome_idx = mPending.begin()->second;
+    mPending.erase(mPending.begin());
+    mStates.at(genome_idx).mIsPending = false;
+    results.emplace_back(WindowAt(genome_idx));
+  }
+
+  // Deferred windows hold back the done frontier, so they are retried as soon as the lookahead is drained
+  while (results.size() < max_count && mPending.empty() && !mRetries.empty()) {
+    const auto& window = WindowAt(mRetries.front());
+    window->MarkAsRetry();
+    results.emplace_back(window);
+    mRetries.pop_front();
+  }
+
+  return results;
+}
+
+auto WindowScheduler::WindowAt(const usize genome_idx) const -> const WindowPtr& {
+  return mRecentWindows.at(genome_idx - mFirstRecentIdx);
+}
+
+auto WindowScheduler::WindowBehindFrontier(const usize lag, const CompletionTracker& done_windows)
+    -> const WindowPtr& {
+  const auto done_frontier = done_windows.Frontier();
+  LANCET_ASSERT(lag > 0 && lag <= mMaxLookahead && lag <= done_frontier)
+  const auto genome_idx = done_frontier - lag;
+  // Every window before the frontier is done, so admitting them never adds any pending window
+  DropWindowsBehind(done_frontier);
+  AdmitWindowsUpto(genome_idx + 1, done_windows);
+  return WindowAt(genome_idx);
+}
+
+void WindowScheduler::MarkDone(const AsyncWorker::Result& result) {
+  // Runtimes of deferred windows were cut short by the budget, so they are not used for predictions
+  if (result.mStatus == VariantBuilder::StatusCode::DEFERRED_OVER_BUDGET) {
+    mRetries.push_back(result.mGenomeIdx);
+    return;
+  }
+
+  auto& state = mStates.at(result.mGenomeIdx);
+  state.mIsDone = true;
+  state.mStatus = result.mStatus;
+  state.mActualSeconds = absl::ToDoubleSeconds(result.mRuntime);
+
+  if (!IsRefOnlySkip(state.mStatus)) {
+    mSumActualSeconds += state.mActualSeconds;
+    mSumStaticCost += state.mStaticCost;
+  }
+
+  // Floor both sides so that near instant windows do not dominate the log scale correlation
+  static constexpr f64 MIN_LOG_VALUE = 1e-6;
+  const auto log_pred = std::log(std::max(state.mPredictedCost, MIN_LOG_VALUE));
+  const auto log_actual = std::log(std::max(state.mActualSeconds, MIN_LOG_VALUE));
+  mNumScored++;
+  mSumX += log_pred;
+  mSumY += log_actual;
+  mSumXX += log_pred * log_pred;
+  mSumYY += log_actual * log_actual;
+  mSumXY += log_pred * log_actual;
+  RecordSlowWindow(SlowWindow{.mActualSeconds = state.mActualSeconds,
+                              .mPredictedCost = state.mPredictedCost,
+                              .mGenomeIdx = result.mGenomeIdx,
+                              .mRegion = {}});
+
+  // Windows skipped from reference sequence alone say nothing about the reads in their neighbours
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (IsRefOnlySkip(state.mStatus)) return;
+
+  const auto first_nbr = result.mGenomeIdx > NEIGHBOUR_RADIUS ? result.mGenomeIdx - NEIGHBOUR_RADIUS : 0;
+  const auto last_nbr = result.mGenomeIdx + NEIGHBOUR_RADIUS;
+  for (auto nbr_idx = first_nbr; nbr_idx <= last_nbr; ++nbr_idx) {
+    auto itr = mStates.find(nbr_idx);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (itr == mStates.end() || !itr->second.mIsPending) continue;
+
+    mPending.erase({itr->second.mPredictedCost, nbr_idx});
+    itr->second.mPredictedCost = PredictFromNeighbours(nbr_idx);
+    mPending.emplace(itr->second.mPredictedCost, nbr_idx);
+  }
+}
+
+void WindowScheduler::LogPredictionReport() const {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mNumScored < 2) return;
+
+  const auto num_scored = static_cast<f64>(mNumScored);
+  const auto covariance = mSumXY - (mSumX * mSumY / num_scored);
+  const auto variance_x = mSumXX - (mSumX * mSumX / num_scored);
+  const auto variance_y = mSumYY - (mSumY * mSumY / num_scored);
+  const auto denominator = std::sqrt(variance_x * variance_y);
+  const auto correlation = denominator > 0.0 ? covariance / denominator : 0.0;
+  LOG_INFO("Window cost model | log predicted vs log actual runtime correlation {:.4f} over {} windows", correlation,
+           mNumScored)
+
+  const auto secs_per_unit = SecondsPerCostUnit();
+  for (const auto& item : mSlowest) {
+    const auto actual = absl::FormatDuration(absl::Trunc(absl::Seconds(item.mActualSeconds), absl::Milliseconds(1)));
+    const auto predicted = absl::FormatDuration(
+        absl::Trunc(absl::Seconds(item.mPredictedCost * secs_per_unit), absl::Milliseconds(1)));
+    LOG_INFO("Window cost model | {} took {} | predicted {} at dispatch", item.mRegion, actual, predicted)
+  }
+}
+
+auto WindowScheduler::SecondsPerCostUnit() const -> f64 {
+  return mSumStaticCost > 0.0 ? mSumActualSeconds / mSumStaticCost : 1.0;
+}
+
+auto WindowScheduler::PredictFromNeighbours(const usize genome_idx) const -> f64 {
+  const auto& state = mStates.at(genome_idx);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (state.mStaticCost <= WindowCostModel::REF_SKIPPED_WINDOW_COST) return state.mStaticCost;
+
+  const auto chrom_idx = state.mChromIdx;
+  const auto secs_per_unit = SecondsPerCostUnit();
+  const auto first_nbr = genome_idx > NEIGHBOUR_RADIUS ? genome_idx - NEIGHBOUR_RADIUS : 0;
+  const auto last_nbr = genome_idx + NEIGHBOUR_RADIUS;
+
+  usize num_nbrs = 0;
+  f64 sum_nbr_cost = 0.0;
+  for (auto nbr_idx = first_nbr; nbr_idx <= last_nbr; ++nbr_idx) {
+    const auto itr = mStates.find(nbr_idx);
+    // NOLINTBEGIN(readability-braces-around-statements)
+    if (nbr_idx == genome_idx || itr == mStates.end() || !itr->second.mIsDone) continue;
+    if (itr->second.mStatus == VariantBuilder::StatusCode::UNKNOWN || IsRefOnlySkip(itr->second.mStatus)) continue;
+    if (itr->second.mChromIdx != chrom_idx) continue;
+    // NOLINTEND(readability-braces-around-statements)
+    sum_nbr_cost += itr->second.mActualSeconds / secs_per_unit;
+    num_nbrs++;
+  }
+
+  // Overlapping neighbours share most of their reads, so an inactive neighbour (fast runtime) pulls the
+  // prediction down and a neighbour that needed many k-mer retries (slow runtime) pulls it up
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (num_nbrs == 0) return state.mStaticCost;
+  return 0.5 * (state.mStaticCost + (sum_nbr_cost / static_cast<f64>(num_nbrs)));
+}
+
+auto WindowScheduler::IsRefOnlySkip(const VariantBuilder::StatusCode status) -> bool {
+  return status == VariantBuilder::StatusCode::SKIPPED_NONLY_REF_BASES ||
+         status == VariantBuilder::StatusCode::SKIPPED_REF_REPEAT_SEEN;
+}
+
+void WindowScheduler::DropWindowsBehind(const usize done_frontier) {
+  // Done windows behind the frontier are only kept around as neighbours of windows still in flight
+  while (mOldestTrackedIdx + NEIGHBOUR_RADIUS < done_frontier && mOldestTrackedIdx < mNumAdmitted) {
+    mStates.erase(mOldestTrackedIdx);
+    mOldestTrackedIdx++;
+  }
+
+  while (mFirstRecentIdx + mMaxLookahead < done_frontier && !mRecentWindows.empty()) {
+    mRecentWindows.pop_front();
+    mFirstRecentIdx++;
+  }
+}
+
+void WindowScheduler::AdmitWindowsUpto(const usize genome_idx, const CompletionTracker& done_windows) {
+  const auto done_frontier = done_windows.Frontier();
+  std::vector<usize> to_predict;
+  while (mNumAdmitted < genome_idx) {
+    const auto idx = mNumAdmitted;
+    mNumAdmitted++;
+
+    // Windows already too far behind the frontier to be looked up, such as windows finished before
+    // resuming from a checkpoint, are skipped without being built at all
+    if (idx + mMaxLookahead < done_frontier) {
+      mWindows.Skip(1);
+      mFirstRecentIdx = mNumAdmitted;
+      continue;
+    }
+
+    const auto& window = mRecentWindows.emplace_back(mWindows.Next());
+    auto& state = mStates[idx];
+    state.mChromIdx = window->ChromIndex();
+
+    // Done windows keep the UNKNOWN status, so they are never used as neighbours for predictions
+    if (done_windows.IsDone(idx)) {
+      state.mIsPending = false;
+      state.mIsDone = true;
+      continue;
+    }
+
+    to_predict.push_back(idx);
+  }
+
+  const auto static_costs = PredictStaticCosts(to_predict);
+  for (usize pos = 0; pos < to_predict.size(); ++pos) {
+    const auto idx = to_predict[pos];
+    auto& state = mStates.at(idx);
+    state.mStaticCost = static_costs[pos];
+    state.mPredictedCost = PredictFromNeighbours(idx);
+    mPending.emplace(state.mPredictedCost, idx);
+  }
+}
+
+auto WindowScheduler::PredictStaticCosts(absl::Span<const usize> genome_idxs) const -> std::vector<f64> {
+  std::vector<f64> results(genome_idxs.size(), 0.0);
+  // Each cost model has its own reference and alignment file handles, so it is only used by one thread
+  const auto predict_every_nth = [&genome_idxs, &results, this](const usize first_pos, const usize stride) {
+    const auto& model = *mModels[first_pos];
+    for (auto pos = first_pos; pos < genome_idxs.size(); pos += stride) {
+      results[pos] = model.Predict(*WindowAt(genome_idxs[pos]));
+    }
+  };
+
+  const auto max_threads = genome_idxs.size() / MIN_WINDOWS_PER_PREDICTION_THREAD;
+  const auto num_threads = std::max(usize(1), std::min(mModels.size(), max_threads));
+  std::vector<std::jthread> helper_threads;
+  helper_threads.reserve(num_threads - 1);
+  for (usize thread_idx = 1; thread_idx < num_threads; ++thread_idx) {
+    helper_threads.emplace_back(predict_every_nth, thread_idx, num_threads);
+  }
+
+  predict_every_nth(0, num_threads);
+  helper_threads.clear();
+  return results;
+}
+
+void WindowScheduler::RecordSlowWindow(SlowWindow item) {
+  static const auto slower_than = [](const SlowWindow& lhs, const SlowWindow& rhs) -> bool {
+    return lhs.mActualSeconds > rhs.mActualSeconds;
+  };
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mSlowest.size() == NUM_SLOWEST_TO_REPORT && !slower_than(item, mSlowest.back())) return;
+  // Region names are only built for slow windows, since the window itself is dropped once it is far behind
+  item.mRegion = WindowAt(item.mGenomeIdx)->ToSamtoolsRegion();
+  const auto insert_itr = std::ranges::upper_bound(mSlowest, item, slower_than);
+  mSlowest.insert(insert_itr, std::move(item));
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mSlowest.size() > NUM_SLOWEST_TO_REPORT) mSlowest.pop_back();
+}
+
+}  // namespace lancet::core
@@ -0,0 +1,132 @@
+#ifndef SRC_LANCET_CORE_WINDOW_SCHEDULER_H_
+#define SRC_LANCET_CORE_WINDOW_SCHEDULER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "lancet/base/completion_tracker.h"
+#include "lancet/base/types.h"
+#include "lancet/core/async_worker.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window.h"
+#include "lancet/core/window_cost_model.h"
+#include "lancet/core/window_generator.h"
+
+namespace lancet::core {
+
+// Dispatches windows longest-predicted-first, but only among windows that are at most `max_lookahead`
+// windows ahead of the done frontier. Bounding the lookahead keeps output streaming, since variants
+// from windows far beyond the frontier would otherwise pile up in the VariantStore until the end.
+// Predictions of pending windows are refined with the runtimes of already processed neighbour windows.
+class WindowScheduler {
+ public:
+  static constexpr usize LOOKAHEAD_WINDOWS_PER_THREAD = 64;
+  static constexpr usize NEIGHBOUR_RADIUS = 2;
+  static constexpr usize NUM_SLOWEST_TO_REPORT = 10;
+  // Cost models beyond this only add open alignment file handles, without making admission any faster
+  static constexpr usize MAX_PREDICTION_THREADS = 8;
+  static constexpr usize MIN_WINDOWS_PER_PREDICTION_THREAD = 16;
+
+  using CostModels = std::vector<std::unique_ptr<WindowCostModel>>;
+
+  // Windows admitted into the lookahead together, such as the whole lookahead before the first dispatch,
+  // are predicted in parallel with one thread per cost model. Needs at least one cost model.
+  WindowScheduler(WindowGenerator windows, CostModels models, usize max_lookahead);
+
+  [[nodiscard]] auto NumWindows() const noexcept -> usize { return mNumWindows; }
+
+  // Windows are generated only when they enter the lookahead, and are kept until they fall `max_lookahead`
+  // windows behind the done frontier. Only windows within that range can be looked up. A finished window
+  // can fall out of that range in the `NextBatch` right after it, if it was the last gap before windows done
+  // in a resumed checkpoint, so finished windows must be looked up before the next batch.
+  [[nodiscard]] auto WindowAt(usize genome_idx) const -> const WindowPtr&;
+
+  // Window `lag` windows behind the done frontier, for a `lag` of at most `max_lookahead`. Windows restored
+  // as done from a checkpoint can move the frontier far beyond the lookahead in one step, so windows up to
+  // the returned one are admitted first if needed, instead of assuming it was already admitted.
+  [[nodiscard]] auto WindowBehindFrontier(usize lag, const CompletionTracker& done_windows) -> const WindowPtr&;
+
+  // Up to `max_count` pending windows with the highest predicted cost. Empty only if no window within
+  // the lookahead of the done frontier is pending. Windows already done before they are admitted into
+  // the lookahead, such as windows finished before resuming from a checkpoint, are never dispatched.
+  // Deferred windows are dispatched again, marked as retries, only once no other window is pending.
+  [[nodiscard]] auto NextBatch(usize max_count, const CompletionTracker& done_windows) -> std::vector<WindowPtr>;
+
+  // Windows with status DEFERRED_OVER_BUDGET are not done, and are queued for a retry instead
+  void MarkDone(const AsyncWorker::Result& result);
+
+  // Logs how well dispatch time predictions matched the actual window runtimes
+  void LogPredictionReport() const;
+
+ private:
+  struct WindowState {
+    f64 mStaticCost = 0.0;
+    f64 mPredictedCost = 0.0;
+    f64 mActualSeconds = 0.0;
+    usize mChromIdx = 0;
+    VariantBuilder::StatusCode mStatus = VariantBuilder::StatusCode::UNKNOWN;
+    bool mIsPending = true;
+    bool mIsDone = false;
+  };
+
+  struct CostOrder {
+    // Highest predicted cost first, ties broken by genome order to keep output streaming
+    auto operator()(const std::pair<f64, usize>& lhs, const std::pair<f64, usize>& rhs) const -> bool {
+      return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second;
+    }
+  };
+
+  struct SlowWindow {
+    f64 mActualSeconds = 0.0;
+    f64 mPredictedCost = 0.0;
+    usize mGenomeIdx = 0;
+    std::string mRegion;
+  };
+
+  WindowGenerator mWindows;
+  CostModels mModels;
+  usize mNumWindows;
+  usize mMaxLookahead;
+
+  std::deque<WindowPtr> mRecentWindows;
+  usize mFirstRecentIdx = 0;
+
+  usize mNumAdmitted = 0;
+  usize mOldestTrackedIdx = 0;
+  absl::flat_hash_map<usize, WindowState> mStates;
+  absl::btree_set<std::pair<f64, usize>, CostOrder> mPending;
+  std::deque<usize> mRetries;
+
+  // Converts cost units to seconds, using all processed windows that needed reads
+  f64 mSumActualSeconds = 0.0;
+  f64 mSumStaticCost = 0.0;
+
+  // Running sums for the correlation between log predicted cost and log actual runtime
+  usize mNumScored = 0;
+  f64 mSumX = 0.0;
+  f64 mSumY = 0.0;
+  f64 mSumXX = 0.0;
+  f64 mSumYY = 0.0;
+  f64 mSumXY = 0.0;
+  std::vector<SlowWindow> mSlowest;
+
+  [[nodiscard]] auto SecondsPerCostUnit() const -> f64;
+  [[nodiscard]] auto PredictFromNeighbours(usize genome_idx) const -> f64;
+  [[nodiscard]] static auto IsRefOnlySkip(VariantBuilder::StatusCode status) -> bool;
+
+  // Windows are dropped before admitting more, since admission skips windows too far behind the frontier
+  void DropWindowsBehind(usize done_frontier);
+  void AdmitWindowsUpto(usize genome_idx, const CompletionTracker& done_windows);
+  [[nodiscard]] auto PredictStaticCosts(absl::Span<const usize> genome_idxs) const -> std::vector<f64>;
+  void RecordSlowWindow(SlowWindow item);
+};
+
+}  // namespace lancet::core
+
+#endif  // SRC_LANCET_CORE_WINDOW_SCHEDULER_H_
@@ -0,0 +1,173 @@
+#include "lancet/core/window_timings.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <string>
+#include <string_view>
+
+#include "absl/time/time.h"
+#include "lancet/base/logging.h"
+#include "lancet/base/perf_counters.h"
+#include "lancet/base/types.h"
+#include "spdlog/fmt/bundled/core.h"
+
+namespace {
+
+[[nodiscard]] auto BucketUpperBound(const usize bucket_idx) -> absl::Duration {
+  return absl::Microseconds(static_cast<i64>(u64{1} << bucket_idx));
+}
+
+[[nodiscard]] auto FormatRuntime(const absl::Duration runtime) -> std::string {
+  return absl::FormatDuration(absl::Trunc(runtime, absl::Microseconds(1)));
+}
+
+}  // namespace
+
+namespace lancet::core {
+
+auto WindowTimings::operator+=(const WindowTimings& other) -> WindowTimings& {
+  for (usize idx = 0; idx < NUM_STAGES; ++idx) {
+    mRuntimes.at(idx) += other.mRuntimes.at(idx);
+  }
+  return *this;
+}
+
+void WindowTimingStats::Add(const WindowTimings& timings) {
+  for (usize idx = 0; idx < WindowTimings::NUM_STAGES; ++idx) {
+    const auto runtime = timings.Get(static_cast<WindowTimings::Stage>(idx));
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (runtime <= absl::ZeroDuration()) continue;
+
+    auto& stage = mStages.at(idx);
+    const auto micros = static_cast<u64>(absl::ToInt64Microseconds(runtime));
+    const auto bucket_idx = std::min(static_cast<usize>(std::bit_width(micros)), NUM_BUCKETS - 1);
+    stage.mTotalRuntime += runtime;
+    stage.mNumWindows++;
+    stage.mHistogram.at(bucket_idx)++;
+  }
+}
+
+void WindowTimingStats::LogReport() const {
+  auto all_stages_runtime = absl::ZeroDuration();
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  for (const auto& stage : mStages) all_stages_runtime += stage.mTotalRuntime;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (all_stages_runtime <= absl::ZeroDuration()) return;
+
+  for (usize idx = 0; idx < WindowTimings::NUM_STAGES; ++idx) {
+    const auto& stage = mStages.at(idx);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (stage.mNumWindows == 0) continue;
+
+    const auto stage_id = static_cast<WindowTimings::Stage>(idx);
+    const std::string_view stage_name = StageName(stage_id);
+    const auto pct_runtime = 100.0 * absl::FDivDuration(stage.mTotalRuntime, all_stages_runtime);
+    const auto mean_runtime = stage.mTotalRuntime / static_cast<i64>(stage.mNumWindows);
+    LOG_INFO("Stage timings | {:<15} | {:>8.4f}% of stage time | total {} | mean {} | p50 < {} | p99 < {} | {} windows",
+             stage_name, pct_runtime, FormatRuntime(stage.mTotalRuntime), FormatRuntime(mean_runtime),
+             FormatRuntime(QuantileUpperBound(stage_id, 0.5)), FormatRuntime(QuantileUpperBound(stage_id, 0.99)),
+             stage.mNumWindows)
+
+    std::string histogram;
+    for (usize bucket_idx = 0; bucket_idx < NUM_BUCKETS; ++bucket_idx) {
+      const auto count = stage.mHistogram.at(bucket_idx);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (count == 0) continue;
+      histogram += fmt::format(" <{}:{}", FormatRuntime(BucketUpperBound(bucket_idx)), count);
+    }
+    LOG_INFO("Stage timings | {:<15} | histogram{}", stage_name, histogram)
+  }
+}
+
+auto WindowTimingStats::TotalRuntime(const WindowTimings::Stage stage) const -> absl::Duration {
+  return mStages.at(static_cast<usize>(stage)).mTotalRuntime;
+}
+
+auto WindowTimingStats::NumWindows(const WindowTimings::Stage stage) const -> u64 {
+  return mStages.at(static_cast<usize>(stage)).mNumWindows;
+}
+
+auto WindowTimingStats::QuantileUpperBound(const WindowTimings::Stage stage, const f64 quantile) const
+    -> absl::Duration {
+  const auto& stats = mStages.at(static_cast<usize>(stage));
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (stats.mNumWindows == 0) return absl::ZeroDuration();
+
+  const auto target = static_cast<u64>(std::ceil(quantile * static_cast<f64>(stats.mNumWindows)));
+  u64 num_seen = 0;
+  for (usize bucket_idx = 0; bucket_idx < NUM_BUCKETS; ++bucket_idx) {
+    num_seen += stats.mHistogram.at(bucket_idx);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (num_seen >= std::max(target, u64{1})) return BucketUpperBound(bucket_idx);
+  }
+
+  return absl::InfiniteDuration();
+}
+
+void LogStageCounterReport() {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!PerfCounters::IsEnabled()) return;
+
+  using PerfCounters::Event::BRANCH_MISSES;
+  using PerfCounters::Event::CYCLES;
+  using PerfCounters::Event::INSTRUCTIONS;
+  using PerfCounters::Event::L1D_READ_MISSES;
+  using PerfCounters::Event::LLC_MISSES;
+
+  for (usize idx = 0; idx < WindowTimings::NUM_STAGES; ++idx) {
+    const auto totals = PerfCounters::Total(idx);
+    const auto num_cycles = totals.Get(CYCLES);
+    const auto num_instructions = totals.Get(INSTRUCTIONS);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (num_cycles == 0 || num_instructions == 0) continue;
+
+    static constexpr f64 INSTRUCTIONS_PER_KILO = 1000.0;
+    const auto kilo_instructions = static_cast<f64>(num_instructions) / INSTRUCTIONS_PER_KILO;
+    const auto ipc = static_cast<f64>(num_instructions) / static_cast<f64>(num_cycles);
+    const std::string_view stage_name = StageName(static_cast<WindowTimings::Stage>(idx));
+    LOG_INFO("Stage counters | {:<15} | IPC {:.3f} | MPKI L1D {:.3f} LLC {:.3f} branch {:.3f} | {} cycles | {} instr",
+             stage_name, ipc, static_cast<f64>(totals.Get(L1D_READ_MISSES)) / kilo_instructions,
+             static_cast<f64>(totals.Get(LLC_MISSES)) / kilo_instructions,
+             static_cast<f64>(totals.Get(BRANCH_MISSES)) / kilo_instructions, num_cycles, num_instructions)
+  }
+}
+
+auto StageName(const WindowTimings::Stage stage) -> const char* {
+  using WindowTimings::Stage::ACTIVE_REGION;
+  using WindowTimings::Stage::GENOTYPE;
+  using WindowTimings::Stage::GRAPH_BUILD;
+  using WindowTimings::Stage::MSA_BUILD;
+  using WindowTimings::Stage::PATH_TRAVERSAL;
+  using WindowTimings::Stage::READ_COLLECTION;
+  using WindowTimings::Stage::REPEAT_CHECK;
+  using WindowTimings::Stage::VARIANT_FORMAT;
+  using WindowTimings::Stage::VARIANT_SET;
+
+  switch (stage) {
+    case REPEAT_CHECK:
+      return "REPEAT_CHECK";
+    case ACTIVE_REGION:
+      return "ACTIVE_REGION";
+    case READ_COLLECTION:
+      return "READ_COLLECTION";
+    case GRAPH_BUILD:
+      return "GRAPH_BUILD";
+    case PATH_TRAVERSAL:
+      return "PATH_TRAVERSAL";
+    case MSA_BUILD:
+      return "MSA_BUILD";
+    case VARIANT_SET:
+      return "VARIANT_SET";
+    case GENOTYPE:
+      return "GENOTYPE";
+    case VARIANT_FORMAT:
+      return "VARIANT_FORMAT";
+    default:
+      break;
+  }
+
+  return "UNKNOWN";
+}
+
+}  // namespace lancet::core
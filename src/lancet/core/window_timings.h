@@ -0,0 +1,75 @@
+#ifndef SRC_LANCET_CORE_WINDOW_TIMINGS_H_
+#define SRC_LANCET_CORE_WINDOW_TIMINGS_H_
+
+#include <array>
+
+#include "absl/time/time.h"
+#include "lancet/base/types.h"
+
+namespace lancet::core {
+
+// Time spent in each stage of `VariantBuilder` while processing one window
+class WindowTimings {
+ public:
+  enum class Stage : u8 {
+    REPEAT_CHECK = 0,
+    ACTIVE_REGION = 1,
+    READ_COLLECTION = 2,
+    GRAPH_BUILD = 3,
+    PATH_TRAVERSAL = 4,
+    MSA_BUILD = 5,
+    VARIANT_SET = 6,
+    GENOTYPE = 7,
+    VARIANT_FORMAT = 8
+  };
+
+  static constexpr usize NUM_STAGES = 9;
+
+  void Add(Stage stage, absl::Duration runtime) { mRuntimes.at(static_cast<usize>(stage)) += runtime; }
+  void Reset() { mRuntimes.fill(absl::ZeroDuration()); }
+
+  [[nodiscard]] auto Get(Stage stage) const -> absl::Duration { return mRuntimes.at(static_cast<usize>(stage)); }
+
+  auto operator+=(const WindowTimings& other) -> WindowTimings&;
+
+ private:
+  std::array<absl::Duration, NUM_STAGES> mRuntimes{};
+};
+
+// Cumulative runtime and log2 histogram of per window runtimes for each stage, aggregated over all
+// windows. Histogram bucket `b` counts windows whose stage took less than 2^b microseconds, and at
+// least 2^(b-1) microseconds for b > 0. Windows that never reached a stage are not counted for it.
+class WindowTimingStats {
+ public:
+  static constexpr usize NUM_BUCKETS = 36;
+
+  void Add(const WindowTimings& timings);
+  void LogReport() const;
+
+  [[nodiscard]] auto TotalRuntime(WindowTimings::Stage stage) const -> absl::Duration;
+  [[nodiscard]] auto NumWindows(WindowTimings::Stage stage) const -> u64;
+  // Upper bound of the histogram bucket containing the `quantile` of per window stage runtimes
+  [[nodiscard]] auto QuantileUpperBound(WindowTimings::Stage stage, f64 quantile) const -> absl::Duration;
+
+ private:
+  using Histogram = std::array<u64, NUM_BUCKETS>;
+
+  struct StageStats {
+    absl::Duration mTotalRuntime = absl::ZeroDuration();
+    u64 mNumWindows = 0;
+    Histogram mHistogram{};
+  };
+
+  std::array<StageStats, WindowTimings::NUM_STAGES> mStages{};
+};
+
+// Logs instructions per cycle and misses per thousand instructions of each stage, summed over all threads.
+// Only logs anything with `--perf-counters`, and must be called after all worker threads are joined.
+void LogStageCounterReport();
+
+// Name of `stage` as a string literal, which is also used as its trace event name
+[[nodiscard]] auto StageName(WindowTimings::Stage stage) -> const char*;
+
+}  // namespace lancet::core
+
+#endif  // SRC_LANCET_CORE_WINDOW_TIMINGS_H_
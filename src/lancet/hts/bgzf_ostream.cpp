@@ -1,11 +1,18 @@
 #include "lancet/hts/bgzf_ostream.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <ios>
+#include <system_error>
 
 extern "C" {
 #include "htslib/bgzf.h"
+#include "htslib/hfile.h"
 #include "htslib/tbx.h"
 }
 
@@ -18,6 +25,13 @@ auto BgzfStreambuf::Open(const std::filesystem::path &path, const char *mode) ->
   if (mFilePtr != nullptr) Close();
 
   mFileName = path;
+  mAppendStart = 0;
+  if (std::strchr(mode, 'a') != nullptr) {
+    std::error_code err_code;
+    const auto file_size = std::filesystem::file_size(mFileName, err_code);
+    mAppendStart = err_code ? 0 : static_cast<i64>(file_size);
+  }
+
   mFilePtr = bgzf_open(mFileName.c_str(), mode);
   return mFilePtr != nullptr;
 }
@@ -29,6 +43,24 @@ void BgzfStreambuf::Close() {
   }
 }
 
+auto BgzfStreambuf::FlushBlock() -> i64 {
+  // bgzf_flush only hands compressed blocks to the hFILE buffer, so that is flushed to the kernel as well
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mFilePtr == nullptr || bgzf_flush(mFilePtr) != 0 || hflush(mFilePtr->fp) != 0) return -1;
+
+  // hFILE does not expose its descriptor, but fsync on any descriptor of the file syncs all of its data
+  const auto sync_fd = ::open(mFileName.c_str(), O_WRONLY | O_CLOEXEC);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (sync_fd < 0) return -1;
+  const auto sync_status = ::fsync(sync_fd);
+  ::close(sync_fd);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (sync_status != 0) return -1;
+
+  static constexpr i64 BLOCK_OFFSET_SHIFT = 16;
+  return bgzf_tell(mFilePtr) + (mAppendStart << BLOCK_OFFSET_SHIFT);
+}
+
 auto BgzfStreambuf::uflow() -> int {
   if (mCurrPos != SENTINEL_BUFFER_POSITION) {
     const auto res = mCurrPos;
@@ -86,26 +118,53 @@ auto BgzfOstream::Open(const std::filesystem::path &path, BgzfFormat ofmt) -> bo
   return result;
 }
 
+auto BgzfOstream::OpenForAppend(const std::filesystem::path &path, BgzfFormat ofmt, const i64 virtual_offset) -> bool {
+  // Offsets from FlushBlock are always at a block boundary, so the offset within the block must be zero
+  static constexpr i64 BLOCK_OFFSET_SHIFT = 16;
+  static constexpr i64 WITHIN_BLOCK_MASK = 0xFFFF;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (virtual_offset < 0 || (virtual_offset & WITHIN_BLOCK_MASK) != 0 || !std::filesystem::exists(path)) return false;
+
+  const auto file_offset = static_cast<std::uintmax_t>(virtual_offset >> BLOCK_OFFSET_SHIFT);
+  std::error_code err_code;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (std::filesystem::file_size(path, err_code) < file_offset || err_code) return false;
+  std::filesystem::resize_file(path, file_offset, err_code);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (err_code) return false;
+
+  mOutFmt = ofmt;
+  auto result = mBgzfBuffer.Open(path, "a");
+  rdbuf(&mBgzfBuffer);
+  return result;
+}
+
+auto BgzfOstream::FlushBlock() -> i64 {
+  flush();
+  return mBgzfBuffer.FlushBlock();
+}
+
 void BgzfOstream::Close() {
   mBgzfBuffer.Close();
   // NOLINTNEXTLINE(readability-braces-around-statements)
   if (mOutFmt != BgzfFormat::UNSPECIFIED) BuildIndex();
 }
 
-void BgzfOstream::BuildIndex() {
-  switch (mOutFmt) {
+void BgzfOstream::BuildIndex() { BuildIndex(mBgzfBuffer.mFileName, mOutFmt); }
+
+auto BgzfOstream::BuildIndex(const std::filesystem::path& path, const BgzfFormat ofmt) -> bool {
+  switch (ofmt) {
     case BgzfFormat::VCF:
-      tbx_index_build(mBgzfBuffer.mFileName.c_str(), 0, &tbx_conf_vcf);
-      break;
+      return tbx_index_build(path.c_str(), 0, &tbx_conf_vcf) == 0;
     case BgzfFormat::GFF:
-      tbx_index_build(mBgzfBuffer.mFileName.c_str(), 0, &tbx_conf_gff);
-      break;
+      return tbx_index_build(path.c_str(), 0, &tbx_conf_gff) == 0;
     case BgzfFormat::BED:
-      tbx_index_build(mBgzfBuffer.mFileName.c_str(), 0, &tbx_conf_bed);
-      break;
+      return tbx_index_build(path.c_str(), 0, &tbx_conf_bed) == 0;
     default:
       break;
   }
+
+  return false;
 }
 
 }  // namespace lancet::hts
@@ -33,6 +33,10 @@ class BgzfStreambuf : public std::streambuf {
   auto Open(const std::filesystem::path& path, const char* mode) -> bool;
   void Close();
 
+  // Compresses and writes out all buffered data, so that the returned virtual offset is at a block boundary.
+  // Data is synced to disk before returning, so that the offset never points past the end of the file on disk.
+  auto FlushBlock() -> i64;
+
   auto uflow() -> int override;
   auto underflow() -> int override;
   auto overflow(int dat = EOF) -> int override;  // NOLINT
@@ -42,6 +46,9 @@ class BgzfStreambuf : public std::streambuf {
   static constexpr int SENTINEL_BUFFER_POSITION = -999;
   BGZF* mFilePtr = nullptr;
   int mCurrPos = 0;
+  // Size of the file before it was opened for appending. BGZF counts block addresses from where it started
+  // writing, so this is added to every offset to keep offsets relative to the start of the file.
+  i64 mAppendStart = 0;
 };
 
 }  // namespace detail
@@ -62,6 +69,15 @@ class BgzfOstream : public std::ostream {
   auto Open(const std::filesystem::path& path) -> bool { return Open(path, BgzfFormat::UNSPECIFIED); }
   void Close();
 
+  // Truncates an existing file at a virtual offset returned by `FlushBlock` and appends new data after it
+  auto OpenForAppend(const std::filesystem::path& path, BgzfFormat ofmt, i64 virtual_offset) -> bool;
+
+  // Virtual offset of the end of all data written so far. Returns -1 if the data could not be flushed
+  auto FlushBlock() -> i64;
+
+  // Builds the tabix index of an already closed file, such as one concatenated from several BGZF files
+  static auto BuildIndex(const std::filesystem::path& path, BgzfFormat ofmt) -> bool;
+
  private:
   detail::BgzfStreambuf mBgzfBuffer;
   BgzfFormat mOutFmt = BgzfFormat::UNSPECIFIED;
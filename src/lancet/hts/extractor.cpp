@@ -122,6 +122,41 @@ auto Extractor::ChromName(i32 chrom_index) const -> std::string {
   return {result};
 }
 
+auto Extractor::IndexedBytesInRegion(const std::string& region_spec) const -> u64 {
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (mFilePtr->format.format != bam) return 0;
+
+  const HtsItr itr(sam_itr_querys(mIdxPtr.get(), mHdrPtr.get(), region_spec.c_str()));
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (itr == nullptr || itr->off == nullptr) return 0;
+
+  // BGZF virtual offsets store the compressed block offset in the upper 48 bits and the offset
+  // within the uncompressed block in the lower 16 bits. Chunks inside a single block only have
+  // an uncompressed span, so scale it down by a typical BAM compression ratio instead
+  static constexpr u64 BLOCK_OFFSET_SHIFT = 16;
+  static constexpr u64 WITHIN_BLOCK_MASK = 0xFFFF;
+  static constexpr u64 APPROX_COMPRESSION_RATIO = 4;
+
+  u64 total_bytes = 0;
+  for (int idx = 0; idx < itr->n_off; ++idx) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const auto& chunk = itr->off[idx];
+    const u64 start_block = chunk.u >> BLOCK_OFFSET_SHIFT;
+    const u64 end_block = chunk.v >> BLOCK_OFFSET_SHIFT;
+    if (end_block > start_block) {
+      total_bytes += end_block - start_block;
+      continue;
+    }
+
+    const u64 start_within = chunk.u & WITHIN_BLOCK_MASK;
+    const u64 end_within = chunk.v & WITHIN_BLOCK_MASK;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (end_within > start_within) total_bytes += (end_within - start_within) / APPROX_COMPRESSION_RATIO;
+  }
+
+  return total_bytes;
+}
+
 void Extractor::SetCramRequiredFields(Alignment::Fields fields) {
   if (mFilePtr->format.format == cram && fields != Alignment::Fields::AUX_RGAUX) {
     cram_set_option(mFilePtr->fp.cram, CRAM_OPT_REQUIRED_FIELDS, fields);  // NOLINT
@@ -73,6 +73,10 @@ class Extractor {
   [[nodiscard]] auto ChromName(i32 chrom_index) const -> std::string;
   [[nodiscard]] auto SampleName() const -> std::string { return ParseSampleName(mHdrPtr.get(), mBamCramPath.string()); }
 
+  // Approximate compressed bytes of alignment data overlapping the region, using only the BAM index.
+  // Returns 0 for CRAM files, since CRAM iterators do not expose the file offsets of the region.
+  [[nodiscard]] auto IndexedBytesInRegion(const std::string& region_spec) const -> u64;
+
  private:
   using HtsFile = std::unique_ptr<htsFile, detail::HtsFileDeleter>;
   using SamHdr = std::unique_ptr<sam_hdr_t, detail::SamHdrDeleter>;
@@ -19,6 +19,10 @@ extern "C" {
 #include "lancet/base/assert.h"
 #include "lancet/base/types.h"
 
+namespace lancet::core {
+class WindowCapture;
+}  // namespace lancet::core
+
 namespace lancet::hts {
 
 namespace detail {
@@ -118,6 +122,8 @@ class Reference::Chrom {
   std::string mName;
 
   friend class Reference;
+  // Captured windows are replayed without the reference they were captured from
+  friend class core::WindowCapture;
 
   Chrom(i32 chrom_index, std::string_view chrom_name, hts_pos_t chrom_len)
       : mIdx(static_cast<usize>(chrom_index)), mLength(static_cast<u64>(chrom_len)), mName(chrom_name) {}
@@ -154,6 +160,8 @@ class Reference::Region {
   std::string mSeq;
 
   friend class Reference;
+  // Captured windows are replayed without the reference they were captured from
+  friend class core::WindowCapture;
 
   Region(usize chrom_index, const std::pair<u64, u64>& interval, const char* name, std::string&& seq)
       : mChromIdx(chrom_index), mStart1(interval.first), mEnd1(interval.second), mName(name), mSeq(std::move(seq)) {}
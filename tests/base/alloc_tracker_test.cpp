@@ -0,0 +1,49 @@
+#include "lancet/base/alloc_tracker.h"
+
+#include <new>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+
+namespace {
+
+constexpr auto GRAPH_IDX = static_cast<usize>(AllocTracker::Subsystem::GRAPH);
+
+}  // namespace
+
+TEST_CASE("Usage deltas subtract counts and combines sum them", "[lancet][base][AllocTracker]") {
+  AllocTracker::Usage before{};
+  before.at(GRAPH_IDX) = {.mNumAllocs = 2, .mNumBytes = 64, .mPeakBytes = 64};
+  AllocTracker::Usage after{};
+  after.at(GRAPH_IDX) = {.mNumAllocs = 5, .mNumBytes = 160, .mPeakBytes = 96};
+
+  const auto delta = AllocTracker::Delta(before, after);
+  CHECK(delta.at(GRAPH_IDX).mNumAllocs == 3);
+  CHECK(delta.at(GRAPH_IDX).mNumBytes == 96);
+  CHECK(delta.at(GRAPH_IDX).mPeakBytes == 96);
+
+  const auto combined = AllocTracker::Combine(before, delta);
+  CHECK(combined.at(GRAPH_IDX).mNumAllocs == 5);
+  CHECK(combined.at(GRAPH_IDX).mNumBytes == 160);
+  CHECK(combined.at(GRAPH_IDX).mPeakBytes == 96);
+  CHECK(combined.at(0).mNumAllocs == 0);
+}
+
+TEST_CASE("Allocations are attributed to the innermost scope", "[lancet][base][AllocTracker]") {
+  AllocTracker::Enable();
+  const AllocSpan span;
+  {
+    // Operators are called directly, since allocations of new expressions may be elided by the compiler
+    const AllocScope graph_scope(AllocTracker::Subsystem::GRAPH);
+    auto* first = ::operator new(sizeof(u64));
+    auto* second = ::operator new(sizeof(u64));
+    ::operator delete(first);
+    ::operator delete(second);
+  }
+
+  const auto usage = span.Elapsed();
+  CHECK(usage.at(GRAPH_IDX).mNumAllocs == 2);
+  CHECK(usage.at(GRAPH_IDX).mNumBytes >= 2 * sizeof(u64));
+  CHECK(usage.at(GRAPH_IDX).mPeakBytes >= 2 * sizeof(u64));
+  CHECK(usage.at(static_cast<usize>(AllocTracker::Subsystem::MAX_FLOW)).mNumAllocs == 0);
+}
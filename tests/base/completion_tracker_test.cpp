@@ -0,0 +1,65 @@
+#include "lancet/base/completion_tracker.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+
+TEST_CASE("Completion frontier only moves when the lowest pending item is done", "[lancet][base][completion]") {
+  CompletionTracker tracker(5);
+  CHECK(tracker.Frontier() == 0);
+
+  CHECK_FALSE(tracker.MarkDone(2));
+  CHECK_FALSE(tracker.MarkDone(1));
+  CHECK(tracker.Frontier() == 0);
+
+  CHECK(tracker.MarkDone(0));
+  CHECK(tracker.Frontier() == 3);
+  CHECK_FALSE(tracker.MarkDone(0));
+  CHECK(tracker.NumDone() == 3);
+
+  CHECK(tracker.MarkDone(3));
+  CHECK_FALSE(tracker.IsAllDone());
+  CHECK(tracker.MarkDone(4));
+  CHECK(tracker.Frontier() == 5);
+  CHECK(tracker.IsAllDone());
+}
+
+TEST_CASE("Completion frontier matches a full rescan for random completion orders", "[lancet][base][completion]") {
+  static constexpr usize NUM_ITEMS = 2000;
+  std::vector<usize> order(NUM_ITEMS);
+  std::iota(order.begin(), order.end(), 0);
+
+  // Fixed seed, so that a failing completion order can be reproduced
+  static constexpr u64 SEED = 20240607;
+  std::mt19937_64 generator(SEED);
+  std::ranges::shuffle(order, generator);
+
+  CompletionTracker tracker(NUM_ITEMS);
+  std::vector<bool> expected(NUM_ITEMS, false);
+  for (const auto idx : order) {
+    tracker.MarkDone(idx);
+    expected[idx] = true;
+    const auto first_pending = std::ranges::find(expected, false) - expected.begin();
+    REQUIRE(tracker.Frontier() == static_cast<usize>(first_pending));
+  }
+
+  CHECK(tracker.IsAllDone());
+}
+
+TEST_CASE("Done ranges list contiguous runs of done items", "[lancet][base][completion]") {
+  CompletionTracker tracker(8);
+  for (const usize idx : {0, 1, 4, 5, 7}) {
+    tracker.MarkDone(idx);
+  }
+
+  using Range = std::pair<usize, usize>;
+  const std::vector<Range> expected{{0, 2}, {4, 6}, {7, 8}};
+  CHECK(tracker.DoneRanges() == expected);
+  CHECK(tracker.IsDone(4));
+  CHECK_FALSE(tracker.IsDone(3));
+}
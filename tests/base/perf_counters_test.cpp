@@ -0,0 +1,36 @@
+#include "lancet/base/perf_counters.h"
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+
+TEST_CASE("Counter deltas saturate at zero", "[lancet][base][PerfCounters]") {
+  PerfCounters::Values first;
+  first.Set(PerfCounters::Event::CYCLES, 100);
+  first.Set(PerfCounters::Event::INSTRUCTIONS, 50);
+
+  PerfCounters::Values second;
+  second.Set(PerfCounters::Event::CYCLES, 30);
+  second.Set(PerfCounters::Event::INSTRUCTIONS, 80);
+
+  auto delta = first;
+  delta -= second;
+  CHECK(delta.Get(PerfCounters::Event::CYCLES) == 70);
+  CHECK(delta.Get(PerfCounters::Event::INSTRUCTIONS) == 0);
+
+  delta += second;
+  CHECK(delta.Get(PerfCounters::Event::CYCLES) == 100);
+  CHECK(delta.Get(PerfCounters::Event::INSTRUCTIONS) == 80);
+  CHECK(delta.Get(PerfCounters::Event::LLC_MISSES) == 0);
+}
+
+TEST_CASE("Counters count instructions of the calling thread when available", "[lancet][base][PerfCounters]") {
+  // Counters are commonly not available in containers and CI runners
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (!PerfCounters::Enable().empty()) SKIP("perf_event_open is not available");
+
+  const PerfSpan span;
+  volatile u64 sum = 0;
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  for (u64 idx = 0; idx < 100000; ++idx) sum = sum + idx;
+  CHECK(span.Elapsed().Get(PerfCounters::Event::INSTRUCTIONS) > 0);
+}
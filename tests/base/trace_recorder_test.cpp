@@ -0,0 +1,110 @@
+#include "lancet/base/trace_recorder.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "catch_amalgamated.hpp"
+#include "lancet/base/timer.h"
+#include "lancet/base/types.h"
+
+namespace {
+
+// Writes the trace of all threads recorded so far, and returns it with one event on each line
+[[nodiscard]] auto WriteTraceLines() -> std::vector<std::string> {
+  const auto trace_path = std::filesystem::temp_directory_path() / "lancet_trace_recorder_test.json";
+  REQUIRE(TraceRecorder::WriteJson(trace_path));
+
+  std::vector<std::string> results;
+  std::ifstream trace_handle(trace_path);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  for (std::string line; std::getline(trace_handle, line);) results.emplace_back(line);
+  std::filesystem::remove(trace_path);
+  return results;
+}
+
+[[nodiscard]] auto CountContaining(const std::vector<std::string>& lines, std::string_view needle) -> usize {
+  return static_cast<usize>(
+      std::ranges::count_if(lines, [&needle](const std::string& line) { return absl::StrContains(line, needle); }));
+}
+
+// Thread id of the thread named `name` in the trace, as written in its metadata event
+[[nodiscard]] auto ThreadIdOf(const std::vector<std::string>& lines, std::string_view name) -> std::string {
+  const auto name_args = absl::StrCat(R"("args":{"name":")", name, R"("})");
+  const auto itr = std::ranges::find_if(lines, [&name_args](const std::string& line) {
+    return absl::StrContains(line, R"("name":"thread_name")") && absl::StrContains(line, name_args);
+  });
+  REQUIRE(itr != lines.end());
+  const auto tid_start = itr->find(R"("tid":)") + std::string_view(R"("tid":)").length();
+  return itr->substr(tid_start, itr->find(',', tid_start) - tid_start);
+}
+
+}  // namespace
+
+TEST_CASE("TraceRecorder writes events of each thread as Chrome trace JSON", "[lancet][base][TraceRecorder]") {
+  TraceRecorder::Enable();
+  std::jthread([] {
+    TraceRecorder::SetThreadName(R"(json "test")");
+    TraceRecorder::Record("JSON_EVENT", MonotonicNowNs(), MonotonicNowNs() + 1500, R"(1:100-200 "q")");
+  }).join();
+
+  const auto lines = WriteTraceLines();
+  REQUIRE(lines.size() >= 3);
+  CHECK(lines.front() == R"({"displayTimeUnit":"ms","traceEvents":[)");
+  CHECK(lines.back() == "]}");
+
+  // Quotes in thread names and details are escaped, and events are complete events of the named thread
+  const auto tid = ThreadIdOf(lines, R"(json \"test\")");
+  const auto event = std::ranges::find_if(lines, [](const std::string& line) {
+    return absl::StrContains(line, R"("name":"JSON_EVENT")");
+  });
+  REQUIRE(event != lines.end());
+  CHECK(absl::StrContains(*event, absl::StrCat(R"("cat":"lancet","ph":"X","pid":1,"tid":)", tid, ",")));
+  CHECK(absl::StrContains(*event, R"("dur":1.500,"args":{"detail":"1:100-200 \"q\""}})"));
+}
+
+TEST_CASE("TraceRecorder keeps only the most recent events of a thread", "[lancet][base][TraceRecorder]") {
+  static constexpr usize NUM_OVERWRITTEN = 10;
+  static constexpr usize NUM_RECORDED = TraceRecorder::EVENTS_PER_THREAD + NUM_OVERWRITTEN;
+  TraceRecorder::Enable();
+  std::jthread([] {
+    TraceRecorder::SetThreadName("wraparound");
+    for (usize idx = 0; idx < NUM_RECORDED; ++idx) {
+      const auto now_ns = MonotonicNowNs();
+      TraceRecorder::Record("WRAP_EVENT", now_ns, now_ns, std::to_string(idx));
+    }
+  }).join();
+
+  const auto lines = WriteTraceLines();
+  CHECK(CountContaining(lines, R"("name":"WRAP_EVENT")") == TraceRecorder::EVENTS_PER_THREAD);
+  CHECK(CountContaining(lines, R"("detail":"0"})") == 0);
+  CHECK(CountContaining(lines, absl::StrCat(R"("detail":")", NUM_OVERWRITTEN - 1, R"("})")) == 0);
+  CHECK(CountContaining(lines, absl::StrCat(R"("detail":")", NUM_OVERWRITTEN, R"("})")) == 1);
+  CHECK(CountContaining(lines, absl::StrCat(R"("detail":")", NUM_RECORDED - 1, R"("})")) == 1);
+}
+
+TEST_CASE("TraceRecorder reuses buffers of exited threads", "[lancet][base][TraceRecorder]") {
+  static constexpr usize NUM_POOLS = 4;
+  TraceRecorder::Enable();
+  const auto record_one = [] {
+    const TraceScope scope("REUSE_EVENT");
+  };
+
+  std::jthread(record_one).join();
+  const auto num_threads_before = CountContaining(WriteTraceLines(), R"("name":"thread_name")");
+
+  // Threads of one pool run at once, and each pool only starts once the previous pool exited
+  for (usize pool = 0; pool < NUM_POOLS; ++pool) {
+    std::jthread(record_one).join();
+  }
+
+  const auto lines = WriteTraceLines();
+  CHECK(CountContaining(lines, R"("name":"thread_name")") == num_threads_before);
+  CHECK(CountContaining(lines, R"("name":"REUSE_EVENT")") == NUM_POOLS + 1);
+}
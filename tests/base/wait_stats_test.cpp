@@ -0,0 +1,30 @@
+#include "lancet/base/wait_stats.h"
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+
+TEST_CASE("Waits are summed for each kind until reset", "[lancet][base][WaitStats]") {
+  constexpr auto LOCK_IDX = static_cast<usize>(WaitStats::Kind::STORE_LOCK);
+  constexpr auto FLUSH_IDX = static_cast<usize>(WaitStats::Kind::FLUSH);
+
+  WaitStats::Reset();
+  WaitStats::Record(WaitStats::Kind::STORE_LOCK, 100, 250);
+  WaitStats::Record(WaitStats::Kind::STORE_LOCK, 300, 350);
+
+  auto totals = WaitStats::Current();
+  CHECK(totals.at(LOCK_IDX).mNumWaits == 2);
+  CHECK(totals.at(LOCK_IDX).mWaitNs == 200);
+  CHECK(totals.at(FLUSH_IDX).mNumWaits == 0);
+
+  WaitStats::Enable();
+  {
+    const WaitScope flush_wait(WaitStats::Kind::FLUSH);
+  }
+  totals = WaitStats::Current();
+  CHECK(totals.at(FLUSH_IDX).mNumWaits == 1);
+
+  WaitStats::Reset();
+  totals = WaitStats::Current();
+  CHECK(totals.at(LOCK_IDX).mNumWaits == 0);
+  CHECK(totals.at(LOCK_IDX).mWaitNs == 0);
+}
@@ -0,0 +1,302 @@
+#include "benchmarks/read_simulator.h"
+
+#include <cctype>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "htslib/hts.h"
+#include "htslib/sam.h"
+}
+
+#include "absl/strings/ascii.h"
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+#include "lancet/hts/extractor.h"
+#include "lancet/hts/reference.h"
+#include "lancet_test_config.h"
+
+namespace {
+
+constexpr auto TEST_REF_NAME = "human_g1k_v37.1_1_90000000.fa.gz";
+constexpr auto TEST_REGION = "1:82950001-82960000";
+
+using HtsFile = std::unique_ptr<htsFile, lancet::hts::detail::HtsFileDeleter>;
+using SamHdr = std::unique_ptr<sam_hdr_t, lancet::hts::detail::SamHdrDeleter>;
+using Bam1 = std::unique_ptr<bam1_t, lancet::hts::detail::Bam1Deleter>;
+
+struct SimRecord {
+  std::string mQname;
+  u16 mFlag = 0;
+  i64 mPos0 = 0;
+  i64 mEndPos0 = 0;
+  std::vector<u32> mCigar;
+  std::string mSequence;
+  std::string mMdTag;
+
+  auto operator==(const SimRecord& rhs) const -> bool = default;
+};
+
+[[nodiscard]] auto MakeParams() -> ReadSimulator::Params {
+  ReadSimulator::Params params;
+  params.mRefPath = MakePath(TEST_DATA_DIR, TEST_REF_NAME);
+  params.mRegion = TEST_REGION;
+  return params;
+}
+
+[[nodiscard]] auto ReadRecords(const std::filesystem::path& path) -> std::vector<SimRecord> {
+  const HtsFile file(sam_open(path.c_str(), "r"));
+  REQUIRE(file != nullptr);
+  const SamHdr header(sam_hdr_read(file.get()));
+  REQUIRE(header != nullptr);
+
+  std::vector<SimRecord> results;
+  const Bam1 record(bam_init1());
+  while (sam_read1(file.get(), header.get(), record.get()) >= 0) {
+    const auto* rec = record.get();
+    SimRecord result{.mQname = bam_get_qname(rec),
+                     .mFlag = rec->core.flag,
+                     .mPos0 = rec->core.pos,
+                     .mEndPos0 = bam_endpos(rec)};
+
+    const auto* cigar = bam_get_cigar(rec);
+    result.mCigar.assign(cigar, cigar + rec->core.n_cigar);
+    const auto* seq = bam_get_seq(rec);
+    for (i32 idx = 0; idx < rec->core.l_qseq; ++idx) {
+      result.mSequence.push_back(seq_nt16_str[bam_seqi(seq, idx)]);
+    }
+
+    const auto* md_data = bam_aux_get(rec, "MD");
+    REQUIRE(md_data != nullptr);
+    result.mMdTag = bam_aux2Z(md_data);
+    results.emplace_back(std::move(result));
+  }
+  return results;
+}
+
+// Reference bases the read is aligned to, rebuilt from the aligned read bases and the MD tag. Returns nullopt
+// if the MD tag is malformed, does not cover every aligned base, or marks a mismatch where the bases match.
+[[nodiscard]] auto ReferenceFromMdTag(const SimRecord& read) -> std::optional<std::string> {
+  std::string aligned_bases;
+  usize query_idx = 0;
+  for (const auto unit : read.mCigar) {
+    const auto op = bam_cigar_op(unit);
+    const auto len = bam_cigar_oplen(unit);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (op == BAM_CMATCH) aligned_bases.append(read.mSequence, query_idx, len);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if ((bam_cigar_type(op) & 1) != 0) query_idx += len;
+  }
+
+  std::string result;
+  usize aligned_idx = 0;
+  usize md_idx = 0;
+  const auto& md_tag = read.mMdTag;
+  while (md_idx < md_tag.length()) {
+    if (std::isdigit(md_tag[md_idx]) != 0) {
+      usize num_matches = 0;
+      for (; md_idx < md_tag.length() && std::isdigit(md_tag[md_idx]) != 0; ++md_idx) {
+        num_matches = (num_matches * 10) + static_cast<usize>(md_tag[md_idx] - '0');
+      }
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (aligned_idx + num_matches > aligned_bases.length()) return std::nullopt;
+      result.append(aligned_bases, aligned_idx, num_matches);
+      aligned_idx += num_matches;
+      continue;
+    }
+
+    if (md_tag[md_idx] == '^') {
+      for (++md_idx; md_idx < md_tag.length() && std::isalpha(md_tag[md_idx]) != 0; ++md_idx) {
+        result.push_back(md_tag[md_idx]);
+      }
+      continue;
+    }
+
+    const auto is_mismatch = aligned_idx < aligned_bases.length() && aligned_bases[aligned_idx] != md_tag[md_idx];
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (!is_mismatch) return std::nullopt;
+    result.push_back(md_tag[md_idx]);
+    aligned_idx++;
+    md_idx++;
+  }
+
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (aligned_idx != aligned_bases.length()) return std::nullopt;
+  return result;
+}
+
+// True if the read aligns through the whole variant, with aligned reference bases on both sides of it
+[[nodiscard]] auto IsCovering(const SimRecord& read, const ReadSimulator::Variant& variant) -> bool {
+  const auto anchor_pos0 = static_cast<i64>(variant.mPos1 - 1);
+  return read.mPos0 <= anchor_pos0 && read.mEndPos0 > anchor_pos0 + static_cast<i64>(variant.mRefAllele.length());
+}
+
+// True if the read carries the alt allele, as the alt base of an SNV, or as an insertion or deletion of the
+// planted length right after the anchor base of an indel
+[[nodiscard]] auto HasAltAllele(const SimRecord& read, const ReadSimulator::Variant& variant) -> bool {
+  const auto anchor_pos0 = static_cast<i64>(variant.mPos1 - 1);
+  const auto ref_len = variant.mRefAllele.length();
+  const auto alt_len = variant.mAltAllele.length();
+
+  auto ref_pos0 = read.mPos0;
+  usize query_idx = 0;
+  for (const auto unit : read.mCigar) {
+    const auto op = bam_cigar_op(unit);
+    const auto len = bam_cigar_oplen(unit);
+    const auto is_after_anchor = ref_pos0 == anchor_pos0 + 1;
+    if (ref_len == alt_len && op == BAM_CMATCH && ref_pos0 <= anchor_pos0 && anchor_pos0 < ref_pos0 + len) {
+      return read.mSequence[query_idx + static_cast<usize>(anchor_pos0 - ref_pos0)] == variant.mAltAllele[0];
+    }
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (op == BAM_CINS && is_after_anchor && alt_len > ref_len) return len == alt_len - ref_len;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (op == BAM_CDEL && is_after_anchor && ref_len > alt_len) return len == ref_len - alt_len;
+
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if ((bam_cigar_type(op) & 1) != 0) query_idx += len;
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if ((bam_cigar_type(op) & 2) != 0) ref_pos0 += len;
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST_CASE("ReadSimulator simulates the same reads for the same seed", "[lancet][benchmarks][ReadSimulator]") {
+  auto params = MakeParams();
+  // NOLINTNEXTLINE(readability-magic-numbers)
+  params.mDuplicateRate = 0.1;
+  params.mNumStrExpansions = 2;
+
+  const auto out_dir = std::filesystem::temp_directory_path() / "lancet_read_simulator_seed_test";
+  std::filesystem::create_directories(out_dir);
+  const ReadSimulator first(params);
+  const ReadSimulator second(params);
+  REQUIRE(first.Write(out_dir / "tumor1.bam", out_dir / "normal1.bam").ok());
+  REQUIRE(second.Write(out_dir / "tumor2.bam", out_dir / "normal2.bam").ok());
+
+  const auto first_tumor = ReadRecords(out_dir / "tumor1.bam");
+  const auto first_normal = ReadRecords(out_dir / "normal1.bam");
+  CHECK_FALSE(first_tumor.empty());
+  CHECK_FALSE(first_normal.empty());
+  CHECK(first_tumor == ReadRecords(out_dir / "tumor2.bam"));
+  CHECK(first_normal == ReadRecords(out_dir / "normal2.bam"));
+
+  const auto first_variants = first.PlantedVariants();
+  const auto second_variants = second.PlantedVariants();
+  REQUIRE(first_variants.size() == second_variants.size());
+  for (usize idx = 0; idx < first_variants.size(); ++idx) {
+    CHECK(first_variants[idx].mPos1 == second_variants[idx].mPos1);
+    CHECK(first_variants[idx].mRefAllele == second_variants[idx].mRefAllele);
+    CHECK(first_variants[idx].mAltAllele == second_variants[idx].mAltAllele);
+    CHECK(first_variants[idx].mIsSomatic == second_variants[idx].mIsSomatic);
+  }
+
+  std::filesystem::remove_all(out_dir);
+}
+
+TEST_CASE("ReadSimulator writes CIGAR and MD tags consistent with the reference",
+          "[lancet][benchmarks][ReadSimulator]") {
+  auto params = MakeParams();
+  params.mNumStrExpansions = 2;
+  // Error rates are raised, so that reads have plenty of mismatches and indels that are not planted variants
+  // NOLINTBEGIN(readability-magic-numbers)
+  params.mErrors.mSubstitutionRate = 0.01;
+  params.mErrors.mInsertionRate = 0.005;
+  params.mErrors.mDeletionRate = 0.005;
+  // NOLINTEND(readability-magic-numbers)
+
+  const lancet::hts::Reference ref(params.mRefPath);
+  const auto region = ref.MakeRegion(TEST_REGION);
+  const auto region_start0 = static_cast<i64>(region.StartPos1() - 1);
+  auto ref_seq = std::string(region.SeqView());
+  absl::AsciiStrToUpper(&ref_seq);
+
+  const auto out_dir = std::filesystem::temp_directory_path() / "lancet_read_simulator_md_test";
+  std::filesystem::create_directories(out_dir);
+  const ReadSimulator simulator(params);
+  REQUIRE(simulator.Write(out_dir / "tumor.bam", out_dir / "normal.bam").ok());
+
+  for (const auto* bam_name : {"tumor.bam", "normal.bam"}) {
+    const auto reads = ReadRecords(out_dir / bam_name);
+    REQUIRE_FALSE(reads.empty());
+
+    usize num_bad_qlen = 0;
+    usize num_bad_md = 0;
+    for (const auto& read : reads) {
+      const auto query_len = bam_cigar2qlen(static_cast<int>(read.mCigar.size()), read.mCigar.data());
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (query_len != static_cast<i64>(read.mSequence.length())) num_bad_qlen++;
+
+      const auto ref_bases = ReferenceFromMdTag(read);
+      const auto ref_start = static_cast<usize>(read.mPos0 - region_start0);
+      const auto ref_len = static_cast<usize>(read.mEndPos0 - read.mPos0);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (!ref_bases || *ref_bases != ref_seq.substr(ref_start, ref_len)) num_bad_md++;
+    }
+
+    INFO("BAM: " << bam_name);
+    CHECK(num_bad_qlen == 0);
+    CHECK(num_bad_md == 0);
+  }
+
+  std::filesystem::remove_all(out_dir);
+}
+
+TEST_CASE("ReadSimulator plants alleles at the expected depth", "[lancet][benchmarks][ReadSimulator]") {
+  // Sequencing errors are disabled, so that somatic alleles are never seen in normal reads
+  static constexpr f64 DEPTH = 100.0;
+  static constexpr f64 TUMOR_PURITY = 0.8;
+  static constexpr f64 MAX_VAF_DIFF = 0.2;
+  auto params = MakeParams();
+  params.mTumorDepth = DEPTH;
+  params.mNormalDepth = DEPTH;
+  params.mTumorPurity = TUMOR_PURITY;
+  params.mNumStrExpansions = 2;
+  params.mErrors = {.mSubstitutionRate = 0.0, .mInsertionRate = 0.0, .mDeletionRate = 0.0};
+
+  const auto out_dir = std::filesystem::temp_directory_path() / "lancet_read_simulator_depth_test";
+  std::filesystem::create_directories(out_dir);
+  const ReadSimulator simulator(params);
+  REQUIRE(simulator.Write(out_dir / "tumor.bam", out_dir / "normal.bam").ok());
+  const auto tumor_reads = ReadRecords(out_dir / "tumor.bam");
+  const auto normal_reads = ReadRecords(out_dir / "normal.bam");
+
+  const auto variants = simulator.PlantedVariants();
+  REQUIRE_FALSE(variants.empty());
+
+  for (const auto& variant : variants) {
+    // Germline alleles are heterozygous in all cells, and somatic alleles in tumor cells only
+    const auto expected_tumor_vaf = variant.mIsSomatic ? TUMOR_PURITY / 2.0 : 0.5;
+    const auto expected_normal_vaf = variant.mIsSomatic ? 0.0 : 0.5;
+    for (const auto& [reads, expected_vaf] : {std::pair{&tumor_reads, expected_tumor_vaf},
+                                              std::pair{&normal_reads, expected_normal_vaf}}) {
+      usize num_covering = 0;
+      usize num_alt = 0;
+      for (const auto& read : *reads) {
+        // NOLINTNEXTLINE(readability-braces-around-statements)
+        if (!IsCovering(read, variant)) continue;
+        num_covering++;
+        // NOLINTNEXTLINE(readability-braces-around-statements)
+        if (HasAltAllele(read, variant)) num_alt++;
+      }
+
+      INFO("Variant: " << variant.mPos1 << " " << variant.mRefAllele << ">" << variant.mAltAllele
+                       << (variant.mIsSomatic ? " somatic" : " germline") << ", covering reads: " << num_covering
+                       << ", alt reads: " << num_alt);
+      REQUIRE(num_covering > 0);
+      CHECK(static_cast<f64>(num_covering) >= DEPTH / 2.0);
+      CHECK(static_cast<f64>(num_covering) <= DEPTH * 1.5);
+
+      const auto vaf = static_cast<f64>(num_alt) / static_cast<f64>(num_covering);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (expected_vaf == 0.0) CHECK(num_alt == 0);
+      CHECK(vaf == Catch::Approx(expected_vaf).margin(MAX_VAF_DIFF));
+    }
+  }
+
+  std::filesystem::remove_all(out_dir);
+}
@@ -0,0 +1,58 @@
+#include "lancet/caller/variant_call.h"
+
+#include <string>
+#include <string_view>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+#include "lancet/caller/raw_variant.h"
+
+using namespace lancet::caller;
+
+namespace {
+
+// Serialized somatic deletion with one normal and one tumor sample, as written by `VariantCall::Serialize`
+constexpr std::string_view SERIALIZED_DEL =
+    "12345678901234\t0\t82965432\t87\t1\tCTTA\tC\t-3\t47.318000000000005\t2\t2\t"
+    "TUMOR;TYPE=DEL;LENGTH=3;KMERLEN=31\tGT:AD:DP:VAF\t0/0:40,0:40:0.0\t0/1:30,17:47:0.3617";
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("VariantCall round trips through its serialized line", "[lancet][caller][VariantCall]") {
+  const auto parsed = VariantCall::Deserialize(SERIALIZED_DEL);
+  REQUIRE(parsed.ok());
+  const auto& call = **parsed;
+
+  CHECK(call.Identifier() == 12345678901234);
+  CHECK(call.ChromIndex() == 0);
+  CHECK(call.ChromName() == "1");
+  CHECK(call.StartPos1() == 82965432);
+  CHECK(call.TotalCoverage() == 87);
+  CHECK(call.RefAllele() == "CTTA");
+  CHECK(call.AltAllele() == "C");
+  CHECK(call.Length() == -3);
+  CHECK(call.Quality() == 47.318000000000005);
+  CHECK(call.State() == RawVariant::State::TUMOR);
+  CHECK(call.Category() == RawVariant::Type::DEL);
+  CHECK(call.NumSamples() == 2);
+
+  // Quality is written with all of its digits, so serializing again gives back the exact same line
+  CHECK(call.Serialize() == SERIALIZED_DEL);
+  const auto reparsed = VariantCall::Deserialize(call.Serialize());
+  REQUIRE(reparsed.ok());
+  CHECK(**reparsed == call);
+  CHECK((*reparsed)->AsVcfRecord() == call.AsVcfRecord());
+  CHECK(call.AsVcfRecord() ==
+        "1\t82965432\t.\tCTTA\tC\t47.32\t.\tTUMOR;TYPE=DEL;LENGTH=3;KMERLEN=31\tGT:AD:DP:VAF\t0/0:40,0:40:0.0\t"
+        "0/1:30,17:47:0.3617");
+}
+
+TEST_CASE("VariantCall rejects malformed serialized lines", "[lancet][caller][VariantCall]") {
+  CHECK_FALSE(VariantCall::Deserialize("").ok());
+  CHECK_FALSE(VariantCall::Deserialize("1\t0\t100\t10\t1\tA\tG\t1\t30.0\t2\t0").ok());
+
+  std::string bad_number(SERIALIZED_DEL);
+  bad_number.replace(bad_number.find("82965432"), 8, "8296543x");
+  CHECK_FALSE(VariantCall::Deserialize(bad_number).ok());
+}
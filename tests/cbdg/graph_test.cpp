@@ -0,0 +1,86 @@
+#include "lancet/cbdg/graph.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+#include "lancet/cbdg/label.h"
+#include "lancet/cbdg/read.h"
+#include "lancet/hts/reference.h"
+#include "lancet_test_config.h"
+
+using namespace lancet::cbdg;
+
+namespace {
+
+constexpr auto TEST_REF_NAME = "human_g1k_v37.1_1_90000000.fa.gz";
+// Non repetitive 600bp of the bundled reference, so that assembly is tried with the very first k value
+constexpr auto TEST_REGION = "1:82965001-82965600";
+
+constexpr usize READ_LENGTH = 100;
+constexpr usize READ_STEP = 4;
+constexpr usize SNV_OFFSET = 300;
+constexpr u8 BASE_QUAL = 40;
+constexpr u8 MAP_QUAL = 60;
+
+// Reads tiling the whole region, with every other read carrying a SNV at `SNV_OFFSET`, so that the graph
+// has one bubble with a reference and an alternate path between the source and sink anchors
+[[nodiscard]] auto MakeTilingReads(const lancet::hts::Reference::Region& region) -> std::vector<Read> {
+  const std::string ref_seq(region.SeqView());
+  std::vector<Read> results;
+  for (usize start = 0; start + READ_LENGTH <= ref_seq.length(); start += READ_STEP) {
+    auto sequence = ref_seq.substr(start, READ_LENGTH);
+    const auto read_num = results.size();
+    const auto covers_snv = start <= SNV_OFFSET && SNV_OFFSET < start + READ_LENGTH;
+    if (covers_snv && read_num % 2 == 1) {
+      auto& base = sequence[SNV_OFFSET - start];
+      base = base == 'A' ? 'C' : 'A';
+    }
+
+    results.emplace_back(Read::Fields{
+        .mStart0 = static_cast<i64>(region.StartPos1() - 1 + start),
+        .mChromIdx = static_cast<i32>(region.ChromIndex()),
+        .mMapQual = MAP_QUAL,
+        .mTag = read_num % 2 == 1 ? Label::TUMOR : Label::NORMAL,
+        .mQname = "read" + std::to_string(read_num),
+        .mSequence = std::move(sequence),
+        .mSampleName = read_num % 2 == 1 ? "tumor" : "normal",
+        .mQuality = std::vector<u8>(READ_LENGTH, BASE_QUAL),
+    });
+  }
+  return results;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("Graph defers windows once traversals exceed the visit budget", "[lancet][cbdg][Graph]") {
+  const lancet::hts::Reference ref(MakePath(TEST_DATA_DIR, TEST_REF_NAME));
+  const auto region = std::make_shared<const lancet::hts::Reference::Region>(ref.MakeRegion(TEST_REGION));
+  const auto reads = MakeTilingReads(*region);
+
+  SECTION("Unlimited budget assembles the alternate haplotype") {
+    Graph graph(Graph::Params{});
+    const auto result = graph.BuildComponentHaplotypes(region, reads);
+    CHECK_FALSE(result.mIsOverBudget);
+    REQUIRE(result.mGraphHaplotypes.size() == 1);
+    CHECK(result.mGraphHaplotypes.front().size() >= 2);
+    CHECK(result.mKmerAttempts.back().mOutcome == Graph::KmerOutcome::ASSEMBLED);
+  }
+
+  SECTION("Budget smaller than one traversal returns no haplotypes") {
+    Graph::Params params;
+    params.mWindowVisitBudget = 1;
+    Graph graph(params);
+    const auto result = graph.BuildComponentHaplotypes(region, reads);
+    CHECK(result.mIsOverBudget);
+    CHECK(result.mGraphHaplotypes.empty());
+    REQUIRE_FALSE(result.mKmerAttempts.empty());
+    CHECK(result.mKmerAttempts.back().mOutcome == Graph::KmerOutcome::OVER_BUDGET);
+    // Over budget windows stop right away instead of trying any larger k value
+    CHECK(result.mKmerAttempts.back().mKmerLen == Graph::DEFAULT_MIN_KMER_LEN);
+  }
+}
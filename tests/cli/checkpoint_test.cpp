@@ -0,0 +1,78 @@
+#include "lancet/cli/checkpoint.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+
+using lancet::cli::Checkpoint;
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("Checkpoint round trips through its file", "[lancet][cli][Checkpoint]") {
+  const auto out_vcf = std::filesystem::temp_directory_path() / "lancet_checkpoint_test.vcf.gz";
+  const auto path = Checkpoint::PathForOutput(out_vcf);
+  CHECK(path.filename() == "lancet_checkpoint_test.vcf.gz.checkpoint");
+  std::filesystem::remove(path);
+
+  static constexpr i64 VCF_OFFSET = 123456789LL << 16;
+  const std::vector<Checkpoint::IndexRange> done_ranges{{0, 120}, {122, 130}, {500, 501}};
+  const std::vector<std::string> variants{"1\t0\t100\t10\t1\tA\tG\t1\t30.5\t2\t0\tTUMOR\tGT\t0/1",
+                                          "2\t0\t200\t10\t1\tAT\tA\t-1\t12.25\t0\t2\tSHARED\tGT\t0/1"};
+  const Checkpoint written(1000, VCF_OFFSET, done_ranges, variants);
+  REQUIRE(written.Write(path).ok());
+
+  auto tmp_path = path;
+  tmp_path += ".tmp";
+  CHECK_FALSE(std::filesystem::exists(tmp_path));
+
+  const auto loaded = Checkpoint::Read(path);
+  REQUIRE(loaded.ok());
+  CHECK(loaded->NumWindows() == 1000);
+  CHECK(loaded->VcfOffset() == VCF_OFFSET);
+  CHECK(loaded->DoneRanges() == done_ranges);
+  CHECK(loaded->Variants() == variants);
+
+  SECTION("Writing again replaces the earlier checkpoint") {
+    const Checkpoint later(1000, VCF_OFFSET * 2, {{0, 600}}, {});
+    REQUIRE(later.Write(path).ok());
+    const auto reloaded = Checkpoint::Read(path);
+    REQUIRE(reloaded.ok());
+    CHECK(reloaded->VcfOffset() == VCF_OFFSET * 2);
+    CHECK(reloaded->DoneRanges().size() == 1);
+    CHECK(reloaded->Variants().empty());
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Checkpoint rejects missing and corrupt files", "[lancet][cli][Checkpoint]") {
+  const auto path = std::filesystem::temp_directory_path() / "lancet_checkpoint_corrupt_test.checkpoint";
+  std::filesystem::remove(path);
+  CHECK(Checkpoint::Read(path).status().code() == absl::StatusCode::kNotFound);
+
+  const auto write_lines = [&path](const std::string& contents) {
+    std::ofstream fhandle(path, std::ios_base::out | std::ios_base::trunc);
+    fhandle << contents;
+  };
+
+  write_lines("##not_a_checkpoint\n");
+  CHECK(Checkpoint::Read(path).status().code() == absl::StatusCode::kDataLoss);
+
+  // Empty or inverted done ranges and unknown lines are parse errors
+  write_lines("##lancet_checkpoint=1\nNUM_WINDOWS\t10\nVCF_OFFSET\t0\nDONE\t5\t5\n");
+  CHECK(Checkpoint::Read(path).status().code() == absl::StatusCode::kDataLoss);
+  write_lines("##lancet_checkpoint=1\nNUM_WINDOWS\t10\nVCF_OFFSET\t0\nUNKNOWN\t1\n");
+  CHECK(Checkpoint::Read(path).status().code() == absl::StatusCode::kDataLoss);
+
+  // Checkpoints cut short before the VCF offset was written are incomplete
+  write_lines("##lancet_checkpoint=1\nNUM_WINDOWS\t10\n");
+  CHECK(Checkpoint::Read(path).status().code() == absl::StatusCode::kDataLoss);
+
+  write_lines("##lancet_checkpoint=1\nNUM_WINDOWS\t10\nVCF_OFFSET\t0\nDONE\t0\t4\n");
+  CHECK(Checkpoint::Read(path).ok());
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,69 @@
+#include "lancet/cli/metrics_exporter.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include "absl/strings/match.h"
+#include "absl/time/time.h"
+#include "catch_amalgamated.hpp"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window_timings.h"
+
+using lancet::cli::MetricsExporter;
+using lancet::core::VariantBuilder;
+using lancet::core::WindowTimings;
+
+TEST_CASE("MetricsExporter formats progress as OpenMetrics gauges", "[lancet][cli][MetricsExporter]") {
+  const MetricsExporter::Progress progress{
+      .mNumTotalWindows = 10,
+      .mNumDoneWindows = 4,
+      .mWindowsPerSecond = std::numeric_limits<f64>::infinity(),
+      .mEta = absl::Seconds(12),
+      .mElapsed = absl::Seconds(3),
+      .mNumStoredVariants = 7,
+      .mResidentBytes = 1024,
+  };
+
+  MetricsExporter::StatusCounts counts;
+  counts[VariantBuilder::StatusCode::FOUND_GENOTYPED_VARIANT] = 3;
+  counts[VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION] = 1;
+
+  WindowTimings timings;
+  timings.Add(WindowTimings::Stage::GRAPH_BUILD, absl::Milliseconds(1500));
+  lancet::core::WindowTimingStats timing_stats;
+  timing_stats.Add(timings);
+
+  const auto result = MetricsExporter::Format(progress, counts, timing_stats);
+  CHECK(absl::StrContains(result, "# TYPE lancet_windows gauge\n"));
+  CHECK(absl::StrContains(result, "lancet_windows{state=\"done\"} 4\n"));
+  CHECK(absl::StrContains(result, "lancet_windows{state=\"remaining\"} 6\n"));
+  CHECK(absl::StrContains(result, "lancet_window_results{status=\"FOUND_GENOTYPED_VARIANT\"} 3\n"));
+  CHECK(absl::StrContains(result, "lancet_windows_per_second +Inf\n"));
+  CHECK(absl::StrContains(result, "lancet_eta_seconds 12\n"));
+  CHECK(absl::StrContains(result, "lancet_variant_store_variants 7\n"));
+  CHECK(absl::StrContains(result, "lancet_resident_memory_bytes 1024\n"));
+  CHECK(absl::StrContains(result, "lancet_stage_seconds{stage=\"GRAPH_BUILD\"} 1.5\n"));
+  CHECK(absl::StrContains(result, "lancet_stage_seconds{stage=\"GENOTYPE\"} 0\n"));
+  CHECK(absl::EndsWith(result, "# EOF\n"));
+}
+
+TEST_CASE("MetricsExporter replaces the metrics file", "[lancet][cli][MetricsExporter]") {
+  const auto metrics_path = std::filesystem::temp_directory_path() / "lancet_metrics_exporter_test.prom";
+  const MetricsExporter exporter(metrics_path);
+  const lancet::core::WindowTimingStats timing_stats;
+
+  CHECK(exporter.Write({.mNumTotalWindows = 2}, {}, timing_stats).ok());
+  CHECK(exporter.Write({.mNumTotalWindows = 2, .mNumDoneWindows = 2}, {}, timing_stats).ok());
+
+  std::ifstream fhandle(metrics_path);
+  const std::string contents{std::istreambuf_iterator<char>(fhandle), std::istreambuf_iterator<char>()};
+  CHECK(absl::StrContains(contents, "lancet_windows{state=\"remaining\"} 0\n"));
+  // Temporary file is named after the writing process, so processes sharing one metrics file never collide
+  CHECK_FALSE(std::filesystem::exists(std::filesystem::path(metrics_path) += "." + std::to_string(getpid()) + ".tmp"));
+  std::filesystem::remove(metrics_path);
+}
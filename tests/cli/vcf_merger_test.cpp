@@ -0,0 +1,92 @@
+#include "lancet/cli/vcf_merger.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "htslib/bgzf.h"
+#include "htslib/kstring.h"
+#include "lancet/base/types.h"
+#include "lancet/hts/bgzf_ostream.h"
+
+namespace {
+
+constexpr auto TEST_VCF_HEADER =
+    "##fileformat=VCFv4.3\n##contig=<ID=chr1,length=1000>\n##contig=<ID=chr2,length=1000>\n"
+    "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tNORMAL\tTUMOR\n";
+
+void WriteTestVcf(const std::filesystem::path& path, const std::vector<std::string>& records) {
+  lancet::hts::BgzfOstream out_vcf;
+  REQUIRE(out_vcf.Open(path, lancet::hts::BgzfFormat::VCF));
+  out_vcf << TEST_VCF_HEADER;
+  for (const auto& record : records) {
+    out_vcf << record << '\n';
+  }
+  out_vcf.Close();
+}
+
+[[nodiscard]] auto ReadRecords(const std::filesystem::path& path) -> std::vector<std::string> {
+  std::vector<std::string> results;
+  BGZF* handle = bgzf_open(path.c_str(), "r");
+  REQUIRE(handle != nullptr);
+  kstring_t line = KS_INITIALIZE;
+  while (bgzf_getline(handle, '\n', &line) >= 0) {
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (line.l > 0 && line.s[0] != '#') results.emplace_back(line.s, line.l);
+  }
+  ks_free(&line);
+  bgzf_close(handle);
+  return results;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("VcfMerger merges sorted inputs and deduplicates variants", "[lancet][cli][VcfMerger]") {
+  const auto tmp_dir = std::filesystem::temp_directory_path();
+  const auto first_vcf = tmp_dir / "lancet_vcf_merger_test.first.vcf.gz";
+  const auto second_vcf = tmp_dir / "lancet_vcf_merger_test.second.vcf.gz";
+  const auto merged_vcf = tmp_dir / "lancet_vcf_merger_test.merged.vcf.gz";
+
+  const std::string only_first = "chr1\t100\t.\tA\tT\t50.00\t.\tSOMATIC\tGT:AD:DP\t0/0:10,0:10\t0/1:8,4:12";
+  const std::string kept_dup = "chr1\t200\t.\tC\tG\t40.00\t.\tSOMATIC\tGT:AD:DP\t0/0:10,0:10\t0/1:8,4:12";
+  const std::string lower_qual_dup = "chr1\t200\t.\tC\tG\t30.00\t.\tSOMATIC\tGT:AD:DP\t0/0:20,0:20\t0/1:8,4:12";
+  const std::string replaced_dup = "chr2\t50\t.\tG\tGA\t10.00\t.\tSOMATIC\tGT:AD:DP\t0/0:5,0:5\t0/1:3,2:5";
+  const std::string better_dup = "chr2\t50\t.\tG\tGA\t20.00\t.\tSOMATIC\tGT:AD:DP\t0/0:9,0:9\t0/1:5,4:9";
+  const std::string only_second = "chr1\t300\t.\tT\tA\t60.00\t.\tSOMATIC\tGT:AD:DP\t0/0:10,0:10\t0/1:8,4:12";
+
+  WriteTestVcf(first_vcf, {only_first, kept_dup, replaced_dup});
+  WriteTestVcf(second_vcf, {lower_qual_dup, only_second, better_dup});
+
+  lancet::cli::VcfMerger merger({.mInVcfs = {first_vcf, second_vcf}, .mOutVcfGz = merged_vcf});
+  const auto num_written = merger.Merge();
+  REQUIRE(num_written.ok());
+  CHECK(*num_written == 4);
+
+  // Higher coverage alone does not replace a kept record, both coverage and quality must be higher
+  const std::vector<std::string> expected = {only_first, kept_dup, only_second, better_dup};
+  CHECK(ReadRecords(merged_vcf) == expected);
+
+  for (const auto& path : {first_vcf, second_vcf, merged_vcf}) {
+    std::filesystem::remove(path);
+    std::filesystem::remove(std::filesystem::path(path) += ".tbi");
+  }
+}
+
+TEST_CASE("VcfMerger rejects unsorted inputs", "[lancet][cli][VcfMerger]") {
+  const auto tmp_dir = std::filesystem::temp_directory_path();
+  const auto input_vcf = tmp_dir / "lancet_vcf_merger_unsorted_test.vcf.gz";
+  const auto merged_vcf = tmp_dir / "lancet_vcf_merger_unsorted_test.merged.vcf.gz";
+
+  WriteTestVcf(input_vcf, {"chr2\t50\t.\tG\tA\t10.00\t.\tSOMATIC\tGT:DP\t0/0:5\t0/1:5",
+                           "chr1\t50\t.\tG\tA\t10.00\t.\tSOMATIC\tGT:DP\t0/0:5\t0/1:5"});
+
+  lancet::cli::VcfMerger merger({.mInVcfs = {input_vcf}, .mOutVcfGz = merged_vcf});
+  CHECK_FALSE(merger.Merge().ok());
+
+  for (const auto& path : {input_vcf, merged_vcf}) {
+    std::filesystem::remove(path);
+    std::filesystem::remove(std::filesystem::path(path) += ".tbi");
+  }
+}
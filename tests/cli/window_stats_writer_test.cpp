@@ -0,0 +1,135 @@
+#include "lancet/cli/window_stats_writer.h"
+
+#include <array>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+extern "C" {
+#include "htslib/bgzf.h"
+}
+
+#include "absl/strings/str_split.h"
+#include "absl/time/time.h"
+#include "catch_amalgamated.hpp"
+#include "lancet/base/alloc_tracker.h"
+#include "lancet/base/types.h"
+#include "lancet/cbdg/graph.h"
+#include "lancet/core/async_worker.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window_builder.h"
+#include "lancet_test_config.h"
+
+using lancet::cli::WindowStatsWriter;
+using lancet::core::AsyncWorker;
+using lancet::core::VariantBuilder;
+
+namespace {
+
+constexpr auto TEST_REF_NAME = "human_g1k_v37.1_1_90000000.fa.gz";
+constexpr usize NUM_COLUMNS = 18;
+
+[[nodiscard]] auto ReadDecompressed(const std::filesystem::path& path) -> std::string {
+  BGZF* bgzf_ptr = bgzf_open(path.c_str(), "r");
+  REQUIRE(bgzf_ptr != nullptr);
+
+  static constexpr usize BUFFER_SIZE = 4096;
+  std::array<char, BUFFER_SIZE> buffer{};
+  std::string result;
+  auto num_read = bgzf_read(bgzf_ptr, buffer.data(), buffer.size());
+  while (num_read > 0) {
+    result.append(buffer.data(), static_cast<usize>(num_read));
+    num_read = bgzf_read(bgzf_ptr, buffer.data(), buffer.size());
+  }
+
+  bgzf_close(bgzf_ptr);
+  return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("WindowStatsWriter writes one row per window result", "[lancet][cli][WindowStatsWriter]") {
+  using lancet::cbdg::Graph;
+  using lancet::core::WindowBuilder;
+  WindowBuilder builder(MakePath(TEST_DATA_DIR, TEST_REF_NAME), WindowBuilder::Params{});
+  builder.AddRegion("1:82960000-82961000");
+  auto generator = builder.MakeGenerator();
+  const auto first_window = generator.Next();
+  const auto second_window = generator.Next();
+  REQUIRE(first_window != nullptr);
+  REQUIRE(second_window != nullptr);
+
+  // Skipped window that never reached assembly, so all assembly fields are missing
+  AsyncWorker::Result skipped;
+  skipped.mStatus = VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION;
+  skipped.mRuntime = absl::Microseconds(250);
+  skipped.mTelemetry.mSampleReads = {{.mSampleName = "normal", .mNumCollected = 12, .mNumSampled = 10},
+                                     {.mSampleName = "tumor", .mNumCollected = 15, .mNumSampled = 15}};
+
+  AsyncWorker::Result assembled;
+  assembled.mStatus = VariantBuilder::StatusCode::FOUND_GENOTYPED_VARIANT;
+  assembled.mRuntime = absl::Milliseconds(3);
+  assembled.mTelemetry.mSampleReads = skipped.mTelemetry.mSampleReads;
+  assembled.mTelemetry.mKmerAttempts = {
+      {.mKmerLen = 11, .mOutcome = Graph::KmerOutcome::CYCLE},
+      {.mKmerLen = 13,
+       .mOutcome = Graph::KmerOutcome::ASSEMBLED,
+       .mNumNodesBuilt = 400,
+       .mNumEdgesBuilt = 410,
+       .mNumNodesPruned = 380,
+       .mNumEdgesPruned = 385,
+       .mNumComponents = 1},
+  };
+  assembled.mTelemetry.mNumHaplotypes = 3;
+  assembled.mTelemetry.mMsaWidth = 620;
+  assembled.mTelemetry.mNumVariants = 2;
+  assembled.mAllocs.at(static_cast<usize>(AllocTracker::Subsystem::GRAPH)) = {
+      .mNumAllocs = 7, .mNumBytes = 4096, .mPeakBytes = 2048};
+
+  const auto out_path = std::filesystem::temp_directory_path() / "lancet_window_stats_writer_test.tsv.gz";
+  WindowStatsWriter writer;
+  REQUIRE(writer.Open(out_path));
+  writer.Write(*first_window, skipped);
+  writer.Write(*second_window, assembled);
+  writer.Close();
+
+  const auto contents = ReadDecompressed(out_path);
+  const std::vector<std::string_view> lines = absl::StrSplit(contents, '\n', absl::SkipEmpty());
+  REQUIRE(lines.size() == 3);
+
+  const std::vector<std::string_view> header = absl::StrSplit(lines[0], '\t');
+  REQUIRE(header.size() == NUM_COLUMNS);
+  CHECK(header.front() == "#region");
+  CHECK(header[6] == "final_k");
+  CHECK(header.back() == "alloc_peak_bytes");
+
+  const std::vector<std::string> expected_skipped{
+      first_window->ToSamtoolsRegion(), "SKIPPED_INACTIVE_REGION", "250", "normal:12,tumor:15", "normal:10,tumor:15",
+      ".", ".", ".", ".", ".", ".", ".", ".", ".", ".", ".", ".", "."};
+  const std::vector<std::string> expected_assembled{second_window->ToSamtoolsRegion(),
+                                                    "FOUND_GENOTYPED_VARIANT",
+                                                    "3000",
+                                                    "normal:12,tumor:15",
+                                                    "normal:10,tumor:15",
+                                                    "11:CYCLE,13:ASSEMBLED",
+                                                    "13",
+                                                    "400",
+                                                    "410",
+                                                    "380",
+                                                    "385",
+                                                    "1",
+                                                    "3",
+                                                    "620",
+                                                    "2",
+                                                    "GRAPH:7",
+                                                    "GRAPH:4096",
+                                                    "GRAPH:2048"};
+
+  const std::vector<std::string> skipped_row = absl::StrSplit(lines[1], '\t');
+  const std::vector<std::string> assembled_row = absl::StrSplit(lines[2], '\t');
+  CHECK(skipped_row == expected_skipped);
+  CHECK(assembled_row == expected_assembled);
+  std::filesystem::remove(out_path);
+}
@@ -0,0 +1,78 @@
+#include "lancet/cli/work_ledger.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <optional>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+
+using lancet::cli::WorkLedger;
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("WorkLedger hands out every block exactly once", "[lancet][cli][WorkLedger]") {
+  const auto ledger_path = std::filesystem::temp_directory_path() / "lancet_work_ledger_test.ledger";
+  std::filesystem::remove(ledger_path);
+
+  WorkLedger first(ledger_path, 3);
+  WorkLedger second(ledger_path, 3);
+  CHECK(first.ClaimNextBlock().value() == std::optional<usize>(0));
+  CHECK(second.ClaimNextBlock().value() == std::optional<usize>(1));
+  CHECK(first.ClaimNextBlock().value() == std::optional<usize>(2));
+  CHECK_FALSE(second.ClaimNextBlock().value().has_value());
+
+  // Stitching is claimed only once every block is done, and only by one running process
+  CHECK(second.MarkDone(1).ok());
+  CHECK(first.MarkDone(2).ok());
+  CHECK_FALSE(second.ClaimStitch().value());
+  CHECK(first.MarkDone(0).ok());
+  CHECK(second.ClaimStitch().value());
+  CHECK_FALSE(first.ClaimStitch().value());
+
+  WorkLedger mismatched(ledger_path, 4);
+  CHECK_FALSE(mismatched.ClaimNextBlock().ok());
+  std::filesystem::remove(ledger_path);
+}
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("WorkLedger claims blocks and stitching of exited processes again", "[lancet][cli][WorkLedger]") {
+  const auto ledger_path = std::filesystem::temp_directory_path() / "lancet_work_ledger_stale_test.ledger";
+  std::filesystem::remove(ledger_path);
+
+  const auto child_pid = fork();
+  REQUIRE(child_pid >= 0);
+  // NOLINTNEXTLINE(readability-braces-around-statements)
+  if (child_pid == 0) _exit(0);
+  waitpid(child_pid, nullptr, 0);
+
+  static constexpr usize MAX_HOST_NAME_LEN = 256;
+  std::array<char, MAX_HOST_NAME_LEN> host_name{};
+  REQUIRE(gethostname(host_name.data(), host_name.size() - 1) == 0);
+
+  {
+    std::ofstream ledger_file(ledger_path);
+    ledger_file << "##lancet_work_ledger=1\nNUM_BLOCKS\t2\n";
+    ledger_file << "CLAIM\t0\t" << host_name.data() << "\t" << child_pid << "\n";
+  }
+
+  WorkLedger ledger(ledger_path, 2);
+  CHECK(ledger.ClaimNextBlock().value() == std::optional<usize>(0));
+  CHECK(ledger.ClaimNextBlock().value() == std::optional<usize>(1));
+  CHECK_FALSE(ledger.ClaimNextBlock().value().has_value());
+
+  // Stitching process exited before writing the output, so stitching is claimed again
+  REQUIRE(ledger.MarkDone(0).ok());
+  REQUIRE(ledger.MarkDone(1).ok());
+  {
+    std::ofstream ledger_file(ledger_path, std::ios_base::app);
+    ledger_file << "STITCH\t" << host_name.data() << "\t" << child_pid << "\n";
+  }
+  CHECK(ledger.ClaimStitch().value());
+  CHECK_FALSE(ledger.ClaimStitch().value());
+  std::filesystem::remove(ledger_path);
+}
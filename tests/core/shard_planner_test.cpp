@@ -0,0 +1,111 @@
+#include "lancet/core/shard_planner.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+#include "lancet/cbdg/graph.h"
+#include "lancet/core/read_collector.h"
+#include "lancet/core/window_builder.h"
+#include "lancet/core/window_cost_model.h"
+#include "lancet_test_config.h"
+
+using namespace lancet::core;
+
+namespace {
+
+constexpr auto TEST_REF_NAME = "human_g1k_v37.1_1_90000000.fa.gz";
+constexpr auto TEST_BAM_NAME = "human_g1k_v37.no_mutations.1_82960000_82970000.bam";
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("ShardPlanner partitions windows into contiguous cost balanced shards", "[lancet][core][ShardPlanner]") {
+  const auto ref_path = MakePath(TEST_DATA_DIR, TEST_REF_NAME);
+  WindowBuilder builder(ref_path, WindowBuilder::Params{});
+  // Includes the leading N bases of chr1, which have no predicted cost, and the region with alignments
+  builder.AddBatchRegions(std::vector<std::string>{"1:1-2000000", "1:82000000-84000000"});
+  const auto windows = builder.MakeGenerator();
+
+  ReadCollector::Params rc_params;
+  rc_params.mRefPath = ref_path;
+  rc_params.mNormalPaths = {MakePath(TEST_DATA_DIR, TEST_BAM_NAME)};
+  rc_params.mTumorPaths = {MakePath(TEST_DATA_DIR, TEST_BAM_NAME)};
+  const WindowCostModel model(rc_params, lancet::cbdg::Graph::Params{});
+  const ShardPlanner planner(windows, model);
+
+  const auto num_windows = windows.NumTotal();
+  const auto num_blocks = planner.NumBlocks();
+  REQUIRE(num_blocks >= 8);
+
+  f64 total_cost = 0.0;
+  f64 max_block_cost = 0.0;
+  for (usize block_idx = 0; block_idx < num_blocks; ++block_idx) {
+    const auto [first, last] = planner.BlockRange(block_idx);
+    CHECK(first < last);
+    CHECK(last - first <= ShardPlanner::WINDOWS_PER_BLOCK);
+    // NOLINTNEXTLINE(readability-braces-around-statements)
+    if (block_idx > 0) CHECK(first == planner.BlockRange(block_idx - 1).second);
+    total_cost += planner.BlockCost(block_idx);
+    max_block_cost = std::max(max_block_cost, planner.BlockCost(block_idx));
+  }
+  CHECK(planner.BlockRange(0).first == 0);
+  CHECK(planner.BlockRange(num_blocks - 1).second == num_windows);
+  REQUIRE(total_cost > 0.0);
+
+  for (const usize num_shards : {1, 3, 4}) {
+    CAPTURE(num_shards);
+    const auto shards = planner.Partition(num_shards);
+    REQUIRE(shards.size() == num_shards);
+
+    // Shards are contiguous and cover every window exactly once
+    CHECK(shards.front().first == 0);
+    CHECK(shards.back().second == num_windows);
+    for (usize idx = 1; idx < num_shards; ++idx) {
+      CHECK(shards[idx - 1].second == shards[idx].first);
+    }
+
+    // Every shard cost is within one block of an equal share of the total cost
+    const auto fair_share = total_cost / static_cast<f64>(num_shards);
+    usize block_idx = 0;
+    for (const auto& [first, last] : shards) {
+      f64 shard_cost = 0.0;
+      while (block_idx < num_blocks && planner.BlockRange(block_idx).second <= last) {
+        CHECK(planner.BlockRange(block_idx).first >= first);
+        shard_cost += planner.BlockCost(block_idx);
+        block_idx++;
+      }
+      CHECK(shard_cost >= fair_share - max_block_cost);
+      CHECK(shard_cost <= fair_share + max_block_cost);
+    }
+    CHECK(block_idx == num_blocks);
+  }
+}
+
+TEST_CASE("ShardPlanner gives ordered empty shards when there are fewer blocks than shards",
+          "[lancet][core][ShardPlanner]") {
+  const auto ref_path = MakePath(TEST_DATA_DIR, TEST_REF_NAME);
+  WindowBuilder builder(ref_path, WindowBuilder::Params{});
+  builder.AddRegion("1:82960000-82970000");
+  const auto windows = builder.MakeGenerator();
+
+  ReadCollector::Params rc_params;
+  rc_params.mRefPath = ref_path;
+  rc_params.mTumorPaths = {MakePath(TEST_DATA_DIR, TEST_BAM_NAME)};
+  const WindowCostModel model(rc_params, lancet::cbdg::Graph::Params{});
+  const ShardPlanner planner(windows, model);
+  REQUIRE(planner.NumBlocks() == 1);
+
+  static constexpr usize NUM_SHARDS = 3;
+  const auto shards = planner.Partition(NUM_SHARDS);
+  REQUIRE(shards.size() == NUM_SHARDS);
+  const auto is_non_empty = [](const ShardPlanner::WindowRange& range) { return range.first < range.second; };
+  CHECK(std::ranges::count_if(shards, is_non_empty) == 1);
+  CHECK(shards.front().first == 0);
+  CHECK(shards.back().second == windows.NumTotal());
+  for (usize idx = 1; idx < NUM_SHARDS; ++idx) {
+    CHECK(shards[idx - 1].second == shards[idx].first);
+  }
+}
@@ -0,0 +1,107 @@
+#include "lancet/core/window_cache.h"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+#include "lancet/caller/raw_variant.h"
+#include "lancet/caller/variant_call.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window_builder.h"
+#include "lancet_test_config.h"
+
+using namespace lancet::core;
+
+namespace {
+
+// Serialized calls as written by `VariantCall::Serialize`, with a quality that needs all of its digits
+constexpr std::string_view SERIALIZED_SNV =
+    "9876543210\t0\t2000310\t61\tchr1\tG\tT\t1\t112.70000000000002\t2\t0\t"
+    "TUMOR;TYPE=SNV;LENGTH=1;KMERLEN=35\tGT:AD:DP\t0/0:30,0:30\t0/1:20,11:31";
+constexpr std::string_view SERIALIZED_INS =
+    "9876543211\t0\t2000455\t58\tchr1\tC\tCAGT\t3\t33.125\t0\t1\t"
+    "SHARED;TYPE=INS;LENGTH=3;KMERLEN=35\tGT:AD:DP\t0/1:20,9:29\t0/1:19,10:29";
+
+}  // namespace
+
+TEST_CASE("WindowCache serves stored window results", "[lancet][core][WindowCache]") {
+  const auto ref_path = MakePath(FULL_DATA_DIR, GRCH38_REF_NAME);
+  WindowBuilder builder(ref_path, WindowBuilder::Params{});
+  builder.AddBatchRegions(std::vector<std::string>{"chr1:2000000-2001000"});
+  auto generator = builder.MakeGenerator();
+  const auto first_window = generator.Next();
+  const auto second_window = generator.Next();
+  const auto third_window = generator.Next();
+  REQUIRE(first_window != nullptr);
+  REQUIRE(second_window != nullptr);
+  REQUIRE(third_window != nullptr);
+
+  const auto cache_dir = std::filesystem::temp_directory_path() / "lancet_window_cache_test";
+  std::filesystem::remove_all(cache_dir);
+
+  VariantBuilder::Params params;
+  params.mRdCollParams.mRefPath = ref_path;
+  const WindowCache cache(cache_dir, params);
+  CHECK_FALSE(cache.Lookup(*first_window).has_value());
+
+  cache.Store(*first_window, VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION, {});
+  cache.Store(*second_window, VariantBuilder::StatusCode::DEFERRED_OVER_BUDGET, {});
+
+  SECTION("Final results are found again with their status") {
+    const auto cached = cache.Lookup(*first_window);
+    REQUIRE(cached.has_value());
+    CHECK(cached->mStatus == VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION);
+    CHECK(cached->mVariants.empty());
+  }
+
+  SECTION("Variant calls are found again with all of their fields") {
+    VariantBuilder::WindowResults variants;
+    for (const auto serialized : {SERIALIZED_SNV, SERIALIZED_INS}) {
+      auto parsed = lancet::caller::VariantCall::Deserialize(serialized);
+      REQUIRE(parsed.ok());
+      variants.emplace_back(std::move(*parsed));
+    }
+
+    cache.Store(*third_window, VariantBuilder::StatusCode::FOUND_GENOTYPED_VARIANT, variants);
+    const auto cached = cache.Lookup(*third_window);
+    REQUIRE(cached.has_value());
+    CHECK(cached->mStatus == VariantBuilder::StatusCode::FOUND_GENOTYPED_VARIANT);
+    REQUIRE(cached->mVariants.size() == variants.size());
+
+    for (usize idx = 0; idx < variants.size(); ++idx) {
+      const auto& expected = *variants[idx];
+      const auto& loaded = *cached->mVariants[idx];
+      CHECK(loaded.Identifier() == expected.Identifier());
+      CHECK(loaded.ChromIndex() == expected.ChromIndex());
+      CHECK(loaded.ChromName() == expected.ChromName());
+      CHECK(loaded.StartPos1() == expected.StartPos1());
+      CHECK(loaded.RefAllele() == expected.RefAllele());
+      CHECK(loaded.AltAllele() == expected.AltAllele());
+      CHECK(loaded.Length() == expected.Length());
+      CHECK(loaded.Quality() == expected.Quality());
+      CHECK(loaded.State() == expected.State());
+      CHECK(loaded.Category() == expected.Category());
+      CHECK(loaded.TotalCoverage() == expected.TotalCoverage());
+      CHECK(loaded.NumSamples() == expected.NumSamples());
+      CHECK(loaded.AsVcfRecord() == expected.AsVcfRecord());
+    }
+
+    CHECK(cached->mVariants[0]->State() == lancet::caller::RawVariant::State::TUMOR);
+    CHECK(cached->mVariants[1]->Category() == lancet::caller::RawVariant::Type::INS);
+  }
+
+  SECTION("Deferred windows are not cached") { CHECK_FALSE(cache.Lookup(*second_window).has_value()); }
+
+  SECTION("Changed parameters do not match earlier entries") {
+    params.mGraphParams.mMinNodeCov += 1;
+    const WindowCache other_cache(cache_dir, params);
+    CHECK(other_cache.RunFingerprint() != cache.RunFingerprint());
+    CHECK_FALSE(other_cache.Lookup(*first_window).has_value());
+  }
+
+  std::filesystem::remove_all(cache_dir);
+}
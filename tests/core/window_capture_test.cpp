@@ -0,0 +1,62 @@
+#include "lancet/core/window_capture.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/cbdg/label.h"
+#include "lancet/cbdg/read.h"
+#include "lancet/core/read_collector.h"
+#include "lancet/core/sample_info.h"
+#include "lancet/core/window_builder.h"
+#include "lancet_test_config.h"
+
+using namespace lancet::core;
+
+TEST_CASE("WindowCapture round trips window inputs", "[lancet][core][WindowCapture]") {
+  const auto ref_path = MakePath(FULL_DATA_DIR, GRCH38_REF_NAME);
+  WindowBuilder builder(ref_path, WindowBuilder::Params{});
+  builder.AddBatchRegions(std::vector<std::string>{"chr4:1000000-1000500"});
+  auto generator = builder.MakeGenerator();
+  const auto window = generator.Next();
+  REQUIRE(window != nullptr);
+
+  ReadCollector::Result rc_result;
+  rc_result.mSampleList.emplace_back("normal", "normal.cram", lancet::cbdg::Label::NORMAL);
+  rc_result.mSampleList.emplace_back("tumor", "tumor.cram", lancet::cbdg::Label::TUMOR);
+  rc_result.mSampleReads.emplace_back(lancet::cbdg::Read::Fields{.mStart0 = 999999,
+                                                                 .mChromIdx = 3,
+                                                                 .mSamFlag = 99,
+                                                                 .mMapQual = 60,
+                                                                 .mPctAlnScoresDiff = 12,
+                                                                 .mPassesAlnFilters = false,
+                                                                 .mTag = lancet::cbdg::Label::TUMOR,
+                                                                 .mQname = "read1",
+                                                                 .mSequence = "ACGTN",
+                                                                 .mSampleName = "tumor",
+                                                                 .mQuality = {0, 10, 20, 30, 40}});
+
+  lancet::cbdg::Graph::Params params;
+  params.mMinKmerLen = 21;
+  params.mWindowVisitBudget = 5000;
+
+  const auto capture_path = std::filesystem::temp_directory_path() / "lancet_window_capture_test.txt.gz";
+  REQUIRE(WindowCapture(*window, params, rc_result).Write(capture_path).ok());
+  const auto capture = WindowCapture::Read(capture_path);
+  REQUIRE(capture.ok());
+
+  const auto replayed_window = capture->MakeWindow();
+  CHECK(replayed_window->ToSamtoolsRegion() == window->ToSamtoolsRegion());
+  CHECK(replayed_window->ChromIndex() == window->ChromIndex());
+  CHECK(replayed_window->SeqView() == window->SeqView());
+  CHECK(capture->GraphParams().mMinKmerLen == 21);
+  CHECK(capture->GraphParams().mWindowVisitBudget == 5000);
+  CHECK(capture->Samples().size() == 2);
+  CHECK_FALSE(capture->IsGermlineMode());
+  REQUIRE(capture->Reads().size() == 1);
+  CHECK(capture->Reads()[0] == rc_result.mSampleReads[0]);
+  CHECK(capture->Reads()[0].PctAlnScoresDiff() == 12);
+
+  std::filesystem::remove(capture_path);
+}
@@ -0,0 +1,71 @@
+#include "lancet/core/window_generator.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+#include "lancet/core/window.h"
+#include "lancet/core/window_builder.h"
+#include "lancet_test_config.h"
+
+using namespace lancet::core;
+
+namespace {
+
+[[nodiscard]] auto CollectAll(WindowGenerator generator) -> std::vector<WindowPtr> {
+  std::vector<WindowPtr> results;
+  for (auto window = generator.Next(); window != nullptr; window = generator.Next()) {
+    results.emplace_back(std::move(window));
+  }
+  return results;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("WindowGenerator yields windows in genome order", "[lancet][core][WindowGenerator]") {
+  const auto ref_path = MakePath(FULL_DATA_DIR, GRCH38_REF_NAME);
+  WindowBuilder builder(ref_path, WindowBuilder::Params{});
+  const std::vector<std::string> regions{"chr4:1000000-1020000", "chr4:1010000-1030000", "chr2:5000000-5000200",
+                                         "chr1:2000000-2050000"};
+  builder.AddBatchRegions(regions);
+
+  const auto generator = builder.MakeGenerator();
+  const auto windows = CollectAll(generator);
+  REQUIRE(windows.size() == generator.NumTotal());
+
+  SECTION("Windows are sorted by chromosome, start and end with consecutive genome indices") {
+    for (usize idx = 0; idx < windows.size(); ++idx) {
+      CHECK(windows[idx]->GenomeIndex() == idx);
+      // NOLINTNEXTLINE(readability-braces-around-statements)
+      if (idx == 0) continue;
+      const auto &prev = windows[idx - 1];
+      const auto &curr = windows[idx];
+      const auto is_ordered = prev->ChromIndex() != curr->ChromIndex() ? prev->ChromIndex() < curr->ChromIndex()
+                                                                      : prev->StartPos1() <= curr->StartPos1();
+      CHECK(is_ordered);
+    }
+  }
+
+  SECTION("Padded regions get a window every step size bases while the whole window fits") {
+    // chr1:1999500-2050500 after padding, with 500bp windows every 400bp
+    const auto is_chr1 = [](const WindowPtr &win) { return win->ChromName() == "chr1"; };
+    CHECK(std::ranges::count_if(windows, is_chr1) == 127);
+    CHECK(windows.front()->StartPos1() == 1999500);
+    CHECK(windows.front()->EndPos1() == 2000000);
+  }
+
+  SECTION("Slices yield the same windows re-indexed from zero") {
+    static constexpr usize FIRST = 10;
+    static constexpr usize LAST = 25;
+    const auto sliced = CollectAll(generator.Slice(FIRST, LAST));
+    REQUIRE(sliced.size() == LAST - FIRST);
+    for (usize idx = 0; idx < sliced.size(); ++idx) {
+      CHECK(sliced[idx]->GenomeIndex() == idx);
+      CHECK(sliced[idx]->ToSamtoolsRegion() == windows[FIRST + idx]->ToSamtoolsRegion());
+    }
+  }
+}
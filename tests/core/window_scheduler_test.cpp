@@ -0,0 +1,220 @@
+#include "lancet/core/window_scheduler.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/completion_tracker.h"
+#include "lancet/base/types.h"
+#include "lancet/core/async_worker.h"
+#include "lancet/core/read_collector.h"
+#include "lancet/core/variant_builder.h"
+#include "lancet/core/window.h"
+#include "lancet/core/window_builder.h"
+#include "lancet/core/window_cost_model.h"
+#include "lancet/core/window_generator.h"
+#include "lancet_test_config.h"
+
+using namespace lancet::core;
+
+namespace {
+
+constexpr auto TEST_REF_NAME = "human_g1k_v37.1_1_90000000.fa.gz";
+constexpr auto TEST_BAM_NAME = "human_g1k_v37.no_mutations.1_82960000_82970000.bam";
+
+[[nodiscard]] auto MakeGenerator(const std::string& region) -> WindowGenerator {
+  WindowBuilder builder(MakePath(TEST_DATA_DIR, TEST_REF_NAME), WindowBuilder::Params{});
+  builder.AddRegion(region);
+  return builder.MakeGenerator();
+}
+
+[[nodiscard]] auto MakeCostModel() -> std::unique_ptr<WindowCostModel> {
+  ReadCollector::Params rc_params;
+  rc_params.mRefPath = MakePath(TEST_DATA_DIR, TEST_REF_NAME);
+  rc_params.mNormalPaths = {MakePath(TEST_DATA_DIR, TEST_BAM_NAME)};
+  rc_params.mTumorPaths = {MakePath(TEST_DATA_DIR, TEST_BAM_NAME)};
+  return std::make_unique<WindowCostModel>(rc_params, lancet::cbdg::Graph::Params{});
+}
+
+[[nodiscard]] auto MakeScheduler(const std::string& region, const usize num_models, const usize max_lookahead)
+    -> WindowScheduler {
+  WindowScheduler::CostModels models;
+  for (usize idx = 0; idx < num_models; ++idx) {
+    models.emplace_back(MakeCostModel());
+  }
+  return {MakeGenerator(region), std::move(models), max_lookahead};
+}
+
+[[nodiscard]] auto GenomeIndices(const std::vector<WindowPtr>& windows) -> std::vector<usize> {
+  std::vector<usize> results;
+  results.reserve(windows.size());
+  std::ranges::transform(windows, std::back_inserter(results), [](const WindowPtr& win) { return win->GenomeIndex(); });
+  return results;
+}
+
+[[nodiscard]] auto MakeResult(const usize genome_idx, const VariantBuilder::StatusCode status) -> AsyncWorker::Result {
+  AsyncWorker::Result result;
+  result.mGenomeIdx = genome_idx;
+  result.mStatus = status;
+  return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("WindowScheduler dispatches highest predicted cost first within the lookahead",
+          "[lancet][core][WindowScheduler]") {
+  static constexpr usize LOOKAHEAD = 8;
+  auto scheduler = MakeScheduler("1:82960000-82970000", 1, LOOKAHEAD);
+  REQUIRE(scheduler.NumWindows() > 2 * LOOKAHEAD);
+  CompletionTracker done_windows(scheduler.NumWindows());
+
+  // Nothing is done before the first batch, so predictions are the static costs of the windows alone
+  const auto expected_model = MakeCostModel();
+  auto generator = MakeGenerator("1:82960000-82970000");
+  std::vector<std::pair<f64, usize>> expected_order;
+  for (usize idx = 0; idx < LOOKAHEAD; ++idx) {
+    const auto window = generator.Next();
+    expected_order.emplace_back(expected_model->Predict(*window), idx);
+  }
+  std::ranges::sort(expected_order, [](const auto& lhs, const auto& rhs) {
+    return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second;
+  });
+
+  const auto first_batch = GenomeIndices(scheduler.NextBatch(100, done_windows));
+  REQUIRE(first_batch.size() == LOOKAHEAD);
+  for (usize pos = 0; pos < LOOKAHEAD; ++pos) {
+    CHECK(first_batch[pos] == expected_order[pos].second);
+  }
+
+  SECTION("Pending windows are empty until the done frontier moves") {
+    CHECK(scheduler.NextBatch(100, done_windows).empty());
+
+    // Windows done out of order beyond the frontier do not let any new window into the lookahead
+    scheduler.MarkDone(MakeResult(3, VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION));
+    done_windows.MarkDone(3);
+    CHECK(scheduler.NextBatch(100, done_windows).empty());
+  }
+
+  SECTION("Moving the done frontier admits the same number of windows beyond the lookahead") {
+    static constexpr usize NUM_DONE = 3;
+    for (usize idx = 0; idx < NUM_DONE; ++idx) {
+      scheduler.MarkDone(MakeResult(idx, VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION));
+      done_windows.MarkDone(idx);
+    }
+
+    auto next_batch = GenomeIndices(scheduler.NextBatch(100, done_windows));
+    std::ranges::sort(next_batch);
+    const std::vector<usize> expected{LOOKAHEAD, LOOKAHEAD + 1, LOOKAHEAD + 2};
+    CHECK(next_batch == expected);
+  }
+}
+
+TEST_CASE("WindowScheduler predicts the same costs with parallel cost models", "[lancet][core][WindowScheduler]") {
+  static constexpr usize LOOKAHEAD = 64;
+  auto serial = MakeScheduler("1:82950000-82980000", 1, LOOKAHEAD);
+  auto parallel = MakeScheduler("1:82950000-82980000", WindowScheduler::MAX_PREDICTION_THREADS, LOOKAHEAD);
+  REQUIRE(serial.NumWindows() > LOOKAHEAD);
+
+  const CompletionTracker done_windows(serial.NumWindows());
+  const auto serial_batch = GenomeIndices(serial.NextBatch(LOOKAHEAD, done_windows));
+  const auto parallel_batch = GenomeIndices(parallel.NextBatch(LOOKAHEAD, done_windows));
+  CHECK(serial_batch.size() == LOOKAHEAD);
+  CHECK(serial_batch == parallel_batch);
+}
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("WindowScheduler retries deferred windows once nothing else is pending", "[lancet][core][WindowScheduler]") {
+  static constexpr usize LOOKAHEAD = 4;
+  auto scheduler = MakeScheduler("1:82960000-82970000", 1, LOOKAHEAD);
+  const CompletionTracker done_windows(scheduler.NumWindows());
+
+  const auto first_batch = scheduler.NextBatch(1, done_windows);
+  REQUIRE(first_batch.size() == 1);
+  const auto deferred_idx = first_batch.front()->GenomeIndex();
+  CHECK_FALSE(first_batch.front()->IsRetry());
+
+  // Deferred windows are not done, so the frontier stays put and the rest of the lookahead goes first
+  scheduler.MarkDone(MakeResult(deferred_idx, VariantBuilder::StatusCode::DEFERRED_OVER_BUDGET));
+  const auto rest_batch = scheduler.NextBatch(1, done_windows);
+  REQUIRE(rest_batch.size() == 1);
+  CHECK(rest_batch.front()->GenomeIndex() != deferred_idx);
+
+  const auto remaining = scheduler.NextBatch(100, done_windows);
+  CHECK(remaining.size() == LOOKAHEAD - 1);
+  const auto retried = std::ranges::find_if(remaining, [](const WindowPtr& win) { return win->IsRetry(); });
+  REQUIRE(retried != remaining.end());
+  CHECK((*retried)->GenomeIndex() == deferred_idx);
+  // Retries only fill up a batch after every pending window
+  CHECK(retried == std::prev(remaining.end()));
+
+  CHECK(scheduler.NextBatch(100, done_windows).empty());
+}
+
+TEST_CASE("WindowScheduler finds the flush boundary after resuming past the lookahead",
+          "[lancet][core][WindowScheduler]") {
+  // Windows done in a resumed checkpoint can span more than the lookahead of the resumed run, e.g. when the
+  // checkpoint was written by a run with more threads and a larger lookahead
+  static constexpr usize LOOKAHEAD = 4;
+  static constexpr usize NUM_RESTORED = 12;
+  auto scheduler = MakeScheduler("1:82960000-82970000", 1, LOOKAHEAD);
+  REQUIRE(scheduler.NumWindows() > NUM_RESTORED + 1);
+  CompletionTracker done_windows(scheduler.NumWindows());
+  for (usize idx = 1; idx <= NUM_RESTORED; ++idx) {
+    done_windows.MarkDone(idx);
+  }
+
+  const auto first_batch = GenomeIndices(scheduler.NextBatch(100, done_windows));
+  REQUIRE(first_batch == std::vector<usize>{0});
+
+  scheduler.MarkDone(MakeResult(0, VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION));
+  REQUIRE(done_windows.MarkDone(0));
+  REQUIRE(done_windows.Frontier() == NUM_RESTORED + 1);
+
+  const auto& boundary = scheduler.WindowBehindFrontier(LOOKAHEAD, done_windows);
+  CHECK(boundary->GenomeIndex() == NUM_RESTORED + 1 - LOOKAHEAD);
+  CHECK(scheduler.WindowBehindFrontier(1, done_windows)->GenomeIndex() == NUM_RESTORED);
+
+  // Restored windows are never dispatched again, only the windows after them
+  auto next_batch = GenomeIndices(scheduler.NextBatch(100, done_windows));
+  std::ranges::sort(next_batch);
+  const std::vector<usize> expected{NUM_RESTORED + 1, NUM_RESTORED + 2, NUM_RESTORED + 3, NUM_RESTORED + 4};
+  CHECK(next_batch == expected);
+}
+
+TEST_CASE("WindowScheduler keeps a finished gap window until the next batch after the frontier jumps",
+          "[lancet][core][WindowScheduler]") {
+  // Finishing the only window before a done range longer than the lookahead moves the frontier past the
+  // lookahead in one step, e.g. when a checkpoint is resumed, or a ledger block is taken over, with fewer threads
+  static constexpr usize LOOKAHEAD = 4;
+  static constexpr usize NUM_RESTORED = 3 * LOOKAHEAD;
+  auto scheduler = MakeScheduler("1:82960000-82970000", 1, LOOKAHEAD);
+  REQUIRE(scheduler.NumWindows() > NUM_RESTORED + LOOKAHEAD + 1);
+  CompletionTracker done_windows(scheduler.NumWindows());
+  for (usize idx = 1; idx <= NUM_RESTORED; ++idx) {
+    done_windows.MarkDone(idx);
+  }
+
+  const auto first_batch = scheduler.NextBatch(100, done_windows);
+  REQUIRE(GenomeIndices(first_batch) == std::vector<usize>{0});
+
+  scheduler.MarkDone(MakeResult(0, VariantBuilder::StatusCode::SKIPPED_INACTIVE_REGION));
+  REQUIRE(done_windows.MarkDone(0));
+  REQUIRE(done_windows.Frontier() == NUM_RESTORED + 1);
+
+  // Finished window can still be looked up after MarkDone, until the next batch drops it
+  const WindowPtr gap_window = scheduler.WindowAt(0);
+  CHECK(gap_window == first_batch.front());
+
+  auto next_batch = GenomeIndices(scheduler.NextBatch(100, done_windows));
+  std::ranges::sort(next_batch);
+  const std::vector<usize> expected{NUM_RESTORED + 1, NUM_RESTORED + 2, NUM_RESTORED + 3, NUM_RESTORED + 4};
+  CHECK(next_batch == expected);
+  CHECK_THROWS_AS(scheduler.WindowAt(0), std::out_of_range);
+  CHECK(gap_window->GenomeIndex() == 0);
+}
@@ -0,0 +1,42 @@
+#include "lancet/core/window_timings.h"
+
+#include "absl/time/time.h"
+#include "catch_amalgamated.hpp"
+
+using lancet::core::WindowTimings;
+using lancet::core::WindowTimingStats;
+
+TEST_CASE("WindowTimingStats aggregates per stage runtimes", "[lancet][core][WindowTimingStats]") {
+  using WindowTimings::Stage::GENOTYPE;
+  using WindowTimings::Stage::GRAPH_BUILD;
+  using WindowTimings::Stage::REPEAT_CHECK;
+
+  WindowTimingStats stats;
+  for (int idx = 0; idx < 99; ++idx) {
+    WindowTimings timings;
+    timings.Add(REPEAT_CHECK, absl::Microseconds(3));
+    timings.Add(GRAPH_BUILD, absl::Microseconds(100));
+    stats.Add(timings);
+  }
+
+  WindowTimings slow_window;
+  slow_window.Add(REPEAT_CHECK, absl::Microseconds(3));
+  slow_window.Add(GRAPH_BUILD, absl::Milliseconds(50));
+  WindowTimings genotyped;
+  genotyped.Add(GENOTYPE, absl::Milliseconds(2));
+  slow_window += genotyped;
+  stats.Add(slow_window);
+
+  CHECK(stats.NumWindows(REPEAT_CHECK) == 100);
+  CHECK(stats.NumWindows(GRAPH_BUILD) == 100);
+  CHECK(stats.NumWindows(GENOTYPE) == 1);
+  CHECK(stats.NumWindows(WindowTimings::Stage::MSA_BUILD) == 0);
+  CHECK(stats.TotalRuntime(GRAPH_BUILD) == absl::Microseconds(99 * 100) + absl::Milliseconds(50));
+
+  // 3us falls in the [2us, 4us) bucket and 100us in the [64us, 128us) bucket
+  CHECK(stats.QuantileUpperBound(REPEAT_CHECK, 0.5) == absl::Microseconds(4));
+  CHECK(stats.QuantileUpperBound(GRAPH_BUILD, 0.5) == absl::Microseconds(128));
+  CHECK(stats.QuantileUpperBound(GRAPH_BUILD, 0.99) == absl::Microseconds(128));
+  CHECK(stats.QuantileUpperBound(GRAPH_BUILD, 1.0) == absl::Microseconds(65536));
+  CHECK(stats.QuantileUpperBound(WindowTimings::Stage::MSA_BUILD, 0.5) == absl::ZeroDuration());
+}
@@ -0,0 +1,87 @@
+#include "lancet/hts/bgzf_ostream.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+extern "C" {
+#include "htslib/bgzf.h"
+}
+
+#include "catch_amalgamated.hpp"
+#include "lancet/base/types.h"
+
+using namespace lancet::hts;
+
+namespace {
+
+// BGZF virtual offsets store the compressed block offset in the upper 48 bits
+constexpr i64 BLOCK_OFFSET_SHIFT = 16;
+
+[[nodiscard]] auto ReadDecompressed(const std::filesystem::path& path) -> std::string {
+  BGZF* bgzf_ptr = bgzf_open(path.c_str(), "r");
+  REQUIRE(bgzf_ptr != nullptr);
+
+  static constexpr usize BUFFER_SIZE = 4096;
+  std::array<char, BUFFER_SIZE> buffer{};
+  std::string result;
+  auto num_read = bgzf_read(bgzf_ptr, buffer.data(), buffer.size());
+  while (num_read > 0) {
+    result.append(buffer.data(), static_cast<usize>(num_read));
+    num_read = bgzf_read(bgzf_ptr, buffer.data(), buffer.size());
+  }
+
+  bgzf_close(bgzf_ptr);
+  return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+TEST_CASE("BgzfOstream resumes at offsets from repeated checkpoints", "[lancet][hts][BgzfOstream]") {
+  const auto out_path = std::filesystem::temp_directory_path() / "lancet_bgzf_ostream_test.txt.gz";
+  std::filesystem::remove(out_path);
+
+  // Data written after a checkpoint and before a crash is dropped again by the next resume
+  i64 first_checkpoint = -1;
+  {
+    BgzfOstream output;
+    REQUIRE(output.Open(out_path));
+    output << "first\n";
+    first_checkpoint = output.FlushBlock();
+    output << "lost after first checkpoint\n";
+  }
+  REQUIRE(first_checkpoint > 0);
+
+  i64 second_checkpoint = -1;
+  {
+    BgzfOstream output;
+    REQUIRE(output.OpenForAppend(out_path, BgzfFormat::UNSPECIFIED, first_checkpoint));
+    output << "second\n";
+    second_checkpoint = output.FlushBlock();
+    output << "lost after second checkpoint\n";
+  }
+
+  // Offsets after a resume are still counted from the start of the file, so they only ever grow
+  REQUIRE(second_checkpoint > first_checkpoint);
+  const auto file_offset = static_cast<std::uintmax_t>(second_checkpoint >> BLOCK_OFFSET_SHIFT);
+  CHECK(file_offset <= std::filesystem::file_size(out_path));
+
+  {
+    BgzfOstream output;
+    REQUIRE(output.OpenForAppend(out_path, BgzfFormat::UNSPECIFIED, second_checkpoint));
+    output << "third\n";
+  }
+
+  CHECK(ReadDecompressed(out_path) == "first\nsecond\nthird\n");
+
+  SECTION("Offsets within a block or past the end of the file are rejected") {
+    BgzfOstream output;
+    CHECK_FALSE(output.OpenForAppend(out_path, BgzfFormat::UNSPECIFIED, second_checkpoint + 1));
+    const auto past_end = static_cast<i64>(std::filesystem::file_size(out_path) + 1) << BLOCK_OFFSET_SHIFT;
+    CHECK_FALSE(output.OpenForAppend(out_path, BgzfFormat::UNSPECIFIED, past_end));
+  }
+
+  std::filesystem::remove(out_path);
+}